@@ -92,6 +92,9 @@ Accelerator::Accelerator(int n, CUdevice device) :
 
 Accelerator::~Accelerator()
 {
+#if defined(CALL_CUDA_ON_DESTRUCTION) && CUDA_VERSION >= 4000
+    registrations_.clear();
+#endif
 #ifndef USE_MULTI_CONTEXT
 #ifdef CALL_CUDA_ON_DESTRUCTION
     pushContext();
@@ -561,6 +564,32 @@ gmacError_t Accelerator::copyAccelerator(accptr_t dst, const accptr_t src, size_
     return error(ret);
 }
 
+#if CUDA_VERSION >= 4000 && !defined(USE_MULTI_CONTEXT)
+bool Accelerator::hasPeerAccess(const core::hpe::Accelerator &acc) const
+{
+    const Accelerator *peer = dynamic_cast<const Accelerator *>(&acc);
+    if(peer == NULL) return false;
+    if(peer == this) return true;
+    int val = 0;
+    CUresult ret = cuDeviceCanAccessPeer(&val, device_, peer->device_);
+    return ret == CUDA_SUCCESS && val != 0;
+}
+
+gmacError_t Accelerator::copyAcceleratorPeer(accptr_t dst, core::hpe::Accelerator &srcAcc, const accptr_t src, size_t size, stream_t stream)
+{
+    Accelerator &peer = dynamic_cast<Accelerator &>(srcAcc);
+    if(&peer == this) return copyAccelerator(dst, src, size, stream);
+    if(hasPeerAccess(peer) == false) return gmacErrorFeatureNotSupported;
+    trace::EnterCurrentFunction();
+    TRACE(LOCAL,"Copy accelerator-accelerator (peer): %p -> %p ("FMT_SIZE")", src.get(), dst.get(), size);
+    pushContext();
+    CUresult ret = cuMemcpyPeerAsync(dst, ctx_, src, peer.ctx_, size, stream);
+    popContext();
+    trace::ExitCurrentFunction();
+    return error(ret);
+}
+#endif
+
 gmacError_t Accelerator::execute(KernelLaunch &launch)
 {
     trace::EnterCurrentFunction();
@@ -576,9 +605,10 @@ gmacError_t Accelerator::execute(KernelLaunch &launch)
 gmacError_t Accelerator::registerMem(hostptr_t ptr, size_t size)
 {
     trace::EnterCurrentFunction();
-    TRACE(LOCAL,"Executing KernelLaunch");
+    TRACE(LOCAL,"Registering host memory %p ("FMT_SIZE" bytes)", ptr, size);
+    pushContext();
     CUresult ret = cuMemHostRegister(ptr, size, CU_MEMHOSTREGISTER_PORTABLE);
-    CFATAL(ret == CUDA_SUCCESS);
+    popContext();
     trace::ExitCurrentFunction();
     return error(ret);
 }
@@ -587,7 +617,7 @@ gmacError_t Accelerator::registerMem(hostptr_t ptr, size_t size)
 gmacError_t Accelerator::unregisterMem(hostptr_t ptr)
 {
     trace::EnterCurrentFunction();
-    TRACE(LOCAL,"Executing KernelLaunch");
+    TRACE(LOCAL,"Unregistering host memory %p", ptr);
     pushContext();
     CUresult ret = cuMemHostUnregister(ptr);
     CFATAL(ret == CUDA_SUCCESS);
@@ -595,6 +625,19 @@ gmacError_t Accelerator::unregisterMem(hostptr_t ptr)
     trace::ExitCurrentFunction();
     return error(ret);
 }
+
+gmacError_t Accelerator::pinMemory(hostptr_t addr, size_t size, void *&handle)
+{
+    // Registered ranges are identified by their address
+    handle = NULL;
+    return registerMem(addr, size);
+}
+
+void Accelerator::unpinMemory(hostptr_t addr, size_t size, void *handle)
+{
+    gmacError_t ret = unregisterMem(addr);
+    ASSERTION(ret == gmacSuccess);
+}
 #endif
 
 CUstream Accelerator::createCUstream()
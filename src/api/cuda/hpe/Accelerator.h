@@ -160,12 +160,19 @@ public:
 #if CUDA_VERSION >= 4000
     gmacError_t registerMem(hostptr_t ptr, size_t size);
     gmacError_t unregisterMem(hostptr_t ptr);
+
+    gmacError_t pinMemory(hostptr_t addr, size_t size, void *&handle);
+    void unpinMemory(hostptr_t addr, size_t size, void *handle);
 #endif
 
     /* Synchronous interface */
     TESTABLE gmacError_t copyToAccelerator(accptr_t acc, const hostptr_t host, size_t size, core::hpe::Mode &mode);
     TESTABLE gmacError_t copyToHost(hostptr_t host, const accptr_t acc, size_t size, core::hpe::Mode &mode);
     TESTABLE gmacError_t copyAccelerator(accptr_t dst, const accptr_t src, size_t size, stream_t stream);
+#if CUDA_VERSION >= 4000 && !defined(USE_MULTI_CONTEXT)
+    gmacError_t copyAcceleratorPeer(accptr_t dst, core::hpe::Accelerator &srcAcc, const accptr_t src, size_t size, stream_t stream);
+    bool hasPeerAccess(const core::hpe::Accelerator &acc) const;
+#endif
 
     /* Asynchronous interface */
     TESTABLE gmacError_t copyToAcceleratorAsync(accptr_t acc, core::IOBuffer &buffer, size_t bufferOff, size_t count, core::hpe::Mode &mode, CUstream stream);
@@ -3,6 +3,7 @@
 #include "api/cuda/hpe/Context.h"
 #include "api/cuda/IOBuffer.h"
 
+#include "util/Monitor.h"
 #include "util/allocator/Buddy.h"
 
 namespace __impl { namespace cuda { namespace hpe {
@@ -93,6 +94,10 @@ Mode::createIOBuffer(size_t size, GmacProtection prot)
             ret = new IOBuffer(addr, size, true, prot);
         }
     }
+    if(monitor_ != NULL) {
+        util::Monitor::add(monitor_->ioBuffers_, 1);
+        util::Monitor::add(monitor_->ioBufferBytes_, size);
+    }
     return *ret;
 }
 
@@ -108,6 +113,24 @@ void Mode::destroyIOBuffer(core::IOBuffer &buffer)
     } else {
         ::free(buffer.addr());
     }
+    if(monitor_ != NULL) {
+        util::Monitor::add(monitor_->ioBuffers_, -1);
+        util::Monitor::add(monitor_->ioBufferBytes_, -int64_t(buffer.size()));
+    }
+    delete &buffer;
+}
+
+core::IOBuffer *
+Mode::registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot)
+{
+    if(getAccelerator().getRegistrations().acquire(addr, size) == false) return NULL;
+    // Registered memory can be used in asynchronous transfers
+    return new IOBuffer(addr, size, true, prot);
+}
+
+void Mode::unregisterIOBuffer(core::IOBuffer &buffer)
+{
+    getAccelerator().getRegistrations().release(buffer.addr());
     delete &buffer;
 }
 
@@ -164,6 +164,8 @@ public:
 
     core::IOBuffer &createIOBuffer(size_t size, GmacProtection prot);
     void destroyIOBuffer(core::IOBuffer &buffer);
+    core::IOBuffer *registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot);
+    void unregisterIOBuffer(core::IOBuffer &buffer);
 
     gmacError_t call(dim3 Dg, dim3 Db, size_t shared, cudaStream_t tokens);
     gmacError_t argument(const void *arg, size_t size, off_t offset);
@@ -9,6 +9,20 @@ inline
 IOBuffer::IOBuffer(Mode &mode, hostptr_t addr, size_t size, cl_mem mem, GmacProtection prot) :
     gmac::core::IOBuffer(addr, size, mem != NULL, prot),
     mem_(mem),
+    memOffset_(0),
+    pinned_(false),
+    event_(NULL),
+    mode_(NULL),
+    started_(false)
+{
+}
+
+inline
+IOBuffer::IOBuffer(Mode &mode, hostptr_t addr, size_t size, cl_mem mem, size_t memOffset, GmacProtection prot) :
+    gmac::core::IOBuffer(addr, size, true, prot),
+    mem_(mem),
+    memOffset_(memOffset),
+    pinned_(true),
     event_(NULL),
     mode_(NULL),
     started_(false)
@@ -57,6 +57,12 @@ protected:
     /** OpenCL buffer descriptor of the memory used by the buffer */
     cl_mem mem_;
 
+    /** Offset of the buffer memory within mem_ for buffers on pinned user memory */
+    size_t memOffset_;
+
+    /** Tells whether the buffer uses pinned user memory instead of a staging buffer */
+    bool pinned_;
+
     /** OpenCL event to query for the finalization of any ongoing data transfer */
     cl_event start_;
 
@@ -86,6 +92,16 @@ public:
      */
     IOBuffer(Mode &mode, hostptr_t addr, size_t size, cl_mem mem, GmacProtection prot);
 
+    /** Constructor for I/O buffers on pinned user memory
+     * \param mode Execution mode using the I/O buffer
+     * \param addr Starting address of the user memory
+     * \param size Size (in bytes) of the I/O buffer
+     * \param mem cl_mem buffer wrapping the pinned range that contains the user memory
+     * \param memOffset Offset of the user memory within the pinned range
+     * \param prot Tells whether the buffer is going to be read/written by the host
+     */
+    IOBuffer(Mode &mode, hostptr_t addr, size_t size, cl_mem mem, size_t memOffset, GmacProtection prot);
+
     /** Set the transfer direction from device to host
      * \param mode Execution mode performing the data transfer
      */
@@ -116,6 +132,16 @@ public:
 
     cl_mem getCLBuffer() { return mem_; }
 
+    /** Tells whether the buffer uses pinned user memory
+     * \return True if transfers must go through the pinned range
+     */
+    bool pinned() const { return pinned_; }
+
+    /** Get the offset of the buffer memory within its cl_mem
+     * \return Offset (in bytes) of the buffer within the pinned range
+     */
+    size_t memOffset() const { return memOffset_; }
+
     void setAddr(hostptr_t addr) { addr_ = addr; }
 };
 
@@ -124,6 +124,15 @@ CLBufferPool::CLBufferPool() :
 {
 }
 
+inline gmacError_t
+Accelerator::getSubBuffer(cl_mem &mem, const accptr_t addr, size_t size)
+{
+    trace::EnterCurrentFunction();
+    cl_int ret = subBuffers_.get(mem, addr, size);
+    trace::ExitCurrentFunction();
+    return error(ret);
+}
+
 inline cl_device_id
 Accelerator::device() const
 {
@@ -7,6 +7,7 @@
 #include "core/Process.h"
 
 #include "hpe/init.h"
+#include "util/Monitor.h"
 
 #if !defined(_MSC_VER) && !defined(__APPLE__)
 // Symbols needed for automatic compilation of embedded code
@@ -18,6 +19,13 @@ extern "C" {
 
 namespace __impl { namespace opencl { namespace hpe {
 
+static inline void
+publishMemory(unsigned id, size_t used)
+{
+    util::MonitorAccelerator *slot = util::Monitor::getAccelerator(id);
+    if(slot != NULL) util::Monitor::set(slot->memoryUsed_, used);
+}
+
 void
 CLBufferPool::cleanUp(stream_t stream)
 {
@@ -28,8 +36,11 @@ CLBufferPool::cleanUp(stream_t stream)
         CLMemList list = it->second;
         for (jt = list.begin(); jt != list.end(); ++jt) {
             cl_int ret;
-            ret = clEnqueueUnmapMemObject(stream, jt->first, jt->second, 0, NULL, NULL);
-            ASSERTION(ret == CL_SUCCESS);
+            // Buffers only used by the accelerator are not mapped
+            if(jt->second != NULL) {
+                ret = clEnqueueUnmapMemObject(stream, jt->first, jt->second, 0, NULL, NULL);
+                ASSERTION(ret == CL_SUCCESS);
+            }
             ret = clReleaseMemObject(jt->first);
             ASSERTION(ret == CL_SUCCESS);
         }
@@ -77,9 +88,66 @@ void CLBufferPool::putCLMem(size_t size, cl_mem mem, hostptr_t addr)
     unlock();
 }
 
+SubBufferMap::~SubBufferMap()
+{
+    // Sub-buffers are released together with their parent object; remaining
+    // entries cannot be released because the OpenCL library might have been
+    // already unloaded
+}
+
+cl_int
+SubBufferMap::get(cl_mem &mem, const accptr_t addr, size_t size)
+{
+    cl_int ret = CL_SUCCESS;
+    lock();
+    Parent::iterator i = Parent::find(addr.get());
+    RegionMap::const_iterator j;
+    if(i != Parent::end() && (j = i->second.find(addr.offset())) != i->second.end()) mem = j->second;
+    else {
+        cl_buffer_region region;
+        region.origin = addr.offset();
+        region.size   = size - addr.offset();
+        mem = clCreateSubBuffer(addr.get(), CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &ret);
+        if(ret == CL_SUCCESS) {
+            if(i == Parent::end()) i = Parent::insert(Parent::value_type(addr.get(), RegionMap())).first;
+            i->second.insert(RegionMap::value_type(addr.offset(), mem));
+        }
+    }
+    unlock();
+    return ret;
+}
+
+void
+SubBufferMap::remove(cl_mem parent)
+{
+    lock();
+    Parent::iterator i = Parent::find(parent);
+    if(i != Parent::end()) {
+        RegionMap::const_iterator j;
+        for(j = i->second.begin(); j != i->second.end(); ++j) {
+            cl_int ret = clReleaseMemObject(j->second);
+            ASSERTION(ret == CL_SUCCESS);
+        }
+        Parent::erase(i);
+    }
+    unlock();
+}
+
 Accelerator::AcceleratorMap *Accelerator::Accelerators_ = NULL;
 HostMap *Accelerator::GlobalHostAlloc_ = NULL;
 
+// Each work-group copies one range. Offsets are in bytes and the ranges are
+// copied as 32-bit words
+const char *Accelerator::ScatterCode_ =
+    "__kernel void gmacScatter(__global uint *dst, ulong dstOff,\n"
+    "                          __global const ulong *packed, uint count, uint words)\n"
+    "{\n"
+    "    uint range = get_group_id(0);\n"
+    "    __global const uint *src = (__global const uint *)(packed + count) + range * words;\n"
+    "    __global uint *to = dst + (dstOff + packed[range]) / sizeof(uint);\n"
+    "    for(uint i = get_local_id(0); i < words; i += get_local_size(0)) to[i] = src[i];\n"
+    "}\n";
+
 Accelerator::Accelerator(int n, cl_context context, cl_device_id device, unsigned major, unsigned minor) :
     gmac::util::SpinLock("Accelerator"),
     gmac::core::hpe::Accelerator(n),
@@ -89,7 +157,9 @@ Accelerator::Accelerator(int n, cl_context context, cl_device_id device, unsigne
     isInfoInitialized_(false),
     acceleratorName_(NULL),
     vendorName_(NULL),
-    maxSizes_(NULL)
+    maxSizes_(NULL),
+    scatterProgram_(NULL),
+    scatterKernel_(NULL)
 {
     // Not used for now
     busId_ = 0;
@@ -123,10 +193,14 @@ Accelerator::~Accelerator()
         cl_int ret = clReleaseProgram(*i);
         ASSERTION(ret == CL_SUCCESS);
     }
+    if(scatterKernel_ != NULL) clReleaseKernel(scatterKernel_);
+    if(scatterProgram_ != NULL) clReleaseProgram(scatterProgram_);
     unlock();
+    registrations_.clear();
     stream_t tmpStream = createCLstream();
     clMemWrite_.cleanUp(tmpStream);
     clMemRead_.cleanUp(tmpStream);
+    scatterBuffers_.cleanUp(tmpStream);
     destroyCLstream(tmpStream);
     Accelerators_->erase(this);
 
@@ -166,12 +240,24 @@ gmacError_t Accelerator::map(accptr_t &dst, hostptr_t src, size_t size, unsigned
 {
     trace::EnterCurrentFunction();
 
+    // Accelerator memory might be artificially limited to test oversubscription
+    size_t cap = util::params::ParamAcceleratorMemoryCap;
+    if(cap > 0 && allocatedMemory_ + size > cap) {
+        TRACE(LOCAL, "Accelerator memory cap reached ("FMT_SIZE" bytes)", cap);
+        trace::ExitCurrentFunction();
+        return gmacErrorMemoryAllocation;
+    }
+
     cl_int ret = CL_SUCCESS;
     trace::SetThreadState(trace::Wait);
     dst(clCreateBuffer(ctx_, CL_MEM_READ_WRITE, size, NULL, &ret));
-    if(ret != CL_SUCCESS) return error(ret);
     trace::SetThreadState(trace::Running);
+    if(ret != CL_SUCCESS) {
+        trace::ExitCurrentFunction();
+        return error(ret);
+    }
     allocatedMemory_ += size;
+    publishMemory(id_, allocatedMemory_);
 
     dst.pasId_ = id_;
 
@@ -205,9 +291,12 @@ gmacError_t Accelerator::unmap(hostptr_t host, size_t size)
     TRACE(LOCAL, "Releasing accelerator memory @ %p", addr.get());
 
     trace::SetThreadState(trace::Wait);
+    // Sub-buffers must be released before their parent object
+    subBuffers_.remove(addr.get());
     cl_int ret = CL_SUCCESS;
     ret = clReleaseMemObject(addr.get());
     allocatedMemory_ -= size;
+    publishMemory(id_, allocatedMemory_);
     trace::SetThreadState(trace::Running);
     trace::ExitCurrentFunction();
     return error(ret);
@@ -273,6 +362,117 @@ gmacError_t Accelerator::copyAccelerator(accptr_t dst, const accptr_t src, size_
     return error(ret);
 }
 
+bool Accelerator::hasPeerAccess(const core::hpe::Accelerator &acc) const
+{
+    // Buffers can be copied between devices that share the OpenCL context
+    const Accelerator *peer = dynamic_cast<const Accelerator *>(&acc);
+    if(peer == NULL) return false;
+    return peer->ctx_ == ctx_;
+}
+
+gmacError_t Accelerator::copyAcceleratorPeer(accptr_t dst, core::hpe::Accelerator &srcAcc, const accptr_t src, size_t size, stream_t stream)
+{
+    if(hasPeerAccess(srcAcc) == false) return gmacErrorFeatureNotSupported;
+    return copyAccelerator(dst, src, size, stream);
+}
+
+cl_kernel Accelerator::getScatterKernel()
+{
+    lock();
+    if(scatterProgram_ == NULL) {
+        cl_int ret = CL_SUCCESS;
+        scatterProgram_ = clCreateProgramWithSource(ctx_, 1, &ScatterCode_, NULL, &ret);
+        if(ret == CL_SUCCESS) ret = clBuildProgram(scatterProgram_, 1, &device_, NULL, NULL, NULL);
+        if(ret == CL_SUCCESS) scatterKernel_ = clCreateKernel(scatterProgram_, "gmacScatter", &ret);
+        if(ret != CL_SUCCESS) {
+            WARNING("Unable to build the scatter kernel: %d", ret);
+            scatterKernel_ = NULL;
+        }
+    }
+    cl_kernel kernel = scatterKernel_;
+    unlock();
+    return kernel;
+}
+
+gmacError_t Accelerator::scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                              unsigned count, size_t size, core::hpe::Mode &mode, stream_t stream)
+{
+    // The kernel moves 32-bit words
+    cl_kernel kernel = NULL;
+    if(size % sizeof(cl_uint) == 0 && acc.offset() % sizeof(cl_uint) == 0) kernel = getScatterKernel();
+    if(kernel == NULL)
+        return core::hpe::Accelerator::scatterToAccelerator(acc, host, offsets, count, size, mode, stream);
+
+    trace::EnterCurrentFunction();
+    // Packed layout: the 64-bit offsets of the ranges followed by their data
+    size_t header = count * sizeof(cl_ulong);
+    size_t packedSize = header + count * size;
+    // Buffers are pooled in power of two sizes, so they are reused by
+    // transfers with a different number of ranges
+    size_t bufferSize = 4096;
+    while(bufferSize < packedSize) bufferSize <<= 1;
+    TRACE(LOCAL, "Scatter %u ranges ("FMT_SIZE") @ %p", count, packedSize, acc.get());
+
+    cl_mem staging, mem;
+    hostptr_t packed = NULL, dummy = NULL;
+    gmacError_t ret = allocCLBuffer(staging, packed, bufferSize, GMAC_PROT_WRITE);
+    if(ret != gmacSuccess) {
+        trace::ExitCurrentFunction();
+        return core::hpe::Accelerator::scatterToAccelerator(acc, host, offsets, count, size, mode, stream);
+    }
+    cl_int clret = CL_SUCCESS;
+    if(scatterBuffers_.getCLMem(bufferSize, mem, dummy) == false) {
+        mem = clCreateBuffer(ctx_, CL_MEM_READ_ONLY, bufferSize, NULL, &clret);
+        if(clret != CL_SUCCESS) {
+            freeCLBuffer(staging, packed, bufferSize, GMAC_PROT_WRITE);
+            trace::ExitCurrentFunction();
+            return core::hpe::Accelerator::scatterToAccelerator(acc, host, offsets, count, size, mode, stream);
+        }
+    }
+
+    // The ranges are packed straight into pinned memory
+    cl_ulong *packedOffsets = (cl_ulong *)packed;
+    for(unsigned n = 0; n < count; n++) {
+        packedOffsets[n] = cl_ulong(offsets[n]);
+        ::memcpy(packed + header + n * size, host + offsets[n], size);
+    }
+
+    trace::SetThreadState(trace::Wait);
+    cl_event write = NULL, event = NULL;
+    trace_.init(trace_.getThreadId(), (THREAD_T)mode.getId());
+    cl_mem dst = acc.get();
+    cl_ulong dstOff = cl_ulong(acc.offset());
+    cl_uint words = cl_uint(size / sizeof(cl_uint));
+    size_t local = 64;
+    size_t global = count * local;
+    lock();
+    // Single transfer with all the ranges, scattered by the kernel
+    clret = clEnqueueWriteBuffer(stream, mem, CL_FALSE, 0, packedSize, packed, 0, NULL, &write);
+    if(clret == CL_SUCCESS) clret = clSetKernelArg(kernel, 0, sizeof(cl_mem), &dst);
+    if(clret == CL_SUCCESS) clret = clSetKernelArg(kernel, 1, sizeof(cl_ulong), &dstOff);
+    if(clret == CL_SUCCESS) clret = clSetKernelArg(kernel, 2, sizeof(cl_mem), &mem);
+    if(clret == CL_SUCCESS) clret = clSetKernelArg(kernel, 3, sizeof(cl_uint), &count);
+    if(clret == CL_SUCCESS) clret = clSetKernelArg(kernel, 4, sizeof(cl_uint), &words);
+    if(clret == CL_SUCCESS) clret = clEnqueueNDRangeKernel(stream, kernel, 1, NULL, &global, &local, 1, &write, &event);
+    unlock();
+    // Only this transfer is waited for, not the whole stream. The pooled
+    // buffers are reused once the kernel has read the packed data
+    if(event != NULL) {
+        cl_int waitret = clWaitForEvents(1, &event);
+        if(clret == CL_SUCCESS) clret = waitret;
+        clReleaseEvent(event);
+    }
+    if(write != NULL) {
+        if(event == NULL) clWaitForEvents(1, &write);
+        trace_.trace(write, write, packedSize);
+        clReleaseEvent(write);
+    }
+    trace::SetThreadState(trace::Running);
+    freeCLBuffer(staging, packed, bufferSize, GMAC_PROT_WRITE);
+    scatterBuffers_.putCLMem(bufferSize, mem, NULL);
+    trace::ExitCurrentFunction();
+    return error(clret);
+}
 
 gmacError_t Accelerator::memset(accptr_t addr, int c, size_t size, stream_t stream)
 {
@@ -563,6 +763,7 @@ Accelerator::hostAlloc(hostptr_t &addr, size_t size)
         if(ret != CL_SUCCESS) clReleaseMemObject(mem);
         else {
             allocatedMemory_ += size;
+            publishMemory(id_, allocatedMemory_);
             localHostAlloc_.insert(addr, mem, size);
         }
     }
@@ -607,7 +808,10 @@ Accelerator::allocCLBuffer(cl_mem &mem, hostptr_t &addr, size_t size, GmacProtec
 
         // Insert the object in the allocation map for the accelerator
         if(ret != CL_SUCCESS) clReleaseMemObject(mem);
-        else allocatedMemory_ += size;
+        else {
+            allocatedMemory_ += size;
+            publishMemory(id_, allocatedMemory_);
+        }
     }
 
 exit:
@@ -630,6 +834,93 @@ gmacError_t Accelerator::hostFree(hostptr_t addr)
     return gmacSuccess;
 }
 
+gmacError_t Accelerator::pinMemory(hostptr_t addr, size_t size, void *&handle)
+{
+    trace::EnterCurrentFunction();
+    // Buffers using host memory are pinned by the runtime. Transfers from
+    // and to the pinned range go through the buffer
+    cl_int ret = CL_SUCCESS;
+    cl_mem mem = clCreateBuffer(ctx_, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, size, addr, &ret);
+    if(ret == CL_SUCCESS) handle = mem;
+    trace::ExitCurrentFunction();
+    return error(ret);
+}
+
+void Accelerator::unpinMemory(hostptr_t addr, size_t size, void *handle)
+{
+    trace::EnterCurrentFunction();
+    cl_int ret = clReleaseMemObject(cl_mem(handle));
+    ASSERTION(ret == CL_SUCCESS);
+    trace::ExitCurrentFunction();
+}
+
+gmacError_t Accelerator::copyPinnedToAccelerator(accptr_t acc, IOBuffer &buffer, size_t bufferOff,
+    size_t count, core::hpe::Mode &mode, cl_command_queue stream)
+{
+    trace::EnterCurrentFunction();
+    cl_mem mem = buffer.getCLBuffer();
+    size_t off = buffer.memOffset() + bufferOff;
+    TRACE(LOCAL, "Async pinned copy to accelerator: %p ("FMT_SIZE") @ %p", buffer.addr() + bufferOff,
+          count, acc.get());
+
+    cl_event start, end;
+    cl_int ret;
+
+    buffer.toAccelerator(dynamic_cast<opencl::Mode &>(mode));
+    lock();
+    // Mapping and unmapping the range for writing tells the runtime that
+    // the host has updated the user memory
+    hostptr_t host = (hostptr_t)clEnqueueMapBuffer(stream, mem, CL_FALSE, CL_MAP_WRITE,
+                                                   off, count, 0, NULL, &start, &ret);
+    CFATAL(ret == CL_SUCCESS, "Error mapping pinned memory: %d", ret);
+    ret = clEnqueueUnmapMemObject(stream, mem, host, 0, NULL, NULL);
+    CFATAL(ret == CL_SUCCESS, "Error unmapping pinned memory: %d", ret);
+    ret = clEnqueueCopyBuffer(stream, mem, acc.get(), off, acc.offset(), count, 0, NULL, &end);
+    CFATAL(ret == CL_SUCCESS, "Error copying to accelerator: %d", ret);
+    unlock();
+
+    buffer.started(start, end, count);
+    ret = clFlush(stream);
+    CFATAL(ret == CL_SUCCESS, "Error issuing copy to accelerator: %d", ret);
+
+    trace::ExitCurrentFunction();
+    return error(ret);
+}
+
+gmacError_t Accelerator::copyPinnedToHost(IOBuffer &buffer, size_t bufferOff, const accptr_t acc,
+    size_t count, core::hpe::Mode &mode, cl_command_queue stream)
+{
+    trace::EnterCurrentFunction();
+    cl_mem mem = buffer.getCLBuffer();
+    size_t off = buffer.memOffset() + bufferOff;
+    TRACE(LOCAL, "Async pinned copy to host: %p ("FMT_SIZE") @ %p", buffer.addr() + bufferOff,
+          count, acc.get());
+
+    cl_event start, end;
+    cl_int ret;
+
+    buffer.toHost(reinterpret_cast<opencl::hpe::Mode &>(mode));
+    lock();
+    ret = clEnqueueCopyBuffer(stream, acc.get(), mem, acc.offset(), off, count, 0, NULL, &start);
+    CFATAL(ret == CL_SUCCESS, "Error copying to host: %d", ret);
+    // Buffers created on host memory hold the latest data in the host
+    // memory once they are mapped
+    hostptr_t host = (hostptr_t)clEnqueueMapBuffer(stream, mem, CL_FALSE, CL_MAP_READ,
+                                                   off, count, 0, NULL, &end, &ret);
+    CFATAL(ret == CL_SUCCESS, "Error mapping pinned memory: %d", ret);
+    ASSERTION(host == buffer.addr() + bufferOff);
+    ret = clEnqueueUnmapMemObject(stream, mem, host, 0, NULL, NULL);
+    CFATAL(ret == CL_SUCCESS, "Error unmapping pinned memory: %d", ret);
+    unlock();
+
+    buffer.started(start, end, count);
+    ret = clFlush(stream);
+    CFATAL(ret == CL_SUCCESS, "Error issuing read to accelerator: %d", ret);
+
+    trace::ExitCurrentFunction();
+    return error(ret);
+}
+
 gmacError_t Accelerator::freeCLBuffer(cl_mem mem, hostptr_t addr, size_t size, GmacProtection prot)
 {
     trace::EnterCurrentFunction();
@@ -664,12 +955,13 @@ accptr_t Accelerator::hostMapAddr(const hostptr_t addr)
 }
 
 gmacError_t Accelerator::execute(cl_command_queue stream, cl_kernel kernel, cl_uint workDim,
-        const size_t *offset, const size_t *globalSize, const size_t *localSize, cl_event *event)
+        const size_t *offset, const size_t *globalSize, const size_t *localSize, cl_event *event,
+        cl_uint nDeps, const cl_event *deps)
 {
-    TRACE(LOCAL, "Executing kernel %p", kernel);
+    TRACE(LOCAL, "Executing kernel %p (%u dependencies)", kernel, nDeps);
     lock();
     cl_int ret = clEnqueueNDRangeKernel(stream, kernel, workDim, offset, globalSize, localSize,
-             0, NULL, event);
+             nDeps, deps, event);
         clFlush(stream);
     unlock();
     return error(ret);
@@ -683,7 +975,9 @@ void Accelerator::getMemInfo(size_t &free, size_t &total) const
         sizeof(value), &value, NULL);
     CFATAL(ret == CL_SUCCESS , "Unable to get attribute %d", ret);
     total = size_t(value);
-    free = total - allocatedMemory_;
+    size_t cap = util::params::ParamAcceleratorMemoryCap;
+    if(cap > 0 && cap < total) total = cap;
+    free = (total > allocatedMemory_)? total - allocatedMemory_: 0;
 }
 
 void Accelerator::getAcceleratorInfo(GmacAcceleratorInfo &info)
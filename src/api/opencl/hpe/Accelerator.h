@@ -135,6 +135,40 @@ public:
     bool translate(const hostptr_t host, cl_mem &acc, size_t &size) const;
 };
 
+/**
+ * Sub-buffers created to pass pointers to the middle of an OpenCL memory
+ * object as kernel arguments. Sub-buffers are shared by all the kernel launches
+ * in the accelerator and live until their parent memory object is released
+ */
+class GMAC_LOCAL SubBufferMap :
+    protected std::map<cl_mem, std::map<size_t, cl_mem> >,
+    protected gmac::util::Lock {
+protected:
+    /** Sub-buffers of a memory object, indexed by their offset */
+    typedef std::map<size_t, cl_mem> RegionMap;
+    /** Base type from STL */
+    typedef std::map<cl_mem, RegionMap> Parent;
+public:
+    /** Default constructor */
+    SubBufferMap() : Lock("SubBufferMap") { }
+    /** Default destructor */
+    virtual ~SubBufferMap();
+
+    /** Get the sub-buffer that starts at the given accelerator address,
+     *  creating it if it does not exist yet
+     * \param mem Reference to store the sub-buffer
+     * \param addr Accelerator memory address where the sub-buffer starts
+     * \param size Size (in bytes) of the parent memory object
+     * \return Error code
+     */
+    cl_int get(cl_mem &mem, const accptr_t addr, size_t size);
+
+    /** Release all the sub-buffers of a memory object
+     * \param parent OpenCL memory object whose sub-buffers are released
+     */
+    void remove(cl_mem parent);
+};
+
 /** A pool of OpenCL buffers */
 class GMAC_LOCAL CLBufferPool :
     protected std::map<size_t, std::list<std::pair<cl_mem, hostptr_t> > >,
@@ -205,6 +239,8 @@ protected:
     CommandList cmd_;
     /** Host memory allocations associated to the accelerator */
     HostMap localHostAlloc_;
+    /** Sub-buffers used as kernel arguments */
+    SubBufferMap subBuffers_;
 
     /** Tracer for data communications */
     DataCommunication trace_;
@@ -220,6 +256,21 @@ protected:
     /** Max workgroup sizes for the accelerator */
     size_t *maxSizes_;
 
+    /** OpenCL code of the built-in kernel used to scatter packed data */
+    static const char *ScatterCode_;
+    /** Program holding the built-in scatter kernel */
+    cl_program scatterProgram_;
+    /** Built-in kernel used to scatter packed data */
+    cl_kernel scatterKernel_;
+    /** Accelerator buffers holding packed data for the scatter kernel */
+    CLBufferPool scatterBuffers_;
+
+    /**
+     * Get the built-in scatter kernel, building it the first time it is used
+     * \return Scatter kernel, or NULL if it cannot be built for the accelerator
+     */
+    cl_kernel getScatterKernel();
+
 public:
     /** Default constructor
      * \param n Accelerator number
@@ -342,6 +393,34 @@ public:
      */
     gmacError_t freeCLBuffer(cl_mem mem, hostptr_t addr, size_t size, GmacProtection prot);
 
+    /**
+     * Copies data from an I/O buffer on pinned user memory to accelerator
+     * memory, through the cl_mem wrapping the pinned range
+     * \param acc Destination accelerator memory address
+     * \param buffer I/O buffer on pinned user memory
+     * \param bufferOff Offset (in bytes) of the data within the I/O buffer
+     * \param count Size (in bytes) of the data to be copied
+     * \param mode Execution mode performing the copy
+     * \param stream OpenCL command queue where the copy is enqueued
+     * \return Error code
+     */
+    gmacError_t copyPinnedToAccelerator(accptr_t acc, IOBuffer &buffer, size_t bufferOff,
+                                        size_t count, core::hpe::Mode &mode, cl_command_queue stream);
+
+    /**
+     * Copies data from accelerator memory to an I/O buffer on pinned user
+     * memory, through the cl_mem wrapping the pinned range
+     * \param buffer I/O buffer on pinned user memory
+     * \param bufferOff Offset (in bytes) of the data within the I/O buffer
+     * \param acc Source accelerator memory address
+     * \param count Size (in bytes) of the data to be copied
+     * \param mode Execution mode performing the copy
+     * \param stream OpenCL command queue where the copy is enqueued
+     * \return Error code
+     */
+    gmacError_t copyPinnedToHost(IOBuffer &buffer, size_t bufferOff, const accptr_t acc,
+                                 size_t count, core::hpe::Mode &mode, cl_command_queue stream);
+
     /**
      * Get the accelerator memory address where pinned host memory can be accessed
      * \param addr Host memory address to be mapped to the accelerator
@@ -349,6 +428,17 @@ public:
      */
     accptr_t hostMapAddr(hostptr_t addr);
 
+    /**
+     * Get an OpenCL memory object that starts at an accelerator address
+     * with a non-zero offset. Sub-buffers are cached until the memory
+     * object they belong to is unmapped
+     * \param mem Reference to store the OpenCL memory object
+     * \param addr Accelerator memory address
+     * \param size Size (in bytes) of the allocation that contains the address
+     * \return Error code
+     */
+    gmacError_t getSubBuffer(cl_mem &mem, const accptr_t addr, size_t size);
+
     /**
      * Executes a kernel in the accelerator
      * \param stream OpenCL command queue
@@ -358,10 +448,13 @@ public:
      * \param globalSize Global size of the kernel to execute
      * \param localSize Local size of the kernel to execute
      * \param event OpenCL event to notify the end of execution
+     * \param nDeps Number of events the kernel execution depends on
+     * \param deps OpenCL events that must be completed before the kernel starts
      * \return Error code
      */
     gmacError_t execute(cl_command_queue stream, cl_kernel kernel, cl_uint workDim,
-        const size_t *offset, const size_t *globalSize, const size_t *localSize, cl_event *event);
+        const size_t *offset, const size_t *globalSize, const size_t *localSize, cl_event *event,
+        cl_uint nDeps = 0, const cl_event *deps = NULL);
 
     /**
      * Gets the default OpenCL command queue
@@ -450,6 +543,12 @@ public:
     TESTABLE gmacError_t copyToHost(hostptr_t host, const accptr_t acc, size_t size, core::hpe::Mode &mode);
 
     TESTABLE gmacError_t copyAccelerator(accptr_t dst, const accptr_t src, size_t size, stream_t stream);
+    gmacError_t copyAcceleratorPeer(accptr_t dst, core::hpe::Accelerator &srcAcc, const accptr_t src, size_t size, stream_t stream);
+    gmacError_t scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                     unsigned count, size_t size, core::hpe::Mode &mode, stream_t stream);
+    gmacError_t pinMemory(hostptr_t addr, size_t size, void *&handle);
+    void unpinMemory(hostptr_t addr, size_t size, void *handle);
+    bool hasPeerAccess(const core::hpe::Accelerator &acc) const;
     gmacError_t memset(accptr_t addr, int c, size_t size, stream_t stream);
     void getMemInfo(size_t &free, size_t &total) const;
     void getAcceleratorInfo(GmacAcceleratorInfo &info);
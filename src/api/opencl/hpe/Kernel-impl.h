@@ -1,6 +1,8 @@
 #ifndef GMAC_API_OPENCL_KERNEL_IMPL_H_
 #define GMAC_API_OPENCL_KERNEL_IMPL_H_
 
+#include <cstring>
+
 #include "util/Logger.h"
 
 #include "hpe/init.h"
@@ -12,7 +14,7 @@ namespace __impl { namespace opencl { namespace hpe {
 
 inline
 Kernel::Kernel(const core::hpe::KernelDescriptor & k, cl_kernel kernel) :
-    gmac::core::hpe::Kernel(k), f_(kernel)
+    gmac::core::hpe::Kernel(k), f_(kernel), owner_(NULL)
 {
     cl_int ret = clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS, sizeof(cl_int), &nArgs_, NULL);
     ASSERTION(ret == CL_SUCCESS);
@@ -61,24 +63,61 @@ KernelLaunch::setConfiguration(cl_uint work_dim, const size_t *globalWorkOffset,
 inline gmacError_t
 KernelLaunch::setArgument(const void *arg, size_t size, unsigned index)
 {
+    if(index >= args_.size()) return gmacErrorInvalidValue;
+    gmacError_t ret = gmacSuccess;
+    if(kernel_.owner_ != this) {
+        ret = restoreArguments();
+        if(ret != gmacSuccess) return ret;
+    }
+
+    Argument &current = args_[index];
+    const uint8_t *value = static_cast<const uint8_t *>(arg);
+    if(current.first == size && (arg == NULL) == current.second.empty() &&
+       (arg == NULL || ::memcmp(&current.second[0], value, size) == 0)) {
+        TRACE(LOCAL, "Param %u @ %p ("FMT_SIZE") is already set", index, arg, size);
+        return gmacSuccess;
+    }
+
     TRACE(LOCAL, "Setting param %u @ %p ("FMT_SIZE")", index, arg, size);
-    cl_int ret = clSetKernelArg(f_, index, size, arg);
-    return Accelerator::error(ret);
+    ret = Accelerator::error(clSetKernelArg(f_, index, size, arg));
+    if(ret != gmacSuccess) {
+        // The OpenCL kernel keeps the previous value
+        return ret;
+    }
+    current.first = size;
+    if(arg == NULL) current.second.clear();
+    else current.second.assign(value, value + size);
+    return ret;
+}
+
+inline bool
+KernelLaunch::isConfigured() const
+{
+    return workGlobalDim_ > 0;
+}
+
+inline void
+KernelLaunch::setDependencies(unsigned nDeps, const cl_event *deps)
+{
+    deps_.assign(deps, deps + nDeps);
 }
 
 inline
-KernelLaunch::KernelLaunch(Mode &mode, const Kernel & k, cl_command_queue stream) :
+KernelLaunch::KernelLaunch(Mode &mode, Kernel & k, cl_command_queue stream) :
 #ifdef DEBUG
     core::hpe::KernelLaunch(dynamic_cast<core::hpe::Mode &>(mode), k.key()),
 #else
     core::hpe::KernelLaunch(dynamic_cast<core::hpe::Mode &>(mode)),
 #endif
+    kernel_(k),
     f_(k.f_),
     stream_(stream),
+    event_(NULL),
     workGlobalDim_(0),
     workLocalDim_(0),
     offsetDim_(0),
-    trace_(mode.getAccelerator().getMajor(), mode.getAccelerator().getMinor())
+    trace_(mode.getAccelerator().getMajor(), mode.getAccelerator().getMinor()),
+    args_(k.nArgs_, Argument(0, std::vector<uint8_t>()))
 {
     clRetainKernel(f_);
 }
@@ -86,22 +125,9 @@ KernelLaunch::KernelLaunch(Mode &mode, const Kernel & k, cl_command_queue stream
 inline
 KernelLaunch::~KernelLaunch()
 {
+    if(kernel_.owner_ == this) kernel_.owner_ = NULL;
+    if(event_ != NULL) clReleaseEvent(event_);
     clReleaseKernel(f_);
-
-    CacheSubBuffer::iterator itCacheMap;
-    for (itCacheMap = cacheSubBuffer_.begin(); itCacheMap != cacheSubBuffer_.end(); ++itCacheMap) {
-        __impl::core::hpe::Mode *mode = itCacheMap->second.first;
-        MapSubBuffer::iterator sb = itCacheMap->second.second;
-        if (--sb->second.second == 0) {
-            MapGlobalSubBuffer::iterator itG = mapSubBuffer_.findMode(*mode);
-            MapSubBuffer &map = itG->second;
-               
-            int err = clReleaseMemObject(sb->second.first);
-            ASSERTION(err == CL_SUCCESS);
-            map.erase(sb);
-        }
-    }
-    cacheSubBuffer_.clear();
 }
 
 inline
@@ -111,25 +137,6 @@ KernelLaunch::getCLEvent()
     return event_;
 }
 
-#if 0
-inline
-bool
-KernelLaunch::hasSubBuffer(hostptr_t ptr) const
-{
-    return subBuffers_.find(ptr) != subBuffers_.end();
-}
-#endif
-
-#if 0
-inline
-void
-KernelLaunch::setSubBuffer(hostptr_t ptr, cl_mem subMem)
-{
-    ASSERTION(hasSubBuffer(ptr) == false);
-    subBuffers_.insert(std::map<hostptr_t, cl_mem>::value_type(ptr, subMem));
-}
-#endif
-
 }}}
 
 #endif
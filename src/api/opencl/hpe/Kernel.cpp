@@ -2,62 +2,77 @@
 #include "Mode.h"
 #include "Accelerator.h"
 
+#include "memory/Object.h"
+#include "memory/ObjectMap.h"
 #include "trace/Tracer.h"
+#include "util/Parameter.h"
 
 namespace __impl { namespace opencl { namespace hpe {
 
-KernelLaunch::MapGlobalSubBuffer KernelLaunch::mapSubBuffer_;
-
 gmacError_t
 KernelLaunch::execute()
 {
     trace_.init((THREAD_T)mode_.getId());
+    gmacError_t ret = gmacSuccess;
+    // Another launch of the same kernel might have changed the arguments
+    if(kernel_.owner_ != this) ret = restoreArguments();
+    if(ret != gmacSuccess) return ret;
+    // Shared objects might have been evicted and mapped back
+    if(util::params::ParamOversubscribe == true) ret = translateObjects();
+    if(ret != gmacSuccess) return ret;
+
     size_t *globalWorkSize   = globalWorkSize_;
     size_t *localWorkSize    = workLocalDim_ > 0? localWorkSize_: NULL;
     size_t *globalWorkOffset = offsetDim_    > 0? globalWorkOffset_: NULL;
 
-    gmacError_t ret = dynamic_cast<Mode &>(mode_).getAccelerator().execute(stream_, f_, workGlobalDim_,
-        globalWorkOffset, globalWorkSize, localWorkSize, &event_);
-    if(ret == gmacSuccess) trace_.trace(f_, event_);
+    if(event_ != NULL) clReleaseEvent(event_);
+    event_ = NULL;
+
+    const cl_event *deps = deps_.empty()? NULL: &deps_[0];
+    ret = dynamic_cast<Mode &>(mode_).getAccelerator().execute(stream_, f_, workGlobalDim_,
+        globalWorkOffset, globalWorkSize, localWorkSize, &event_, cl_uint(deps_.size()), deps);
+    deps_.clear();
+    if(ret != gmacSuccess) return ret;
+    // The tracer releases its own reference to the event
+    clRetainEvent(event_);
+    trace_.trace(f_, event_);
     return ret;
 }
 
-cl_mem
-KernelLaunch::getSubBuffer(__impl::opencl::hpe::Mode &mode, hostptr_t ptr, accptr_t accPtr, size_t size)
+gmacError_t
+KernelLaunch::restoreArguments()
 {
-    cl_mem ret;
-
-    CacheSubBuffer::const_iterator itCacheMap = cacheSubBuffer_.find(ptr);
-    if (itCacheMap == cacheSubBuffer_.end()) {
-        // find always returns a value
-        MapGlobalSubBuffer::iterator itGlobalMap = mapSubBuffer_.findMode(mode);
-
-        MapSubBuffer &mapMode = itGlobalMap->second;
-        MapSubBuffer::iterator itModeMap = mapMode.find(ptr);
-
-        if (itModeMap == mapMode.end()) {
-            int err;
-            cl_buffer_region region;
-            region.origin = accPtr.offset();
-            region.size   = size - accPtr.offset();
-            ret = clCreateSubBuffer(accPtr.get(), CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &err);
-            ASSERTION(err == CL_SUCCESS);
-
-            mapMode.insert(MapSubBuffer::value_type(ptr, CLMemRef(ret, 0)));
-            itModeMap = mapMode.find(ptr);
-        }
-
-        ret = itModeMap->second.first;
-        itModeMap->second.second++;
-        cacheSubBuffer_.insert(CacheSubBuffer::value_type(ptr, CacheEntry(&mode, itModeMap)));
-    } else {
-        // Cache-entry -> CacheEntry -> iterator -> pair
-        ret = itCacheMap->second.second->second.first;
+    TRACE(LOCAL, "Restoring arguments for kernel launch");
+    for(unsigned i = 0; i < args_.size(); i++) {
+        const Argument &arg = args_[i];
+        if(arg.first == 0) continue;
+        const void *value = arg.second.empty()? NULL: &arg.second[0];
+        cl_int ret = clSetKernelArg(f_, i, arg.first, value);
+        if(ret != CL_SUCCESS) return Accelerator::error(ret);
     }
+    kernel_.owner_ = this;
+    return gmacSuccess;
+}
 
+gmacError_t
+KernelLaunch::translateObjects()
+{
+    Mode &mode = dynamic_cast<Mode &>(mode_);
+    gmacError_t ret = gmacSuccess;
+    std::map<unsigned, std::list<memory::ObjectInfo>::iterator>::const_iterator i;
+    for(i = paramToParamPtr_.begin(); i != paramToParamPtr_.end() && ret == gmacSuccess; ++i) {
+        hostptr_t ptr = i->second->first;
+        // Host mapped objects are never evicted
+        memory::Object *obj = mode.getAddressSpace().getObject(ptr);
+        if(obj == NULL) continue;
+        accptr_t acc = obj->acceleratorAddr(mode, ptr);
+        cl_mem mem = acc.get();
+        if(acc.offset() > 0) ret = mode.getAccelerator().getSubBuffer(mem, acc, obj->size());
+        obj->decRef();
+        // Arguments that did not change are not set again
+        if(ret == gmacSuccess) ret = setArgument(&mem, sizeof(cl_mem), i->first);
+    }
     return ret;
 }
 
-
-
 }}}
@@ -42,6 +42,7 @@ WITH THE SOFTWARE.  */
 #endif
 
 #include <list>
+#include <vector>
 
 #include "config/common.h"
 
@@ -64,6 +65,8 @@ protected:
     cl_kernel f_;
     /** Number of arguments requried by the kernel */
     unsigned nArgs_;
+    /** Launch whose arguments are currently set in the OpenCL kernel */
+    const KernelLaunch *owner_;
 public:
     /**
      * Default constructor
@@ -96,42 +99,19 @@ class GMAC_LOCAL KernelLaunch :
     public util::NonCopyable {
     friend class Kernel;
 
-    typedef std::pair<cl_mem, unsigned> CLMemRef;
-    typedef std::map<hostptr_t, CLMemRef> MapSubBuffer;
-    class MapGlobalSubBuffer :
-        protected std::map<__impl::core::hpe::Mode *, MapSubBuffer>,
-        protected gmac::util::SpinLock
-    {
-    public:
-        typedef std::map<__impl::core::hpe::Mode *, MapSubBuffer> Parent;
-        typedef Parent::iterator iterator;
-        MapGlobalSubBuffer() :
-            gmac::util::SpinLock("SubBuffer Lock")
-        {
-        }
-
-        iterator findMode(__impl::core::hpe::Mode &mode)
-        {
-            lock();
-            Parent::iterator itGlobalMap = this->find(&mode);
-            if (itGlobalMap == this->end()) {
-                this->insert(Parent::value_type(&mode, MapSubBuffer()));
-                itGlobalMap = this->find(&mode);
-            }
-            unlock();
-            return itGlobalMap;
-        }
-    };
-
-    typedef std::pair<__impl::core::hpe::Mode *, MapSubBuffer::iterator> CacheEntry;
-    typedef std::map<hostptr_t, CacheEntry> CacheSubBuffer;
+    /** Value of a kernel argument, as passed to clSetKernelArg */
+    typedef std::pair<size_t, std::vector<uint8_t> > Argument;
+    typedef std::vector<Argument> ArgumentList;
 
 protected:
+    /** Kernel being launched */
+    Kernel &kernel_;
     /** OpenCL kernel code */
     cl_kernel f_;
     /** OpenCL command queue where the kernel is executed */
     cl_command_queue stream_;
 
+    /** Event of the last execution, retained until the next execution */
     cl_event event_;
 
     /** Number of dimensions the kernel will execute */
@@ -148,11 +128,25 @@ protected:
     /** Tracer */
     KernelExecution trace_;
 
-    /** Subbuffers created to allow pointer arithmetic */
-    static MapGlobalSubBuffer mapSubBuffer_;
+    /** Last value set for each kernel argument */
+    ArgumentList args_;
 
-    /** Cache of subbuffers created to allow pointer arithmetic */
-    CacheSubBuffer cacheSubBuffer_;
+    /** Events that must complete before the next execution starts */
+    std::vector<cl_event> deps_;
+
+    /**
+     * Set the values of all the arguments of the launch in the OpenCL kernel,
+     * which might have been overwritten by other launches of the same kernel
+     * \return Error code
+     */
+    gmacError_t restoreArguments();
+
+    /**
+     * Set again the shared object arguments of the launch. Objects evicted
+     * from accelerator memory get a new OpenCL buffer when mapped back
+     * \return Error code
+     */
+    gmacError_t translateObjects();
 
     /**
      * Default constructor
@@ -160,7 +154,7 @@ protected:
      * \param k OpenCL kernel object
      * \param stream OpenCL command queue executing the kernel
      */
-    KernelLaunch(Mode &mode, const Kernel & k, cl_command_queue stream);
+    KernelLaunch(Mode &mode, Kernel & k, cl_command_queue stream);
 public:
     /**
      * Default destructor
@@ -190,37 +184,29 @@ public:
         const size_t *globalWorkSize, const size_t *localWorkSize);
 
     /**
-     * Set a new argument for the kernel
+     * Set a new argument for the kernel. Arguments are kept across executions
+     * of the launch, and setting an argument to its current value does not
+     * call OpenCL
      * \param arg Pointer to the value for the argument
      * \param size Size (in bytes) of the argument
      * \param index Index of the argument in the argument list
      */
     gmacError_t setArgument(const void * arg, size_t size, unsigned index);
 
-#if 0
-    /**
-     * Tells if the kernel launch object already has a subbuffer for the given pointer
-     * \param ptr Pointer to be used as an argument in a kernel call
-     * \return A boolean that tells if the kernel launch object already has a subbuffer for the given pointer
-     */
-    bool hasSubBuffer(hostptr_t ptr) const;
-#endif
-
     /**
-     * Returns the subbuffer associated to the given pointer
-     * \param ptr Pointer to be used as an argument in a kernel call
-     * \return The subbuffer associated to the given pointer
+     * Tells if the launch has been configured by a previous call to
+     * setConfiguration
+     * \return True if the launch can be executed
      */
-    cl_mem getSubBuffer(__impl::opencl::hpe::Mode &mode, hostptr_t ptr, accptr_t accPtr, size_t size);
+    bool isConfigured() const;
 
-#if 0
     /**
-     * Sets the subbuffer associated to the given pointer
-     * \param ptr Pointer to be used as an argument in a kernel call
-     * \param subMeme The subbuffer associated to the given pointer
+     * Set the events the next execution of the kernel depends on. The
+     * dependencies only apply to the next call to execute
+     * \param nDeps Number of events
+     * \param deps OpenCL events that must complete before the kernel starts
      */
-    void setSubBuffer(hostptr_t ptr, cl_mem subMem);
-#endif
+    void setDependencies(unsigned nDeps, const cl_event *deps);
 };
 
 }}}
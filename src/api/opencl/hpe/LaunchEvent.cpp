@@ -0,0 +1,77 @@
+#include "LaunchEvent.h"
+#include "Accelerator.h"
+#include "Kernel.h"
+#include "Mode.h"
+
+#include "hpe/init.h"
+#include "memory/Manager.h"
+
+namespace __impl { namespace opencl { namespace hpe {
+
+LaunchEvent::LaunchEvent(KernelLaunch &launch) :
+    gmac::util::Lock("LaunchEvent"),
+    mode_(dynamic_cast<Mode &>(launch.getMode())),
+    event_(launch.getCLEvent()),
+    acquired_(false),
+    waits_(mode_.waits()),
+    completed_(false)
+{
+    clRetainEvent(event_);
+    // Objects only read by the kernel are still valid in the host
+    std::list<memory::ObjectInfo>::const_iterator i;
+    for(i = launch.getObjects().begin(); i != launch.getObjects().end(); ++i) {
+        if((i->second & GMAC_PROT_WRITE) != 0) written_.push_back(*i);
+    }
+}
+
+LaunchEvent::~LaunchEvent()
+{
+    clReleaseEvent(event_);
+}
+
+cl_event
+LaunchEvent::getCLEvent() const
+{
+    return event_;
+}
+
+void
+LaunchEvent::complete()
+{
+    if(completed_ == true) return;
+    mode_.completed(waits_);
+    completed_ = true;
+}
+
+gmacError_t
+LaunchEvent::query()
+{
+    cl_int status = mode_.getAccelerator().queryCLevent(event_);
+    if(status < 0) return Accelerator::error(status);
+    if(status != CL_COMPLETE) return gmacErrorNotReady;
+    lock();
+    complete();
+    unlock();
+    return gmacSuccess;
+}
+
+gmacError_t
+LaunchEvent::wait()
+{
+    gmacError_t ret = mode_.waitForEvent(event_);
+    if(ret != gmacSuccess) return ret;
+
+    lock();
+    complete();
+    if(acquired_ == false) {
+        TRACE(LOCAL, "Acquiring "FMT_SIZE" objects written by the kernel", written_.size());
+        // An empty list would acquire all the objects in the mode
+        if(written_.empty() == false)
+            ret = memory::getManager().acquireObjects(mode_, written_);
+        acquired_ = (ret == gmacSuccess);
+    }
+    unlock();
+    return ret;
+}
+
+}}}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_API_OPENCL_HPE_LAUNCHEVENT_H_
+#define GMAC_API_OPENCL_HPE_LAUNCHEVENT_H_
+
+#if defined(__APPLE__)
+#   include <OpenCL/cl.h>
+#else
+#   include <CL/cl.h>
+#endif
+
+#include <list>
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "memory/Manager.h"
+#include "util/Lock.h"
+#include "util/NonCopyable.h"
+
+namespace __impl { namespace opencl { namespace hpe {
+
+class Mode;
+class KernelLaunch;
+
+/**
+ * Completion handle of an asynchronous kernel execution. The handle can be
+ * used as a dependency of later executions, and the objects written by the
+ * kernel are acquired by the host only when the handle is waited for
+ */
+class GMAC_LOCAL LaunchEvent :
+    protected gmac::util::Lock,
+    public util::NonCopyable {
+protected:
+    /** Execution mode that launched the kernel */
+    Mode &mode_;
+    /** OpenCL event completed when the kernel execution is done */
+    cl_event event_;
+    /** Objects the kernel might have written */
+    std::list<memory::ObjectInfo> written_;
+    /** Whether the written objects have been already acquired */
+    bool acquired_;
+    /** Number of waits of the mode when the kernel was launched */
+    unsigned waits_;
+    /** Whether the kernel has been already reported as finished to the mode */
+    bool completed_;
+
+    /**
+     * Reports the kernel as finished to the mode, only once. The event lock
+     * must be held
+     */
+    void complete();
+
+public:
+    /**
+     * Creates a handle for the last execution of a kernel launch
+     * \param launch Kernel launch that has been just executed
+     */
+    LaunchEvent(KernelLaunch &launch);
+
+    /** Default destructor */
+    ~LaunchEvent();
+
+    /**
+     * Gets the OpenCL event for the kernel execution
+     * \return OpenCL event
+     */
+    cl_event getCLEvent() const;
+
+    /**
+     * Tells if the kernel execution is done, without blocking
+     * \return gmacSuccess if the kernel has finished, gmacErrorNotReady if
+     * it is still running, or the execution error otherwise
+     */
+    gmacError_t query();
+
+    /**
+     * Waits for the kernel execution and acquires the objects it wrote. Other
+     * objects used by the kernel and kernels still running are not affected
+     * \return Error code
+     */
+    gmacError_t wait();
+};
+
+}}}
+
+#endif
+
+/* vim:set backspace=2 tabstop=4 shiftwidth=4 textwidth=120 foldmethod=marker expandtab: */
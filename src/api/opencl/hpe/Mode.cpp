@@ -4,6 +4,8 @@
 #include "api/opencl/hpe/Context.h"
 #include "api/opencl/hpe/Mode.h"
 
+#include "util/Monitor.h"
+
 namespace __impl { namespace opencl { namespace hpe {
 
 Mode::Mode(core::hpe::Process &proc, Accelerator &acc, core::hpe::AddressSpace &aSpace) :
@@ -31,6 +33,10 @@ core::IOBuffer &Mode::createIOBuffer(size_t size, GmacProtection prot)
     } else {
         ret = new IOBuffer(*this, addr, size, mem, prot);
     }
+    if(monitor_ != NULL) {
+        util::Monitor::add(monitor_->ioBuffers_, 1);
+        util::Monitor::add(monitor_->ioBufferBytes_, size);
+    }
     return *ret;
 }
 
@@ -42,6 +48,25 @@ void Mode::destroyIOBuffer(core::IOBuffer &_buffer)
     } else {
         ::free(buffer.addr());
     }
+    if(monitor_ != NULL) {
+        util::Monitor::add(monitor_->ioBuffers_, -1);
+        util::Monitor::add(monitor_->ioBufferBytes_, -int64_t(buffer.size()));
+    }
+    delete &buffer;
+}
+
+core::IOBuffer *Mode::registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot)
+{
+    void *handle = NULL;
+    size_t offset = 0;
+    if(getAccelerator().getRegistrations().acquire(addr, size, handle, offset) == false) return NULL;
+    // Transfers go through the cl_mem wrapping the pinned range
+    return new IOBuffer(*this, addr, size, cl_mem(handle), offset, prot);
+}
+
+void Mode::unregisterIOBuffer(core::IOBuffer &buffer)
+{
+    getAccelerator().getRegistrations().release(buffer.addr());
     delete &buffer;
 }
 
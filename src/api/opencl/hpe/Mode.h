@@ -160,6 +160,21 @@ public:
     */
     void destroyIOBuffer(core::IOBuffer &buffer);
 
+    //! Create an IO buffer on user memory pinned in the accelerator
+    /*!
+        \param addr Starting address of the user memory
+        \param size Size (in bytes) of the user memory
+        \param prot Tells whether the buffer is going to be read or written by the host
+        \return Pointer to the created I/O buffer or NULL if the memory is not pinned
+    */
+    core::IOBuffer *registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot);
+
+    //! Destroy an I/O buffer created on user memory
+    /*!
+        \param buffer I/O buffer to be released
+    */
+    void unregisterIOBuffer(core::IOBuffer &buffer);
+
     //! Block the CPU thread until an event happens
     /*!
         \param event Event to wait for
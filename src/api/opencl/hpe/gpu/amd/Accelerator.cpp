@@ -18,6 +18,8 @@ gmacError_t Accelerator::copyToAcceleratorAsync(accptr_t acc, core::IOBuffer &_b
     size_t bufferOff, size_t count, core::hpe::Mode &mode, cl_command_queue stream)
 {
     IOBuffer &buffer = dynamic_cast<IOBuffer &>(_buffer);
+    // Pinned user memory is copied through the cl_mem wrapping it
+    if (buffer.pinned() == true) return copyPinnedToAccelerator(acc, buffer, bufferOff, count, mode, stream);
     hostptr_t host = buffer.addr() + bufferOff;
 
     trace::EnterCurrentFunction();
@@ -77,6 +79,8 @@ gmacError_t Accelerator::copyToHostAsync(core::IOBuffer &_buffer, size_t bufferO
     const accptr_t acc, size_t count, core::hpe::Mode &mode, cl_command_queue stream)
 {
     IOBuffer &buffer = dynamic_cast<IOBuffer &>(_buffer);
+    // Pinned user memory is copied through the cl_mem wrapping it
+    if (buffer.pinned() == true) return copyPinnedToHost(buffer, bufferOff, acc, count, mode, stream);
     hostptr_t host = buffer.addr() + bufferOff;
 
     trace::EnterCurrentFunction();
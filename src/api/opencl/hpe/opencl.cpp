@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "config/order.h"
 
 #include "core/hpe/Process.h"
@@ -8,6 +11,8 @@
 
 #include "api/opencl/opencl_utils.h"
 
+#include "util/Parameter.h"
+
 static bool initialized = false;
 void OpenCL(gmac::core::hpe::Process &proc)
 {
@@ -38,6 +43,27 @@ void OpenCL(gmac::core::hpe::Process &proc)
         ASSERTION(ret == CL_SUCCESS);
         MESSAGE("... found %u OpenCL devices", deviceSize, i);
 
+        unsigned subDevices = __impl::util::params::ParamOpenCLSubDevices;
+        if (subDevices > 1) {
+            // Each CPU sub-device becomes a separate accelerator
+            std::vector<cl_device_id> split;
+            for (unsigned j = 0; j < deviceSize; j++) {
+                std::vector<cl_device_id> sub;
+                if (__impl::opencl::util::isDeviceCPU(devices[j])) {
+                    sub = __impl::opencl::util::getSubDevices(devices[j], subDevices);
+                }
+                if (sub.empty()) split.push_back(devices[j]);
+                else {
+                    MESSAGE("... splitting device into %u sub-devices", unsigned(sub.size()));
+                    split.insert(split.end(), sub.begin(), sub.end());
+                }
+            }
+            delete[] devices;
+            deviceSize = cl_uint(split.size());
+            devices = new cl_device_id[deviceSize];
+            std::copy(split.begin(), split.end(), devices);
+        }
+
         __impl::opencl::util::OpenCLVersion clVersion = __impl::opencl::util::getOpenCLVersion(platforms[i]);
 
         cl_context ctx;
@@ -91,6 +91,18 @@ void Mode::destroyIOBuffer(core::IOBuffer &buffer)
     delete &buffer;
 }
 
+inline
+core::IOBuffer *Mode::registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot)
+{
+    return NULL;
+}
+
+inline
+void Mode::unregisterIOBuffer(core::IOBuffer &buffer)
+{
+    FATAL("User memory I/O buffers are not supported in GMAC/Lite");
+}
+
 inline
 gmacError_t Mode::waitForEvent(cl_event event)
 {
@@ -133,6 +145,31 @@ Mode::hasUnifiedAddressing() const
     return false;
 }
 
+inline bool
+Mode::hasPeerAccess(core::Mode &mode) const
+{
+    return &mode == this;
+}
+
+inline gmacError_t
+Mode::copyAcceleratorPeer(accptr_t dst, core::Mode &srcMode, const accptr_t src, size_t size)
+{
+    if(&srcMode == this) return copyAccelerator(dst, src, size);
+    return gmacErrorFeatureNotSupported;
+}
+
+inline gmacError_t
+Mode::scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                           unsigned count, size_t size)
+{
+    gmacError_t ret = gmacSuccess;
+    for(unsigned n = 0; n < count; n++) {
+        ret = copyToAccelerator(acc + offsets[n], host + offsets[n], size);
+        if(ret != gmacSuccess) break;
+    }
+    return ret;
+}
+
 
 
 }}}
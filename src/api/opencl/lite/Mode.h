@@ -210,6 +210,24 @@ public:
      */
     void destroyIOBuffer(core::IOBuffer &buffer);
 
+    /**
+     * Create an I/O buffer on user memory. GMAC/Lite does not pin user memory
+     *
+     * \param addr Starting address of the user memory
+     * \param size Size (in bytes) of the user memory
+     * \param prot Tells whether the buffer is going to be read or written on the host
+     *
+     * \return Always NULL
+     */
+    core::IOBuffer *registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot);
+
+    /**
+     * Destroy an I/O buffer created on user memory
+     *
+     * \param buffer I/O buffer to be released
+     */
+    void unregisterIOBuffer(core::IOBuffer &buffer);
+
     /** Send data from an I/O buffer to the accelerator
      *
      *  \param dst Accelerator memory where data will be written to
@@ -283,6 +301,28 @@ public:
      */
     gmacError_t copyAccelerator(accptr_t dst, const accptr_t src, size_t size);
 
+    /** Copies data from the accelerator memory of another execution mode.
+     * Not supported in GMAC/Lite
+     * \param dst Destination accelerator memory
+     * \param srcMode Execution mode owning the source accelerator memory
+     * \param src Source accelerator memory
+     * \param size Number of bytes to be copied
+     * \return Error code
+     */
+    gmacError_t copyAcceleratorPeer(accptr_t dst, core::Mode &srcMode, const accptr_t src, size_t size);
+
+    /** Copies several ranges of system memory to the same ranges of
+     * accelerator memory, using one copy per range
+     * \param acc Base accelerator pointer the offsets refer to
+     * \param host Base host pointer the offsets refer to
+     * \param offsets Offsets (in bytes) of the ranges
+     * \param count Number of ranges
+     * \param size Size (in bytes) of each range
+     * \return Error code
+     */
+    gmacError_t scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                     unsigned count, size_t size);
+
     /**
      * Sets the contents of accelerator memory
      * \param addr Pointer to the accelerator memory to be set
@@ -317,6 +357,7 @@ public:
 
     bool hasIntegratedMemory() const;
     bool hasUnifiedAddressing() const;
+    bool hasPeerAccess(core::Mode &mode) const;
 
     memory::ObjectMap &getAddressSpace();
     const memory::ObjectMap &getAddressSpace() const;
@@ -528,7 +528,7 @@ BOOL APIENTRY DllMain(HANDLE /*hModule*/, DWORD dwReason, LPVOID /*lpReserved*/)
         case DLL_PROCESS_DETACH:
             break;
         case DLL_THREAD_ATTACH:
-			isRunTimeThread_.set(&privateFalse);
+			setRunTimeThread(false);
             break;
         case DLL_THREAD_DETACH:
             break;
@@ -564,9 +564,9 @@ static void *gmac_pthread(void *arg)
 
     // This TLS variable is necessary before entering GMAC
     if (externCall != true) {
-        isRunTimeThread_.set(&privateTrue);
+        setRunTimeThread(true);
     } else {
-        isRunTimeThread_.set(&privateFalse);
+        setRunTimeThread(false);
     }
 
     enterGmac();
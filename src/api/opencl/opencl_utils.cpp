@@ -1,3 +1,9 @@
+#if defined(__APPLE__)
+#   include <OpenCL/cl_ext.h>
+#else
+#   include <CL/cl_ext.h>
+#endif
+
 #include "util/Logger.h"
 #include "util/UniquePtr.h"
 
@@ -51,6 +57,37 @@ getDeviceType(cl_device_id id)
     return ret;
 }
 
+std::vector<cl_device_id>
+getSubDevices(cl_device_id id, unsigned count)
+{
+    std::vector<cl_device_id> ret;
+#if defined(cl_ext_device_fission)
+    clCreateSubDevicesEXT_fn createSubDevices =
+        (clCreateSubDevicesEXT_fn)clGetExtensionFunctionAddress("clCreateSubDevicesEXT");
+    if(createSubDevices == NULL) return ret;
+
+    cl_uint units;
+    cl_int err = clGetDeviceInfo(id, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(units), &units, NULL);
+    if(err != CL_SUCCESS || units < count) return ret;
+
+    // Spread the compute units across the sub-devices
+    std::vector<cl_device_partition_property_ext> props;
+    props.push_back(CL_DEVICE_PARTITION_BY_COUNTS_EXT);
+    for(unsigned i = 0; i < count; i++) {
+        props.push_back(units / count + ((i < units % count)? 1: 0));
+    }
+    props.push_back(CL_PARTITION_BY_COUNTS_LIST_END_EXT);
+    props.push_back(CL_PROPERTIES_LIST_END_EXT);
+
+    ret.resize(count);
+    cl_uint n = 0;
+    err = createSubDevices(id, &props[0], count, &ret[0], &n);
+    if(err != CL_SUCCESS) ret.clear();
+    else ret.resize(n);
+#endif
+    return ret;
+}
+
 OpenCLPlatform
 getPlatform(cl_platform_id id)
 {
@@ -2,6 +2,7 @@
 #define GMAC_API_OPENCL_OPENCLUTILS_H_
 
 #include <string>
+#include <vector>
 
 #include "config/common.h"
 
@@ -56,6 +57,9 @@ isDeviceGPU(cl_device_id id);
 bool GMAC_LOCAL
 isDeviceCPU(cl_device_id id);
 
+std::vector<cl_device_id> GMAC_LOCAL
+getSubDevices(cl_device_id id, unsigned count);
+
 // Context functions
 cl_device_id GMAC_LOCAL
 getContextDevice(cl_context context);
@@ -54,7 +54,7 @@ typedef signed __int32 int32_t;
 typedef unsigned __int64 uint64_t;
 typedef signed __int64 int64_t;
 typedef signed __int64 ssize_t;
-typedef int ptroff_t;
+typedef size_t ptroff_t;
 
 typedef ULONG_PTR long_t;
 #endif
@@ -12,7 +12,8 @@ namespace __impl { namespace core {
 inline
 Mode::Mode() :
     util::Reference("Mode"),
-    gmac::util::SpinLock("Mode")
+    gmac::util::SpinLock("Mode"),
+    monitor_(util::Monitor::acquireMode(getId()))
 {
     TRACE(LOCAL,"Creating Execution Mode %p", this);
     trace::StartThread(THREAD_T(getId()), "GPU");
@@ -23,9 +24,16 @@ inline
 Mode::~Mode()
 {
     trace::EndThread(THREAD_T(getId()));
+    util::Monitor::releaseMode(monitor_);
     TRACE(LOCAL,"Destroying Execution Mode %p", this);
 }
 
+inline util::MonitorMode *
+Mode::monitor() const
+{
+    return monitor_;
+}
+
 
 } }
 
@@ -41,6 +41,7 @@ WITH THE SOFTWARE.  */
 #endif
 #include "util/Atomics.h"
 #include "util/Lock.h"
+#include "util/Monitor.h"
 #include "util/NonCopyable.h"
 #include "util/Reference.h"
 #include "util/Unique.h"
@@ -68,6 +69,9 @@ class GMAC_LOCAL Mode :
     public util::Unique<Mode>,
     public gmac::util::SpinLock {
 protected:
+    /** Slot where the live counters of the mode are published, or NULL */
+    util::MonitorMode *monitor_;
+
     /**
      * Mode constructor
      */
@@ -142,6 +146,19 @@ public:
      */
     virtual gmacError_t copyToAccelerator(accptr_t acc, const hostptr_t host, size_t size) = 0;
 
+    /**
+     * Copies several ranges of system memory to the same ranges of
+     * accelerator memory
+     * \param acc Base accelerator pointer the offsets refer to
+     * \param host Base host pointer the offsets refer to
+     * \param offsets Offsets (in bytes) of the ranges
+     * \param count Number of ranges
+     * \param size Size (in bytes) of each range
+     * \return Error code
+     */
+    virtual gmacError_t scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                             unsigned count, size_t size) = 0;
+
     /**
      * Copies data from accelerator memory to system memory
      * \param host Destination host pointer
@@ -159,6 +176,16 @@ public:
      */
     virtual gmacError_t copyAccelerator(accptr_t dst, const accptr_t src, size_t size) = 0;
 
+    /** Copies data from the accelerator memory of another execution mode to
+     * the accelerator memory of this mode
+     * \param dst Destination accelerator memory
+     * \param srcMode Execution mode owning the source accelerator memory
+     * \param src Source accelerator memory
+     * \param size Number of bytes to be copied
+     * \return Error code
+     */
+    virtual gmacError_t copyAcceleratorPeer(accptr_t dst, Mode &srcMode, const accptr_t src, size_t size) = 0;
+
     /**
      * Sets the contents of accelerator memory
      * \param addr Pointer to the accelerator memory to be set
@@ -184,6 +211,25 @@ public:
      */
     virtual void destroyIOBuffer(IOBuffer &buffer) = 0;
 
+    /**
+     * Creates an IOBuffer that uses user memory directly. The memory must be
+     * registered in the accelerator, or large enough to be pinned on the fly
+     * \param addr Starting address of the user memory
+     * \param size Size (in bytes) of the user memory
+     * \param prot Tells whether the buffer is going to be read or written
+     * on the host
+     * \return A pointer to the created IOBuffer or NULL if the memory cannot
+     *         be used in transfers
+     */
+    virtual IOBuffer *registerIOBuffer(hostptr_t addr, size_t size, GmacProtection prot) = 0;
+
+    /**
+     * Destroys an IOBuffer created by registerIOBuffer. The user memory is
+     * not released
+     * \param buffer Reference to the buffer to be destroyed
+     */
+    virtual void unregisterIOBuffer(IOBuffer &buffer) = 0;
+
     /** Copies size bytes from an IOBuffer to accelerator memory
      * \param dst Pointer to accelerator memory
      * \param buffer Reference to the source IOBuffer
@@ -212,6 +258,14 @@ public:
     virtual bool hasIntegratedMemory() const = 0;
     virtual bool hasUnifiedAddressing() const = 0;
 
+    /**
+     * Tells if the accelerator of this mode can directly copy data from the
+     * accelerator memory of another mode
+     * \param mode Execution mode owning the source accelerator memory
+     * \return A boolean that tells if copyAcceleratorPeer can be used
+     */
+    virtual bool hasPeerAccess(Mode &mode) const = 0;
+
 #ifdef USE_OPENCL
     virtual gmacError_t acquire(hostptr_t addr) = 0;
     virtual gmacError_t release(hostptr_t addr) = 0;
@@ -219,6 +273,12 @@ public:
 
     virtual memory::ObjectMap &getAddressSpace() = 0;
     virtual const memory::ObjectMap &getAddressSpace() const = 0;
+
+    /**
+     * Gets the slot where the live counters of the mode are published
+     * \return Slot of the mode, or NULL if the monitor is disabled
+     */
+    util::MonitorMode *monitor() const;
 };
 
 }}
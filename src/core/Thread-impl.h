@@ -83,6 +83,13 @@ Thread::setLastError(gmacError_t error)
     TLS::getCurrentThread().lastError_ = error;
 }
 
+inline
+memory::TranslationCache &
+Thread::getTranslationCache()
+{
+    return TLS::getCurrentThread().translationCache_;
+}
+
 }}
 
 #endif
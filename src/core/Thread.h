@@ -34,6 +34,7 @@ WITH THE SOFTWARE.  */
 #ifndef GMAC_CORE_THREAD_H_
 #define GMAC_CORE_THREAD_H_
 
+#include "memory/TranslationCache.h"
 #include "util/Atomics.h"
 #include "util/Private.h"
 
@@ -53,9 +54,10 @@ public:
     static void Init();
 };
 
-class Thread {
+class GMAC_LOCAL Thread {
 private:
     gmacError_t lastError_;
+    memory::TranslationCache translationCache_;
 #ifdef DEBUG
     THREAD_T debugTID_;
 
@@ -69,6 +71,9 @@ public:
     // Error management
     static gmacError_t &getLastError();
     static void setLastError(gmacError_t error);
+
+    // Address translation
+    static memory::TranslationCache &getTranslationCache();
 #ifdef DEBUG
     static THREAD_T getDebugTID();
 #endif
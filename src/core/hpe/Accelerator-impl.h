@@ -12,6 +12,30 @@ Accelerator::load() const
     return load_;
 }
 
+inline unsigned
+Accelerator::pending() const
+{
+    return unsigned(pending_);
+}
+
+inline void
+Accelerator::launched()
+{
+    AtomicInc(pending_);
+}
+
+inline void
+Accelerator::completed(unsigned count)
+{
+    for(unsigned i = 0; i < count; i++) AtomicDec(pending_);
+}
+
+inline RegistrationCache &
+Accelerator::getRegistrations()
+{
+    return registrations_;
+}
+
 inline unsigned
 Accelerator::id() const
 {
@@ -1,12 +1,14 @@
+#include "core/hpe/Mode.h"
 #include "trace/Tracer.h"
 #include "util/Logger.h"
+#include "util/Monitor.h"
 
 #include "Accelerator.h"
 
 namespace __impl { namespace core { namespace hpe {
 
 Accelerator::Accelerator(int n) :
-    id_(n), load_(0)
+    id_(n), load_(0), pending_(0), registrations_(*this)
 {
 }
 
@@ -19,6 +21,8 @@ void Accelerator::registerMode(Mode &mode)
     TRACE(LOCAL,"Registering Execution Mode %p to Accelerator", &mode);
     trace::EnterCurrentFunction();
     load_++;
+    publish();
+    if(mode.monitor() != NULL) mode.monitor()->accelerator_ = id_;
     trace::ExitCurrentFunction();
 }
 
@@ -27,7 +31,46 @@ void Accelerator::unregisterMode(Mode &mode)
     TRACE(LOCAL,"Unregistering Execution Mode %p", &mode);
     trace::EnterCurrentFunction();
     load_--;
+    publish();
     trace::ExitCurrentFunction();
 }
 
+void Accelerator::publish() const
+{
+    util::MonitorAccelerator *slot = util::Monitor::getAccelerator(id_);
+    if(slot == NULL) return;
+    size_t free, total;
+    getMemInfo(free, total);
+    slot->present_ = 1;
+    slot->modes_ = load_;
+    util::Monitor::set(slot->memoryTotal_, total);
+    util::Monitor::set(slot->memoryUsed_, total - free);
+}
+
+gmacError_t Accelerator::copyAcceleratorPeer(accptr_t dst, Accelerator &srcAcc, const accptr_t src, size_t size, stream_t stream)
+{
+    if(&srcAcc == this) return copyAccelerator(dst, src, size, stream);
+    return gmacErrorFeatureNotSupported;
+}
+
+gmacError_t Accelerator::pinMemory(hostptr_t addr, size_t size, void *&handle)
+{
+    return gmacErrorFeatureNotSupported;
+}
+
+void Accelerator::unpinMemory(hostptr_t addr, size_t size, void *handle)
+{
+}
+
+gmacError_t Accelerator::scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                              unsigned count, size_t size, Mode &mode, stream_t stream)
+{
+    gmacError_t ret = gmacSuccess;
+    for(unsigned n = 0; n < count; n++) {
+        ret = copyToAccelerator(acc + offsets[n], host + offsets[n], size, mode);
+        if(ret != gmacSuccess) break;
+    }
+    return ret;
+}
+
 }}}
@@ -43,6 +43,8 @@
 #include "config/common.h"
 #include "core/AllocationMap.h"
 #include "core/IOBuffer.h"
+#include "core/hpe/RegistrationCache.h"
+#include "util/Atomics.h"
 #include "util/Lock.h"
 
 
@@ -78,12 +80,18 @@ protected:
     /** Value that represents the load of the accelerator */
     unsigned load_;
 
+    /** Number of kernels launched on the accelerator that have not been waited for */
+    Atomic pending_;
+
     /** Map of allocations in the device */
     gmac::core::AllocationMap allocations_;
 
     /** Information of the accelerator */
     GmacAcceleratorInfo accInfo_;
 
+    /** Host memory ranges pinned in the accelerator */
+    RegistrationCache registrations_;
+
     /**
      * Registers a mode to be run on the accelerator. The mode must not be
      * already registered in the accelerator
@@ -98,6 +106,11 @@ protected:
      */
     TESTABLE void unregisterMode(Mode &mode);
 
+    /**
+     * Publishes the load and memory usage of the accelerator in the monitor
+     */
+    void publish() const;
+
 public:
     /**
      * Constructs an Accelerator and initializes its information fields
@@ -138,6 +151,24 @@ public:
      */
     virtual unsigned load() const;
 
+    /**
+     * Returns the number of kernels launched on the accelerator that have not
+     * been waited for yet
+     * \return Number of outstanding kernels
+     */
+    unsigned pending() const;
+
+    /**
+     * Notifies that a kernel has been launched on the accelerator
+     */
+    void launched();
+
+    /**
+     * Notifies that kernels launched on the accelerator have finished
+     * \param count Number of kernels that have finished
+     */
+    void completed(unsigned count);
+
     /**
      * Queries the accelerator address of the given host pointer
      * \param acc Reference to a pointer to store the address of the allocated
@@ -206,6 +237,60 @@ public:
      */
     virtual gmacError_t copyAccelerator(accptr_t dst, const accptr_t src, size_t size, stream_t stream) = 0;
 
+    /**
+     * Copies data from the memory of another accelerator to the memory of this
+     * accelerator. The default implementation only supports copies within the
+     * same accelerator
+     * \param dst Destination pointer to accelerator memory
+     * \param srcAcc Accelerator where the source memory is located
+     * \param src Source pointer to accelerator memory
+     * \param size Number of bytes to be copied
+     * \param stream Stream to be used for the transfer
+     * \return Error code
+     */
+    virtual gmacError_t copyAcceleratorPeer(accptr_t dst, Accelerator &srcAcc, const accptr_t src, size_t size, stream_t stream);
+
+    /**
+     * Copies several ranges of host memory to the same ranges of accelerator
+     * memory. The default implementation issues one copy per range;
+     * accelerators able to scatter the data on the device should use a
+     * single transfer
+     * \param acc Base pointer to accelerator memory the offsets refer to
+     * \param host Base pointer to host memory the offsets refer to
+     * \param offsets Offsets (in bytes) of the ranges
+     * \param count Number of ranges
+     * \param size Size (in bytes) of each range
+     * \param mode Mode that receives the data
+     * \param stream Stream to be used for the transfer
+     * \return Error code
+     */
+    virtual gmacError_t scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                             unsigned count, size_t size, Mode &mode, stream_t stream);
+
+    /**
+     * Pins a range of host memory, so it can be used in transfers to and from
+     * the accelerator. The default implementation does not support pinning
+     * \param addr Starting (page-aligned) address of the memory
+     * \param size Size (in bytes) of the memory
+     * \param handle Reference to store the handle needed to use and unpin the memory
+     * \return Error code
+     */
+    virtual gmacError_t pinMemory(hostptr_t addr, size_t size, void *&handle);
+
+    /**
+     * Unpins a range of host memory previously pinned by pinMemory
+     * \param addr Starting address of the memory
+     * \param size Size (in bytes) of the memory
+     * \param handle Handle returned by pinMemory
+     */
+    virtual void unpinMemory(hostptr_t addr, size_t size, void *handle);
+
+    /**
+     * Gets the cache of host memory ranges pinned in the accelerator
+     * \return Registration cache of the accelerator
+     */
+    RegistrationCache &getRegistrations();
+
     /**
      * Asynchronously copy an I/O buffer to the accelerator
      * \param acc Accelerator memory address where to copy the data to
@@ -285,6 +370,14 @@ public:
     bool integrated() const;
 
     virtual bool hasUnifiedAddressing() const { return false; }
+
+    /**
+     * Tells if the accelerator can directly copy data from the memory of
+     * another accelerator
+     * \param acc Accelerator where the source memory is located
+     * \return A boolean that tells if copyAcceleratorPeer can be used
+     */
+    virtual bool hasPeerAccess(const Accelerator &acc) const { return &acc == this; }
 };
 
 }}}
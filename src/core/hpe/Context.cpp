@@ -1,5 +1,7 @@
 #include "memory/Manager.h"
 #include "trace/Tracer.h"
+#include "util/Monitor.h"
+#include "util/StagingCopy.h"
 
 #include "core/hpe/Accelerator.h"
 #include "core/hpe/Mode.h"
@@ -16,12 +18,23 @@ Context::Context(Mode &mode, stream_t streamLaunch, stream_t streamToAccelerator
     streamToHost_(streamToHost),
     streamAccelerator_(streamAccelerator),
     bufferWrite_(NULL),
-    bufferRead_(NULL)
+    bufferRead_(NULL),
+    writeInFlight_(0)
 {
 }
 
 Context::~Context()
 {
+    setWriteInFlight(0);
+}
+
+void
+Context::setWriteInFlight(size_t size)
+{
+    util::MonitorMode *monitor = mode_.monitor();
+    if(monitor != NULL && size != writeInFlight_)
+        util::Monitor::add(monitor->bytesInFlight_, int64_t(size) - int64_t(writeInFlight_));
+    writeInFlight_ = size;
 }
 
 void
@@ -34,6 +47,7 @@ gmacError_t Context::copyToAccelerator(accptr_t acc, const hostptr_t host, size_
     TRACE(LOCAL,"Transferring "FMT_SIZE" bytes from host %p to accelerator %p", size, host, acc.get());
     trace::EnterCurrentFunction();
     if(size == 0) return gmacSuccess; /* Fast path */
+    if(mode_.monitor() != NULL) util::Monitor::add(mode_.monitor()->bytesToAccelerator_, size);
     /* In case there is no page-locked memory available, use the slow path */
     if(bufferWrite_ == NULL) bufferWrite_ = &static_cast<IOBuffer &>(mode_.createIOBuffer(util::params::ParamBlockSize, GMAC_PROT_WRITE));
     if(bufferWrite_->async() == false) {
@@ -49,15 +63,17 @@ gmacError_t Context::copyToAccelerator(accptr_t acc, const hostptr_t host, size_
     while(size_t(offset) < size) {
         ret = bufferWrite_->wait(true);
         if(ret != gmacSuccess) break;
+        setWriteInFlight(0);
         ptroff_t len = ptroff_t(bufferWrite_->size());
         if((size - offset) < bufferWrite_->size()) len = ptroff_t(size - offset);
         trace::EnterCurrentFunction();
-        ::memcpy(bufferWrite_->addr(), host + offset, len);
+        util::StagingCopy::toStaging(bufferWrite_->addr(), host + offset, len);
         trace::ExitCurrentFunction();
         ASSERTION(size_t(len) <= util::params::ParamBlockSize);
         ret = acc_.copyToAcceleratorAsync(acc + offset, *bufferWrite_, 0, len, mode_, streamToAccelerator_);
         ASSERTION(ret == gmacSuccess);
         if(ret != gmacSuccess) break;
+        setWriteInFlight(len);
         offset += len;
     }
     trace::ExitCurrentFunction();
@@ -69,6 +85,7 @@ gmacError_t Context::copyToHost(hostptr_t host, const accptr_t acc, size_t size)
     TRACE(LOCAL,"Transferring "FMT_SIZE" bytes from accelerator %p to host %p", size, acc.get(), host);
     trace::EnterCurrentFunction();
     if(size == 0) return gmacSuccess;
+    if(mode_.monitor() != NULL) util::Monitor::add(mode_.monitor()->bytesToHost_, size);
     if(bufferRead_ == NULL) bufferRead_ = &static_cast<IOBuffer &>(mode_.createIOBuffer(util::params::ParamBlockSize, GMAC_PROT_READ));
     if(bufferRead_->async() == false) {
         mode_.destroyIOBuffer(*bufferRead_);
@@ -91,7 +108,7 @@ gmacError_t Context::copyToHost(hostptr_t host, const accptr_t acc, size_t size)
         ret = bufferRead_->wait(true);
         if(ret != gmacSuccess) break;
         trace::EnterCurrentFunction();
-        ::memcpy((uint8_t *)host + offset, bufferRead_->addr(), len);
+        util::StagingCopy::fromStaging((uint8_t *)host + offset, bufferRead_->addr(), len);
         trace::ExitCurrentFunction();
         offset += len;
     }
@@ -70,6 +70,16 @@ protected:
     IOBuffer *bufferWrite_;
     IOBuffer *bufferRead_;
 
+    /** Bytes of the last host-to-acc transfer that might be still in progress */
+    size_t writeInFlight_;
+
+    /**
+     * Publishes the bytes of host-to-acc transfers in progress in the monitor
+     *
+     * \param size Bytes of the transfer in progress, 0 once it has finished
+     */
+    void setWriteInFlight(size_t size);
+
     /**
      * Constructs a context for the calling thread on the given mode
      *
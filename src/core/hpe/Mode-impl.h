@@ -172,6 +172,9 @@ Mode::wait(core::hpe::KernelLaunch &launch)
     // TODO: use an event for this
     gmacError_t ret = acc_->syncStream(streamLaunch_);
     switchOut();
+    acc_->completed(pending_);
+    pending_ = 0;
+    waits_++;
 
     return ret;
 }
@@ -182,10 +185,40 @@ Mode::wait()
     switchIn();
     gmacError_t ret = acc_->syncStream(streamLaunch_);
     switchOut();
+    acc_->completed(pending_);
+    pending_ = 0;
+    waits_++;
 
     return ret;
 }
 
+inline void
+Mode::launched()
+{
+    pending_++;
+    acc_->launched();
+}
+
+inline unsigned
+Mode::pending() const
+{
+    return pending_;
+}
+
+inline unsigned
+Mode::waits() const
+{
+    return waits_;
+}
+
+inline void
+Mode::completed(unsigned waits)
+{
+    if(waits != waits_ || pending_ == 0) return;
+    pending_--;
+    acc_->completed(1);
+}
+
 inline stream_t
 Mode::eventStream()
 {
@@ -204,6 +237,13 @@ Mode::hasUnifiedAddressing() const
     return acc_->hasUnifiedAddressing();
 }
 
+inline bool
+Mode::hasPeerAccess(core::Mode &mode) const
+{
+    Mode &peer = dynamic_cast<Mode &>(mode);
+    return acc_->hasPeerAccess(peer.getAccelerator());
+}
+
 
 }}}
 
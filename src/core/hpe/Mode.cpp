@@ -21,7 +21,9 @@ Mode::Mode(Process &proc, Accelerator &acc, AddressSpace &aSpace) :
 #ifdef USE_VM
     bitmap_(*this),
 #endif
-    contextMap_(*this)
+    contextMap_(*this),
+    pending_(0),
+    waits_(0)
 {
 }
 
@@ -108,6 +110,21 @@ Mode::copyToAccelerator(accptr_t acc, const hostptr_t host, size_t count)
     return ret;
 }
 
+gmacError_t
+Mode::scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                           unsigned count, size_t size)
+{
+    TRACE(LOCAL,"Scatter %u ranges of "FMT_SIZE" bytes to accelerator %p", count, size, acc.get());
+
+    switchIn();
+    // Previous asynchronous updates might overlap with the ranges
+    gmacError_t ret = acc_->syncStream(streamToAccelerator_);
+    if(ret == gmacSuccess) ret = acc_->scatterToAccelerator(acc, host, offsets, count, size, *this, streamToAccelerator_);
+    switchOut();
+
+    return ret;
+}
+
 gmacError_t
 Mode::copyToHost(hostptr_t host, const accptr_t acc, size_t count)
 {
@@ -129,6 +146,21 @@ Mode::copyAccelerator(accptr_t dst, const accptr_t src, size_t count)
     return ret;
 }
 
+gmacError_t
+Mode::copyAcceleratorPeer(accptr_t dst, core::Mode &srcMode, const accptr_t src, size_t count)
+{
+    TRACE(LOCAL,"Copy %p from accelerator to accelerator %p ("FMT_SIZE" bytes)", src.get(), dst.get(), count);
+    Mode &peer = dynamic_cast<Mode &>(srcMode);
+    // Transfers to the source might still be in flight in the peer streams
+    gmacError_t ret = peer.getAccelerator().syncStream(peer.streamToAccelerator_);
+    if(ret != gmacSuccess) return ret;
+    switchIn();
+    ret = acc_->copyAcceleratorPeer(dst, peer.getAccelerator(), src, count, streamToHost_);
+    if(ret == gmacSuccess) ret = acc_->syncStream(streamToHost_);
+    switchOut();
+    return ret;
+}
+
 gmacError_t
 Mode::memset(accptr_t addr, int c, size_t count)
 {
@@ -153,7 +185,7 @@ Mode::moveTo(Accelerator &acc)
     size_t free;
     size_t total;
     size_t needed = aSpace_->memorySize();
-    acc_->getMemInfo(free, total);
+    acc.getMemInfo(free, total);
 
     if (needed > free) {
         switchOut();
@@ -167,6 +199,10 @@ Mode::moveTo(Accelerator &acc)
     contextMap_.clean();
 
     TRACE(LOCAL,"Registering mode in new accelerator");
+    // Kernels cannot be outstanding once objects have been unmapped
+    acc_->completed(pending_);
+    pending_ = 0;
+    waits_++;
     acc_->migrateMode(*this, acc);
 
     TRACE(LOCAL,"Reallocating objects");
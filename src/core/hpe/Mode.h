@@ -100,6 +100,11 @@ protected:
 
     ContextMap contextMap_;
 
+    /** Number of kernels launched by the mode that have not been waited for */
+    unsigned pending_;
+    /** Number of times the mode has waited for all its kernels */
+    unsigned waits_;
+
     typedef std::map<gmac_kernel_id_t, Kernel *> KernelMap;
     KernelMap kernels_;
 
@@ -181,6 +186,19 @@ public:
      */
     TESTABLE gmacError_t copyToAccelerator(accptr_t acc, const hostptr_t host, size_t count);
 
+    /**
+     * Copies several ranges of system memory to the same ranges of
+     * accelerator memory
+     * \param acc Base accelerator pointer the offsets refer to
+     * \param host Base host pointer the offsets refer to
+     * \param offsets Offsets (in bytes) of the ranges
+     * \param count Number of ranges
+     * \param size Size (in bytes) of each range
+     * \return Error code
+     */
+    gmacError_t scatterToAccelerator(accptr_t acc, const hostptr_t host, const size_t *offsets,
+                                     unsigned count, size_t size);
+
     /**
      * Copies data from accelerator memory to system memory
      * \param host Destination host pointer
@@ -198,6 +216,15 @@ public:
      */
     TESTABLE gmacError_t copyAccelerator(accptr_t dst, const accptr_t src, size_t count);
 
+    /** Copies data from the accelerator memory of another execution mode
+     * \param dst Destination accelerator memory
+     * \param srcMode Execution mode owning the source accelerator memory
+     * \param src Source accelerator memory
+     * \param count Number of bytes to be copied
+     * \return Error code
+     */
+    gmacError_t copyAcceleratorPeer(accptr_t dst, core::Mode &srcMode, const accptr_t src, size_t count);
+
     /**
      * Sets the contents of accelerator memory
      * \param addr Pointer to the accelerator memory to be set
@@ -235,6 +262,32 @@ public:
      */
     gmacError_t wait();
 
+    /**
+     * Notifies that a kernel has been launched by the mode
+     */
+    void launched();
+
+    /**
+     * Returns the number of kernels launched by the mode that have not been
+     * waited for
+     * \return Number of outstanding kernels
+     */
+    unsigned pending() const;
+
+    /**
+     * Returns the number of times the mode has waited for all its kernels
+     * \return Number of waits
+     */
+    unsigned waits() const;
+
+    /**
+     * Notifies that a kernel launched by the mode has finished. Kernels
+     * launched before the mode last waited for all its kernels are ignored,
+     * because they are no longer outstanding
+     * \param waits Number of waits when the kernel was launched
+     */
+    void completed(unsigned waits);
+
     /**
      * Destroys an IOBuffer
      * \param buffer Pointer to the buffer to be destroyed
@@ -320,6 +373,7 @@ public:
      */
     bool hasIntegratedMemory() const;
     bool hasUnifiedAddressing() const;
+    bool hasPeerAccess(core::Mode &mode) const;
 
     memory::ObjectMap &getAddressSpace();
     const memory::ObjectMap &getAddressSpace() const;
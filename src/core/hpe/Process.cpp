@@ -10,6 +10,13 @@
 #include "memory/Manager.h"
 #include "memory/Object.h"
 #include "trace/Tracer.h"
+#include "util/Parameter.h"
+
+#if defined(__GNUC__)
+#include <strings.h>
+#elif defined(_MSC_VER)
+#define strcasecmp _stricmp
+#endif
 
 namespace __impl { namespace core { namespace hpe {
 
@@ -157,6 +164,12 @@ Mode *Process::createMode(int acc)
         ASSERTION(acc < int(accs_.size()));
         usedAcc = acc;
     }
+    else if (strcasecmp(util::params::ParamPlacement, "Balanced") == 0) {
+        // Global objects are allocated in every new mode
+        float cost;
+        usedAcc = selectAccelerator(global_.memorySize(), NULL, cost);
+        MESSAGE("Placing new execution mode on Acc#%u (cost %f)", usedAcc, cost);
+    }
     else {
         // Bind the new Context to the accelerator with less contexts
         // attached to it
@@ -248,6 +261,77 @@ gmacError_t Process::migrate(int acc)
     return ret;
 }
 
+float Process::placementCost(Accelerator &acc, size_t footprint, const Mode *mode, bool &fits) const
+{
+    size_t free, total;
+    acc.getMemInfo(free, total);
+    unsigned load = acc.load();
+    unsigned pending = acc.pending();
+
+    // Evaluate the accelerator currently used by the mode as if the mode was
+    // not attached to it
+    if (mode != NULL && &mode->getAccelerator() == &acc) {
+        if (load > 0) load--;
+        pending = (pending > mode->pending())? pending - mode->pending(): 0;
+        free = (free + footprint < total)? free + footprint: total;
+    }
+
+    fits = (footprint <= free);
+    float used = 1.0f;
+    if (fits && total > 0) used = 1.0f - float(free - footprint) / float(total);
+
+    return float(load) +
+           util::params::ParamPlacementWorkWeight * float(pending) +
+           util::params::ParamPlacementMemoryWeight * used;
+}
+
+unsigned Process::selectAccelerator(size_t footprint, const Mode *mode, float &cost) const
+{
+    unsigned ret = 0;
+    bool retFits = false;
+    cost = 0.0f;
+    for (unsigned i = 0; i < accs_.size(); i++) {
+        bool fits;
+        float c = placementCost(*accs_[i], footprint, mode, fits);
+        TRACE(LOCAL, "Acc#%u placement cost %f (fits: %d)", i, c, fits);
+        // Accelerators where the objects fit are always preferred
+        if (i == 0 || (fits && !retFits) || (fits == retFits && c < cost)) {
+            ret = i;
+            retFits = fits;
+            cost = c;
+        }
+    }
+    return ret;
+}
+
+gmacError_t Process::rebalance()
+{
+    if (util::params::ParamRebalance == false || accs_.size() < 2) return gmacSuccess;
+    if (Thread::hasCurrentMode() == false) return gmacSuccess;
+    Mode &mode = Thread::getCurrentMode();
+    // Only idle modes are moved
+    if (mode.pending() > 0) return gmacSuccess;
+
+    size_t footprint = mode.getAddressSpace().memorySize();
+    unsigned current = mode.getAccelerator().id();
+    bool fits;
+    float best;
+
+    lockRead();
+    float cost = placementCost(mode.getAccelerator(), footprint, &mode, fits);
+    unsigned acc = selectAccelerator(footprint, &mode, best);
+    unlock();
+
+    if (&mode.getAccelerator() == accs_[acc]) return gmacSuccess;
+    if (cost - best <= util::params::ParamRebalanceThreshold) return gmacSuccess;
+
+    MESSAGE("Rebalancing execution mode %p: Acc#%u (cost %f) -> Acc#%u (cost %f), "FMT_SIZE" bytes",
+            &mode, current, cost, accs_[acc]->id(), best, footprint);
+    gmacError_t ret = migrate(int(acc));
+    if (ret != gmacSuccess) MESSAGE("Rebalancing execution mode %p failed: %d", &mode, ret);
+    return ret;
+}
+
 void Process::addAccelerator(Accelerator &acc)
 {
     accs_.push_back(&acc);
@@ -304,6 +388,8 @@ void Process::copy(THREAD_T id)
 
 core::Mode *Process::owner(const hostptr_t addr, size_t size)
 {
+    // Memory not allocated by GMAC is discarded without locking the maps
+    if(memory::ObjectMap::mayContain(addr, size) == false) return NULL;
     // We consider global objects for ownership,
     // since it contains distributed objects not found in shared_
     memory::Object *object = shared_.getObject(addr, size);
@@ -216,6 +216,43 @@ public:
      */
     gmacError_t migrate(int acc);
 
+    /**
+     * Computes the cost of placing an execution mode on an accelerator. The
+     * cost considers the modes already attached to the accelerator, their
+     * outstanding kernels and the accelerator memory left after allocating
+     * the objects of the mode
+     *
+     * \param acc Accelerator to be evaluated
+     * \param footprint Size (in bytes) of the objects used by the mode
+     * \param mode Execution mode being placed, if it is already attached to
+     * an accelerator. Its own load is not accounted
+     * \param fits Reference to a variable that tells if the objects of the
+     * mode fit in the accelerator memory
+     * \return Placement cost. Lower is better
+     */
+    float placementCost(Accelerator &acc, size_t footprint, const Mode *mode, bool &fits) const;
+
+    /**
+     * Selects the accelerator with the lowest placement cost. Accelerators
+     * without enough free memory are only chosen if no other can be used
+     *
+     * \param footprint Size (in bytes) of the objects used by the mode
+     * \param mode Execution mode being placed, or NULL for new modes
+     * \param cost Reference to a variable to store the cost of the selected
+     * accelerator
+     * \return Index of the selected accelerator
+     */
+    unsigned selectAccelerator(size_t footprint, const Mode *mode, float &cost) const;
+
+    /**
+     * Migrates the execution mode of the calling thread to another accelerator
+     * if the mode is idle and its placement cost is reduced by more than
+     * GMAC_REBALANCE_THRESHOLD. Does nothing unless GMAC_REBALANCE is set
+     *
+     * \return Error code
+     */
+    gmacError_t rebalance();
+
     /**
      * Adds an accelerator to the process so it can be used by the threads of the
      * process
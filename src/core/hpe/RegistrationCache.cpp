@@ -0,0 +1,207 @@
+#if defined(POSIX)
+#include <unistd.h>
+#endif
+
+#include "core/hpe/Accelerator.h"
+#include "trace/Tracer.h"
+#include "util/Logger.h"
+#include "util/Parameter.h"
+
+#include "RegistrationCache.h"
+
+namespace __impl { namespace core { namespace hpe {
+
+static size_t pageSize()
+{
+#if defined(POSIX)
+    static size_t size = size_t(sysconf(_SC_PAGESIZE));
+    return size;
+#else
+    return 4096;
+#endif
+}
+
+static hostptr_t pageBase(hostptr_t addr)
+{
+    return hostptr_t(long_t(addr) & ~long_t(pageSize() - 1));
+}
+
+static hostptr_t pageEnd(hostptr_t addr)
+{
+    return pageBase(addr + pageSize() - 1);
+}
+
+RegistrationCache::RegistrationCache(Accelerator &acc) :
+    gmac::util::Lock("RegistrationCache"),
+    acc_(acc),
+    size_(0)
+{
+}
+
+RegistrationCache::~RegistrationCache()
+{
+    clear();
+}
+
+RegistrationCache::Entry *RegistrationCache::find(hostptr_t addr, size_t size) const
+{
+    Map::const_iterator i = map_.upper_bound(addr);
+    if(i == map_.end()) return NULL;
+    Entry *entry = i->second;
+    if(entry->addr_ > addr || addr + size > i->first) return NULL;
+    // Ranges unregistered by the user are not handed out anymore
+    if(entry->dead_ == true) return NULL;
+    return entry;
+}
+
+RegistrationCache::Entry *RegistrationCache::pin(hostptr_t addr, size_t size, bool user)
+{
+    hostptr_t end = addr + size;
+    Map::iterator i = map_.upper_bound(addr);
+    while(i != map_.end() && i->second->addr_ < end) {
+        Entry *entry = i->second;
+        ++i;
+        // Overlapping ranges cannot be pinned twice
+        if(entry->users_ > 0 || entry->user_ == true) return NULL;
+        unpin(entry);
+    }
+    if(user == false && evict(size) == false) return NULL;
+
+    void *handle = NULL;
+    gmacError_t ret = acc_.pinMemory(addr, size, handle);
+    if(ret != gmacSuccess) {
+        TRACE(LOCAL, "Unable to pin %p ("FMT_SIZE" bytes): %d", addr, size, ret);
+        return NULL;
+    }
+    TRACE(LOCAL, "Pinned %p ("FMT_SIZE" bytes)", addr, size);
+
+    Entry *entry = new Entry();
+    entry->addr_ = addr;
+    entry->size_ = size;
+    entry->handle_ = handle;
+    entry->users_ = 0;
+    entry->user_ = user;
+    entry->dead_ = false;
+    if(user == false) {
+        entry->lru_ = lru_.insert(lru_.end(), entry);
+        size_ += size;
+    }
+    map_.insert(Map::value_type(end, entry));
+    return entry;
+}
+
+void RegistrationCache::unpin(Entry *entry)
+{
+    ASSERTION(entry->users_ == 0);
+    TRACE(LOCAL, "Unpinning %p ("FMT_SIZE" bytes)", entry->addr_, entry->size_);
+    acc_.unpinMemory(entry->addr_, entry->size_, entry->handle_);
+    if(entry->user_ == false) {
+        lru_.erase(entry->lru_);
+        size_ -= entry->size_;
+    }
+    map_.erase(entry->addr_ + entry->size_);
+    delete entry;
+}
+
+bool RegistrationCache::evict(size_t size)
+{
+    if(size > util::params::ParamPinCacheSize) return false;
+    while(size_ + size > util::params::ParamPinCacheSize && lru_.empty() == false)
+        unpin(lru_.front());
+    return size_ + size <= util::params::ParamPinCacheSize;
+}
+
+bool RegistrationCache::acquire(hostptr_t addr, size_t size)
+{
+    void *handle;
+    size_t offset;
+    return acquire(addr, size, handle, offset);
+}
+
+bool RegistrationCache::acquire(hostptr_t addr, size_t size, void *&handle, size_t &offset)
+{
+    lock();
+    Entry *entry = find(addr, size);
+    if(entry == NULL && util::params::ParamPinThreshold > 0 &&
+       size >= util::params::ParamPinThreshold) {
+        hostptr_t start = pageBase(addr);
+        entry = pin(start, pageEnd(addr + size) - start, false);
+    }
+    if(entry == NULL) {
+        unlock();
+        return false;
+    }
+    if(entry->users_ == 0 && entry->user_ == false) {
+        // Most recently used ranges are moved to the end of the list
+        // when they are released
+        lru_.erase(entry->lru_);
+    }
+    entry->users_++;
+    handle = entry->handle_;
+    offset = size_t(addr - entry->addr_);
+    unlock();
+    return true;
+}
+
+void RegistrationCache::release(hostptr_t addr)
+{
+    lock();
+    Map::iterator i = map_.upper_bound(addr);
+    ASSERTION(i != map_.end() && i->second->addr_ <= addr);
+    Entry *entry = i->second;
+    ASSERTION(entry->users_ > 0);
+    entry->users_--;
+    if(entry->users_ == 0) {
+        if(entry->dead_ == true) unpin(entry);
+        else if(entry->user_ == false) entry->lru_ = lru_.insert(lru_.end(), entry);
+    }
+    unlock();
+}
+
+gmacError_t RegistrationCache::registerRange(hostptr_t addr, size_t size)
+{
+    if(size == 0) return gmacErrorInvalidValue;
+    gmacError_t ret = gmacSuccess;
+    lock();
+    Entry *entry = find(addr, size);
+    if(entry != NULL && entry->user_ == false) {
+        // The range was pinned on the fly, so it only needs to be kept
+        if(entry->users_ == 0) lru_.erase(entry->lru_);
+        size_ -= entry->size_;
+        entry->user_ = true;
+    }
+    else if(entry == NULL) {
+        hostptr_t start = pageBase(addr);
+        entry = pin(start, pageEnd(addr + size) - start, true);
+        if(entry == NULL) ret = gmacErrorMemoryAllocation;
+    }
+    unlock();
+    return ret;
+}
+
+gmacError_t RegistrationCache::unregisterRange(hostptr_t addr)
+{
+    gmacError_t ret = gmacSuccess;
+    lock();
+    Entry *entry = find(addr, 1);
+    if(entry == NULL || entry->user_ == false) ret = gmacErrorInvalidValue;
+    else if(entry->users_ > 0) entry->dead_ = true;
+    else unpin(entry);
+    unlock();
+    return ret;
+}
+
+void RegistrationCache::clear()
+{
+    lock();
+    while(map_.empty() == false) {
+        Entry *entry = map_.begin()->second;
+        // Transfers are over by the time the accelerator is destroyed
+        if(entry->users_ > 0 && entry->user_ == false) entry->lru_ = lru_.insert(lru_.end(), entry);
+        entry->users_ = 0;
+        unpin(entry);
+    }
+    unlock();
+}
+
+}}}
@@ -0,0 +1,179 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_CORE_HPE_REGISTRATIONCACHE_H_
+#define GMAC_CORE_HPE_REGISTRATIONCACHE_H_
+
+#include <list>
+#include <map>
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "util/Lock.h"
+
+namespace __impl { namespace core { namespace hpe {
+
+class Accelerator;
+
+/**
+ * Cache of host memory ranges registered (pinned) in an accelerator, so
+ * transfers can use user memory directly instead of staging I/O buffers.
+ * Ranges registered by the user stay pinned until they are unregistered;
+ * ranges pinned on the fly are unpinned in LRU order when the cache grows
+ * over its size limit
+ */
+class GMAC_LOCAL RegistrationCache : protected gmac::util::Lock {
+protected:
+    /** Pinned host memory range */
+    struct Entry {
+        /** Starting (page-aligned) address of the range */
+        hostptr_t addr_;
+        /** Size (in bytes) of the range */
+        size_t size_;
+        /** Handle returned by the accelerator when the range was pinned */
+        void *handle_;
+        /** Number of transfers currently using the range */
+        unsigned users_;
+        /** Tells whether the range has been registered by the user */
+        bool user_;
+        /** Tells whether the range must be unpinned once it is idle */
+        bool dead_;
+        /** Position in the LRU list when the range is idle */
+        std::list<Entry *>::iterator lru_;
+    };
+
+    // Ranges are indexed by their end address, so upper_bound finds the
+    // range containing a given address
+    typedef std::map<hostptr_t, Entry *> Map;
+
+    /** Accelerator the ranges are pinned in */
+    Accelerator &acc_;
+    /** Pinned ranges */
+    Map map_;
+    /** Idle ranges pinned on the fly, the least recently used first */
+    std::list<Entry *> lru_;
+    /** Bytes pinned on the fly */
+    size_t size_;
+
+    /**
+     * Looks up the range containing the given memory
+     * \param addr Starting address of the memory
+     * \param size Size (in bytes) of the memory
+     * \return Range containing the memory, or NULL if not found
+     */
+    Entry *find(hostptr_t addr, size_t size) const;
+
+    /**
+     * Pins a new range in the accelerator. Idle ranges overlapping the new
+     * one are unpinned first
+     * \param addr Starting (page-aligned) address of the range
+     * \param size Size (in bytes) of the range
+     * \param user Tells whether the range is registered by the user
+     * \return New range, or NULL if it cannot be pinned
+     */
+    Entry *pin(hostptr_t addr, size_t size, bool user);
+
+    /**
+     * Unpins a range and removes it from the cache
+     * \param entry Range to be unpinned
+     */
+    void unpin(Entry *entry);
+
+    /**
+     * Unpins idle ranges pinned on the fly until the given number of bytes
+     * fit in the cache
+     * \param size Bytes that need to be pinned
+     * \return True if the bytes fit in the cache
+     */
+    bool evict(size_t size);
+
+public:
+    /**
+     * Creates an empty cache
+     * \param acc Accelerator the ranges are pinned in
+     */
+    RegistrationCache(Accelerator &acc);
+
+    /** Default destructor */
+    ~RegistrationCache();
+
+    /**
+     * Gets a pinned range containing the given memory for a transfer. The
+     * memory is pinned on the fly if it is not registered and the transfer
+     * is large enough
+     * \param addr Starting address of the memory
+     * \param size Size (in bytes) of the memory
+     * \return True if the memory is pinned, false if the transfer must be staged
+     */
+    bool acquire(hostptr_t addr, size_t size);
+
+    /**
+     * Gets a pinned range containing the given memory for a transfer, as
+     * acquire(addr, size) does, together with the handle of the range
+     * \param addr Starting address of the memory
+     * \param size Size (in bytes) of the memory
+     * \param handle Handle returned by the accelerator when the range was pinned
+     * \param offset Offset (in bytes) of the memory within the range
+     * \return True if the memory is pinned, false if the transfer must be staged
+     */
+    bool acquire(hostptr_t addr, size_t size, void *&handle, size_t &offset);
+
+    /**
+     * Releases a range got by acquire
+     * \param addr Address within the range
+     */
+    void release(hostptr_t addr);
+
+    /**
+     * Registers a range of user memory, which stays pinned until it is
+     * unregistered
+     * \param addr Starting address of the memory
+     * \param size Size (in bytes) of the memory
+     * \return Error code
+     */
+    gmacError_t registerRange(hostptr_t addr, size_t size);
+
+    /**
+     * Unregisters a range of user memory
+     * \param addr Starting address of the memory
+     * \return Error code
+     */
+    gmacError_t unregisterRange(hostptr_t addr);
+
+    /** Unpins all the ranges in the cache */
+    void clear();
+};
+
+}}}
+
+#endif
@@ -60,6 +60,23 @@ using namespace __impl::memory;
 
 using __impl::util::params::ParamBlockSize;
 using __impl::util::params::ParamAutoSync;
+using __impl::util::params::ParamOversubscribe;
+using __impl::util::params::ParamSubBlockSize;
+
+/**
+ * Evicts the least recently used objects of an execution mode to host memory
+ * \param mode Execution mode whose objects are evicted
+ * \param size Accelerator memory (in bytes) to be released
+ * \param keep Objects that cannot be evicted
+ * \return Error code
+ */
+static gmacError_t
+evictObjects(Mode &mode, size_t size, const ListAddr &keep = AllAddresses)
+{
+    // Kernels might still be using the objects to be evicted
+    mode.wait();
+    return getManager().evictObjects(mode, size, keep);
+}
 
 GMAC_API unsigned APICALL
 gmacGetNumberOfAccelerators()
@@ -150,7 +167,7 @@ gmacMemoryMap(void *cpuPtr, size_t count, GmacProtection prot)
         enterGmac();
     gmac::trace::EnterCurrentFunction();
     // TODO Remove alignment constraints?
-    count = (int(count) < getpagesize())? getpagesize(): count;
+    count = (count < size_t(getpagesize()))? getpagesize(): count;
     ret = getManager().map(cpuPtr, count, prot);
     gmac::trace::ExitCurrentFunction();
         exitGmac();
@@ -173,7 +190,7 @@ gmacMemoryUnmap(void *cpuPtr, size_t count)
         enterGmac();
     gmac::trace::EnterCurrentFunction();
     // TODO Remove alignment constraints?
-    count = (int(count) < getpagesize())? getpagesize(): count;
+    count = (count < size_t(getpagesize()))? getpagesize(): count;
     ret = getManager().unmap(cpuPtr, count);
     gmac::trace::ExitCurrentFunction();
         exitGmac();
@@ -184,6 +201,32 @@ gmacMemoryUnmap(void *cpuPtr, size_t count)
     return ret;
 }
 
+GMAC_API gmacError_t APICALL
+gmacHostRegister(void *cpuPtr, size_t count)
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    Accelerator &acc = Thread::getCurrentMode().getAccelerator();
+    gmacError_t ret = acc.getRegistrations().registerRange(hostptr_t(cpuPtr), count);
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacHostUnregister(void *cpuPtr)
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    Accelerator &acc = Thread::getCurrentMode().getAccelerator();
+    gmacError_t ret = acc.getRegistrations().unregisterRange(hostptr_t(cpuPtr));
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
 
 GMAC_API gmacError_t APICALL
 gmacMalloc(void **cpuPtr, size_t count)
@@ -200,8 +243,46 @@ gmacMalloc(void **cpuPtr, size_t count)
         *cpuPtr = getAllocator().alloc(Thread::getCurrentMode(), count, hostptr_t(RETURN_ADDRESS));
     }
     else {
-        count = (int(count) < getpagesize())? getpagesize(): count;
-        ret = getManager().alloc(Thread::getCurrentMode(), (hostptr_t *) cpuPtr, count);
+        count = (count < size_t(getpagesize()))? getpagesize(): count;
+        Mode &mode = Thread::getCurrentMode();
+        ret = getManager().alloc(mode, (hostptr_t *) cpuPtr, count);
+        // Make room in accelerator memory by evicting other objects
+        while(ret == gmacErrorMemoryAllocation && ParamOversubscribe == true &&
+              evictObjects(mode, count) == gmacSuccess) {
+            ret = getManager().alloc(mode, (hostptr_t *) cpuPtr, count);
+        }
+    }
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacMallocBlock(void **cpuPtr, size_t count, size_t blockSize)
+{
+    gmacError_t ret = gmacSuccess;
+    if (count == 0) {
+        *cpuPtr = NULL;
+        Thread::setLastError(ret);
+        return ret;
+    }
+    // Blocks must contain a power of two number of whole sub-blocks
+    if (blockSize != 0 && (blockSize % ParamSubBlockSize != 0 ||
+                           ((blockSize / ParamSubBlockSize) & (blockSize / ParamSubBlockSize - 1)) != 0)) {
+        ret = gmacErrorInvalidValue;
+        Thread::setLastError(ret);
+        return ret;
+    }
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    // Allocations with their own block size do not go through the allocator
+    count = (count < size_t(getpagesize()))? getpagesize(): count;
+    Mode &mode = Thread::getCurrentMode();
+    ret = getManager().alloc(mode, (hostptr_t *) cpuPtr, count, blockSize);
+    while(ret == gmacErrorMemoryAllocation && ParamOversubscribe == true &&
+          evictObjects(mode, count) == gmacSuccess) {
+        ret = getManager().alloc(mode, (hostptr_t *) cpuPtr, count, blockSize);
     }
     gmac::trace::ExitCurrentFunction();
     Thread::setLastError(ret);
@@ -249,6 +330,43 @@ gmacFree(void *cpuPtr)
     return ret;
 }
 
+GMAC_API gmacError_t APICALL
+gmacMapFile(void **cpuPtr, int fd, off_t offset, size_t count, GmacProtection prot)
+{
+    gmacError_t ret = gmacSuccess;
+    if (count == 0) {
+        *cpuPtr = NULL;
+        Thread::setLastError(ret);
+        return ret;
+    }
+    if (fd < 0 || offset < 0) {
+        ret = gmacErrorInvalidValue;
+        Thread::setLastError(ret);
+        return ret;
+    }
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    *cpuPtr = NULL;
+    ret = getManager().mapFile(Thread::getCurrentMode(), (hostptr_t *) cpuPtr, count, fd, offset, prot);
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacUnmapFile(void *cpuPtr)
+{
+    gmacError_t ret = gmacSuccess;
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    ret = getManager().unmapFile(Thread::getCurrentMode(), hostptr_t(cpuPtr));
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
 GMAC_API __gmac_accptr_t APICALL
 gmacPtr(const void *ptr)
 {
@@ -268,6 +386,19 @@ gmacLaunch(__impl::core::hpe::KernelLaunch &launch)
     Manager &manager = getManager();
     TRACE(GLOBAL, "Flush the memory used in the kernel");
     const std::list<__impl::memory::ObjectInfo> &objects = launch.getObjects();
+    if (ParamOversubscribe == true && objects.empty() == false) {
+        // Bring back the objects evicted from accelerator memory, evicting
+        // objects not used by the kernel if needed
+        ret = manager.useObjects(mode, objects);
+        while (ret == gmacErrorMemoryAllocation &&
+               evictObjects(mode, 1, objects) == gmacSuccess) {
+            ret = manager.useObjects(mode, objects);
+        }
+        if (ret != gmacSuccess) {
+            Thread::setLastError(ret);
+            return ret;
+        }
+    }
     // If the launch object does not contain objects, assume all the objects
     // in the mode are released
     ret = manager.releaseObjects(mode, objects);
@@ -275,6 +406,7 @@ gmacLaunch(__impl::core::hpe::KernelLaunch &launch)
 
     TRACE(GLOBAL, "Kernel Launch");
     ret = mode.execute(launch);
+    if(ret == gmacSuccess) mode.launched();
 
     if (ParamAutoSync == true) {
         TRACE(GLOBAL, "Waiting for Kernel to complete");
@@ -294,6 +426,8 @@ gmacLaunch(gmac_kernel_id_t k)
 {
     enterGmac();
     gmac::trace::EnterCurrentFunction();
+    // Idle modes might be moved before the launch object is created
+    getProcess().rebalance();
     __impl::core::hpe::Mode &mode = Thread::getCurrentMode();
     __impl::core::hpe::KernelLaunch *launch = NULL;
     gmacError_t ret = mode.launch(k, launch);
@@ -385,6 +519,68 @@ gmacMemcpy(void *dst, const void *src, size_t size)
     return ret;
 }
 
+GMAC_API gmacError_t APICALL
+gmacCheckpoint(const char *path, void **objs, size_t count)
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    gmacError_t ret = getManager().checkpoint(Thread::getCurrentMode(), path,
+                                              (hostptr_t *)objs, count);
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacCheckpointWait()
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    gmacError_t ret = getManager().checkpointWait();
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacRestore(const char *path, void **objs, size_t count)
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    gmacError_t ret = getManager().restore(Thread::getCurrentMode(), path,
+                                           (hostptr_t *)objs, count);
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacPrefetch(const void *ptr, size_t size, GmacPrefetchDestination dst)
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    gmacError_t ret = getManager().prefetch(Thread::getCurrentMode(), hostptr_t(ptr), size, dst);
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
+GMAC_API gmacError_t APICALL
+gmacMemAdvise(const void *ptr, size_t size, GmacMemAdvice advice)
+{
+    enterGmac();
+    gmac::trace::EnterCurrentFunction();
+    gmacError_t ret = getManager().memAdvise(Thread::getCurrentMode(), hostptr_t(ptr), size, advice);
+    gmac::trace::ExitCurrentFunction();
+    Thread::setLastError(ret);
+    exitGmac();
+    return ret;
+}
+
 GMAC_API gmacError_t APICALL
 gmacSetAddressSpace(unsigned aSpaceId)
 {
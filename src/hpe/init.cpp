@@ -16,6 +16,7 @@
 
 #include "util/Parameter.h"
 #include "util/Logger.h"
+#include "util/Monitor.h"
 
 #include "trace/Tracer.h"
 
@@ -48,7 +49,10 @@ void initGmac(void)
     __impl::memory::Handler::setEntry(enterGmac);
     __impl::memory::Handler::setExit(exitGmac);
 
-    isRunTimeThread_.set(&privateFalse);
+    setRunTimeThread(false);
+    // Counters must be published before any mode or accelerator exists
+    __impl::util::Monitor::init();
+
     // Process is a singleton class. The only allowed instance is Proc_
     TRACE(GLOBAL, "Initializing process");
     Process_ = new gmac::core::hpe::Process();
@@ -111,7 +115,7 @@ static void fini(void)
 static void InitThread(const bool &isRunTimeThread)
 {
     gmac::trace::StartThread("CPU");
-    isRunTimeThread_.set(&isRunTimeThread);
+    setRunTimeThread(isRunTimeThread);
     enterGmac();
     __impl::core::hpe::getProcess().initThread();
     gmac::trace::SetThreadState(__impl::trace::Running);
@@ -47,9 +47,9 @@ static void *gmac_pthread(void *arg)
 
     // This TLS variable is necessary before entering GMAC
     if (externCall == false) {
-        isRunTimeThread_.set(&privateTrue);
+        setRunTimeThread(true);
     } else {
-        isRunTimeThread_.set(&privateFalse);
+        setRunTimeThread(false);
     }
 
     enterGmac();
@@ -93,6 +93,19 @@ typedef enum {
     GMAC_PROT_READWRITE = GMAC_PROT_READ | GMAC_PROT_WRITE
 } GmacProtection;
 
+typedef enum {
+    GMAC_PREFETCH_HOST        = 0,
+    GMAC_PREFETCH_ACCELERATOR = 1
+} GmacPrefetchDestination;
+
+typedef enum {
+    GMAC_ADVICE_NONE                  = 0,
+    GMAC_ADVICE_READ_MOSTLY           = 1,
+    GMAC_ADVICE_ACCELERATOR_PREFERRED = 2,
+    GMAC_ADVICE_HOST_PREFERRED        = 3,
+    GMAC_ADVICE_STREAMING             = 4
+} GmacMemAdvice;
+
 typedef enum {
     GMAC_MAP_READ  = 0x1,
     GMAC_MAP_WRITE = 0x2
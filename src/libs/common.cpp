@@ -6,8 +6,13 @@
 #include "util/Logger.h"
 #include "util/Private.h"
 
+#if defined(__GNUC__) && !defined(__APPLE__)
+__thread bool inGmac_ GMAC_LOCAL = false;
+__thread bool isRunTimeThread_ GMAC_LOCAL = false;
+#else
 static __impl::util::Private<bool> inGmac_;
-__impl::util::Private<bool> isRunTimeThread_;
+static __impl::util::Private<bool> isRunTimeThread_;
+#endif
 
 static Atomic gmacInit__ = 0;
 static Atomic gmacCtor_ = 0;
@@ -17,16 +22,52 @@ static volatile bool gmacIsInitialized = false;
 const bool privateTrue = true;
 const bool privateFalse = false;
 
+#if defined(__GNUC__) && !defined(__APPLE__)
+static inline void setInGmac(bool value)
+{
+    inGmac_ = value;
+}
+
+static inline bool isRunTimeThread()
+{
+    return isRunTimeThread_;
+}
+#else
+static inline void setInGmac(bool value)
+{
+    inGmac_.set(value? &privateTrue: &privateFalse);
+}
+
+static inline bool isRunTimeThread()
+{
+    return *isRunTimeThread_.get();
+}
+
+void setRunTimeThread(bool runTime)
+{
+    isRunTimeThread_.set(runTime? &privateTrue: &privateFalse);
+}
+
+bool inGmac()
+{
+    bool *ret = inGmac_.get();
+    ASSERTION(ret != NULL);
+    return *ret;
+}
+#endif
+
 CONSTRUCTOR(init);
 static void init(void)
 {
     if(AtomicTestAndSet(gmacCtor_, 0, 1) == 1) return;
+#if !defined(__GNUC__) || defined(__APPLE__)
     /* Create GMAC enter lock and set GMAC as initialized */
     __impl::util::Private<bool>::init(inGmac_);
     __impl::util::Private<bool>::init(isRunTimeThread_);
+#endif
 
-    inGmac_.set(&privateFalse);
-    isRunTimeThread_.set(&privateFalse);
+    setInGmac(false);
+    setRunTimeThread(false);
 #ifdef POSIX
     threadInit();
 #endif
@@ -34,33 +75,32 @@ static void init(void)
 
 void enterGmac()
 {
-    if(AtomicTestAndSet(gmacInit__, 0, 1) == 0) {
-        inGmac_.set(&privateTrue);
-        initGmac();
-        gmacIsInitialized = true;
-    } else if (*isRunTimeThread_.get() == privateFalse) {
-        while (!gmacIsInitialized);
-        inGmac_.set(&privateTrue);
-    } else {
-        inGmac_.set(&privateTrue);
+    // Only read the flag once GMAC is initialized; the compare-and-swap is
+    // needed just to elect the thread that initializes GMAC
+    if(gmacIsInitialized == false) {
+        if(AtomicTestAndSet(gmacInit__, 0, 1) == 0) {
+            setInGmac(true);
+            initGmac();
+            gmacIsInitialized = true;
+        } else if (isRunTimeThread() == false) {
+            while (!gmacIsInitialized);
+        }
     }
+    setInGmac(true);
 }
 
 
 void enterGmacExclusive()
 {
-    if (AtomicTestAndSet(gmacInit__, 0, 1) == 0) initGmac();
-    inGmac_.set(&privateTrue);
+    if (gmacIsInitialized == false &&
+        AtomicTestAndSet(gmacInit__, 0, 1) == 0) {
+        initGmac();
+        gmacIsInitialized = true;
+    }
+    setInGmac(true);
 }
 
 void exitGmac()
 {
-    inGmac_.set(&privateFalse);
-}
-
-bool inGmac()
-{
-    bool *ret = inGmac_.get();
-    ASSERTION(ret != NULL);
-    return *ret;
+    setInGmac(false);
 }
@@ -53,9 +53,7 @@ namespace __impl {
     }
 }
 
-#include "util/Private.h"
-
-extern __impl::util::Private<bool> isRunTimeThread_;
+#include "memory/ObjectMap.h"
 
 extern const bool privateTrue;
 extern const bool privateFalse;
@@ -64,6 +62,37 @@ void initGmac() GMAC_LOCAL;
 void enterGmac() GMAC_LOCAL;
 void enterGmacExclusive() GMAC_LOCAL;
 void exitGmac() GMAC_LOCAL;
+
+#if defined(__GNUC__) && !defined(__APPLE__)
+// Compiler-level TLS, so interposed calls do not pay for pthread_getspecific
+extern __thread bool inGmac_ GMAC_LOCAL;
+extern __thread bool isRunTimeThread_ GMAC_LOCAL;
+
+inline bool inGmac()
+{
+    return inGmac_;
+}
+
+inline void setRunTimeThread(bool runTime)
+{
+    isRunTimeThread_ = runTime;
+}
+#else
 bool inGmac() GMAC_LOCAL;
+void setRunTimeThread(bool runTime) GMAC_LOCAL;
+#endif
+
+/**
+ * Tells if a memory range might have been allocated by GMAC. Interposed
+ * functions use this check to pass other memory straight to the system
+ * without entering GMAC
+ * \param addr Starting address of the memory range
+ * \param size Size (in bytes) of the memory range
+ * \return False if the memory range does not belong to GMAC
+ */
+inline bool isGmacAddress(const void *addr, size_t size)
+{
+    return __impl::memory::ObjectMap::mayContain(hostptr_t(addr), size);
+}
 
 #endif
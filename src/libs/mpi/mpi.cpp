@@ -51,6 +51,8 @@ int MPI_Sendrecv( void *sendbuf, int sendcount, MPI_Datatype sendtype,
 	if(inGmac() == 1) return __MPI_Sendrecv(sendbuf, sendcount, sendtype, dest,   sendtag,
                                                   recvbuf, recvcount, recvtype, source, recvtag, comm, status);
     if(__MPI_Sendrecv == NULL) mpiInit();
+    if(isGmacAddress(sendbuf, 0) == false && isGmacAddress(recvbuf, 0) == false)
+        return __MPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf, recvcount, recvtype, source, recvtag, comm, status);
 
     Process &proc = getProcess();
 	// Check if GMAC owns any of the buffers to be transferred
@@ -165,6 +167,7 @@ int __gmac_MPI_Send( void *buf, int count, MPI_Datatype datatype, int dest, int
 {
 	if(inGmac() == 1) return func(buf, count, datatype, dest, tag, comm);
     if(__MPI_Send == NULL) mpiInit();
+    if(isGmacAddress(buf, 0) == false) return func(buf, count, datatype, dest, tag, comm);
 
 	// Check if GMAC owns any of the buffers to be transferred
 	Mode *srcMode = getProcess().owner(hostptr_t(buf));
@@ -259,6 +262,7 @@ int MPI_Recv( void *buf, int count, MPI_Datatype datatype, int source, int tag,
 {
 	if(inGmac() == 1) return __MPI_Recv(buf, count, datatype, source, tag, comm, status);
     if(__MPI_Recv == NULL) mpiInit();
+    if(isGmacAddress(buf, 0) == false) return __MPI_Recv(buf, count, datatype, source, tag, comm, status);
 
 	// Locate memory regions (if any)
 	Mode *dstMode = getProcess().owner(hostptr_t(buf));
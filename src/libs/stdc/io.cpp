@@ -30,7 +30,8 @@ size_t SYMBOL(fread)(void *buf, size_t size, size_t nmemb, FILE *stream)
 {
 	if(__libc_fread == NULL) stdcIoInit();
 	if((inGmac() == 1) ||
-       (size * nmemb == 0)) return __libc_fread(buf, size, nmemb, stream);
+       (size * nmemb == 0) ||
+       (isGmacAddress(buf, size * nmemb) == false)) return __libc_fread(buf, size, nmemb, stream);
 
     enterGmac();
     Mode *dstMode = getProcess().owner(hostptr_t(buf), size);
@@ -96,7 +97,8 @@ size_t SYMBOL(fwrite)(const void *buf, size_t size, size_t nmemb, FILE *stream)
 {
     if(__libc_fwrite == NULL) stdcIoInit();
 	if((inGmac() == 1) ||
-       (size * nmemb == 0)) return __libc_fwrite(buf, size, nmemb, stream);
+       (size * nmemb == 0) ||
+       (isGmacAddress(buf, size * nmemb) == false)) return __libc_fwrite(buf, size, nmemb, stream);
 
 	enterGmac();
     Mode *srcMode = getProcess().owner(hostptr_t(buf), size);
@@ -0,0 +1,85 @@
+#include "core/IOBuffer.h"
+#include "core/Mode.h"
+
+#include "trace/Tracer.h"
+#include "util/Logger.h"
+#include "util/Parameter.h"
+
+#include "AcceleratorCopy.h"
+
+namespace __impl { namespace memory {
+
+gmacError_t AcceleratorCopy(core::Mode &dstMode, accptr_t dst,
+                            core::Mode &srcMode, const accptr_t src, size_t count)
+{
+    if(count == 0) return gmacSuccess;
+    if(dstMode.hasPeerAccess(srcMode) == true) {
+        gmacError_t ret = dstMode.copyAcceleratorPeer(dst, srcMode, src, count);
+        if(ret != gmacErrorFeatureNotSupported) return ret;
+    }
+
+    trace::EnterCurrentFunction();
+    TRACE(GLOBAL, "Staged accelerator copy: %p -> %p ("FMT_SIZE" bytes)", src.get(), dst.get(), count);
+    gmacError_t ret = gmacSuccess;
+
+    size_t chunk = util::params::ParamMemcpyAccToAccChunk;
+    if(count < chunk) chunk = count;
+
+    // Buffers belong to the source accelerator, which fills them. The
+    // destination accelerator reads them through their host memory
+    core::IOBuffer *active = &srcMode.createIOBuffer(chunk, GMAC_PROT_READWRITE);
+    core::IOBuffer *passive = NULL;
+    if(active->async() == false) {
+        // No pinned memory available: bounce each chunk through the buffer
+        size_t off = 0;
+        while(off < count && ret == gmacSuccess) {
+            size_t len = (count - off) < active->size()? count - off: active->size();
+            ret = srcMode.copyToHost(active->addr(), src + off, len);
+            if(ret == gmacSuccess) ret = dstMode.copyToAccelerator(dst + off, active->addr(), len);
+            off += len;
+        }
+        srcMode.destroyIOBuffer(*active);
+        trace::ExitCurrentFunction();
+        return ret;
+    }
+    if(chunk < count) passive = &srcMode.createIOBuffer(chunk, GMAC_PROT_READWRITE);
+
+    size_t off = 0;
+    size_t len = chunk;
+    ret = srcMode.acceleratorToBuffer(*active, src, len);
+    while(ret == gmacSuccess && off < count) {
+        ret = active->wait();
+        if(ret != gmacSuccess) break;
+        // Start the device to host leg of the next chunk while this one
+        // is sent to the destination accelerator
+        size_t next = off + len;
+        size_t nextLen = 0;
+        if(next < count) {
+            nextLen = (count - next) < chunk? count - next: chunk;
+            ret = srcMode.acceleratorToBuffer(*passive, src + next, nextLen);
+            if(ret != gmacSuccess) break;
+        }
+        ret = dstMode.copyToAccelerator(dst + off, active->addr(), len);
+        if(ret != gmacSuccess) break;
+        off = next;
+        len = nextLen;
+        if(passive != NULL) {
+            core::IOBuffer *tmp = active;
+            active = passive;
+            passive = tmp;
+        }
+    }
+
+    // Clean up buffers after they are idle
+    if(passive != NULL) {
+        passive->wait();
+        srcMode.destroyIOBuffer(*passive);
+    }
+    active->wait();
+    srcMode.destroyIOBuffer(*active);
+
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
+}}
@@ -0,0 +1,66 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_ACCELERATORCOPY_H_
+#define GMAC_MEMORY_ACCELERATORCOPY_H_
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+
+namespace __impl {
+
+namespace core {
+class Mode;
+}
+
+namespace memory {
+
+/**
+ * Copies data between the accelerator memories of two execution modes. If
+ * the destination accelerator can directly access the source accelerator, a
+ * peer copy is used. Otherwise, data is staged through two pinned I/O buffers
+ * of the source execution mode, so the device to host transfer of a chunk
+ * overlaps with the host to device transfer of the previous chunk
+ * \param dstMode Execution mode owning the destination accelerator memory
+ * \param dst Destination accelerator memory
+ * \param srcMode Execution mode owning the source accelerator memory
+ * \param src Source accelerator memory
+ * \param count Number of bytes to be copied
+ * \return Error code
+ */
+gmacError_t AcceleratorCopy(core::Mode &dstMode, accptr_t dst,
+                            core::Mode &srcMode, const accptr_t src, size_t count);
+
+}}
+
+#endif
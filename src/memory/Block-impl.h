@@ -17,7 +17,10 @@ inline Block::Block(Protocol &protocol, hostptr_t addr, hostptr_t shadow, size_t
     protocol_(protocol),
     size_(size),
     addr_(addr),
-    shadow_(shadow)
+    shadow_(shadow),
+    objectEpoch_(NULL),
+    epoch_(0),
+    advice_(GMAC_ADVICE_NONE)
 {
 }
 
@@ -25,6 +28,42 @@ inline Block::~Block()
 {
 }
 
+inline void Block::setEpoch(const Atomic &objectEpoch, unsigned epoch)
+{
+    objectEpoch_ = &objectEpoch;
+    epoch_ = epoch;
+}
+
+inline unsigned Block::epoch() const
+{
+    return epoch_;
+}
+
+inline bool Block::pendingAcquire() const
+{
+    return objectEpoch_ != NULL && unsigned(*objectEpoch_) != epoch_;
+}
+
+inline void Block::updateEpoch()
+{
+    if(objectEpoch_ != NULL) epoch_ = unsigned(*objectEpoch_);
+}
+
+inline void Block::detachEpoch()
+{
+    objectEpoch_ = NULL;
+}
+
+inline GmacMemAdvice Block::advice() const
+{
+    return advice_;
+}
+
+inline void Block::setAdvice(GmacMemAdvice advice)
+{
+    advice_ = advice;
+}
+
 inline hostptr_t Block::addr() const
 {
     return addr_;}
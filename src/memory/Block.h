@@ -39,6 +39,7 @@ WITH THE SOFTWARE.  */
 
 #include "include/gmac/types.h"
 #include "memory/Protocol.h"
+#include "util/Atomics.h"
 #include "util/Lock.h"
 #include "util/Logger.h"
 #include "util/Reference.h"
@@ -82,6 +83,15 @@ protected:
     /** Shadow host memory mapping that is always read/write. */
     hostptr_t shadow_;
 
+    /** Acquire epoch of the object the block belongs to, or NULL */
+    const Atomic *objectEpoch_;
+
+    /** Object acquire epoch already applied to the block state */
+    unsigned epoch_;
+
+    /** Expected access pattern given by the application */
+    GmacMemAdvice advice_;
+
     /**
      * Default construcutor
      * \param protocol Memory coherence protocol used by the block
@@ -97,6 +107,49 @@ protected:
     virtual ~Block();
 
 public:
+    /**
+     * Links the block to the acquire epoch of its object. Objects acquired
+     * as a whole bump their epoch, and the protocol applies the acquire to
+     * each block the next time the block is used
+     * \param objectEpoch Acquire epoch of the object
+     * \param epoch Object epoch already applied to the block state
+     */
+    void setEpoch(const Atomic &objectEpoch, unsigned epoch);
+
+    /**
+     * Gets the object epoch already applied to the block state
+     * \return Object epoch applied to the block
+     */
+    unsigned epoch() const;
+
+    /**
+     * Tells if the object was acquired after the block state was updated
+     * \return True if the block has an acquire pending
+     */
+    bool pendingAcquire() const;
+
+    /**
+     * Marks the last acquire of the object as applied to the block state
+     */
+    void updateEpoch();
+
+    /**
+     * Unlinks the block from the acquire epoch of its object. Used when the
+     * object is being destroyed while the block is still referenced
+     */
+    void detachEpoch();
+
+    /**
+     * Gets the expected access pattern of the block
+     * \return Advice given by the application
+     */
+    GmacMemAdvice advice() const;
+
+    /**
+     * Sets the expected access pattern of the block
+     * \param advice Advice given by the application
+     */
+    void setAdvice(GmacMemAdvice advice);
 
     /**
      * Host memory address where the block starts
@@ -130,7 +183,17 @@ protected:
      * \return Error code
      */
     gmacError_t toAccelerator() { return toAccelerator(0, size_); }
-    virtual gmacError_t toAccelerator(unsigned blockOff, size_t count) = 0;
+    virtual gmacError_t toAccelerator(size_t blockOff, size_t count) = 0;
+
+    /**
+     * Sends several ranges of the block to the accelerator packed in a
+     * single transfer
+     * \param offsets Offsets (in bytes) of the ranges within the block
+     * \param count Number of ranges
+     * \param size Size (in bytes) of each range
+     * \return Error code
+     */
+    virtual gmacError_t scatterToAccelerator(const size_t *offsets, unsigned count, size_t size) = 0;
 
     /**
      * Ensures that the host memory has a valid and accessible copy of the data
@@ -144,7 +207,7 @@ protected:
      * \param count Size (in bytes)
      * \return Error code
      */
-    virtual gmacError_t toHost(unsigned blockOff, size_t count) = 0;
+    virtual gmacError_t toHost(size_t blockOff, size_t count) = 0;
 
 public:
     /**
@@ -3,6 +3,8 @@
 
 #include "core/Mode.h"
 #include "GenericBlock.h"
+#include "Recorder.h"
+#include "TranslationCache.h"
 
 namespace __impl { namespace memory {
 
@@ -57,18 +59,19 @@ mallocHost(accptr_t addr, size_t size, hostptr_t &hostAddr)
 
 template<typename State>
 gmacError_t
-BlockGroup<State>::populateBlocks()
+BlockGroup<State>::populateBlocks(typename State::ProtocolState state)
 {
     // Create memory blocks
     hostptr_t mark = addr_;
     ptroff_t offset = 0;
     size_t size = size_; 
     while(size > 0) {
-        size_t blockSize = (size > BlockSize_) ? BlockSize_ : size;
+        size_t blockSize = (size > blockSize_) ? blockSize_ : size;
         mark += blockSize;
-        blocks_.insert(BlockMap::value_type(mark,
-                       new GenericBlock<State>(protocol_, addr_ + offset,
-                           shadow_ + offset, blockSize, init_)));
+        GenericBlock<State> *block = new GenericBlock<State>(protocol_, addr_ + offset,
+                                                             shadow_ + offset, blockSize, state);
+        block->setEpoch(epoch_, unsigned(epoch_));
+        blocks_.insert(BlockMap::value_type(mark, block));
         size -= blockSize;
         offset += ptroff_t(blockSize);
         TRACE(LOCAL, "Creating BlockGroup @ %p : shadow @ %p ("FMT_SIZE" bytes) ", addr_, shadow_, blockSize);
@@ -88,6 +91,8 @@ BlockGroup<State>::repopulateBlocks(accptr_t accPtr, core::Mode &mode)
                                                                 addr_   + offset,
                                                                 shadow_ + offset,
                                                                 oldBlock.size(), oldBlock.getState());
+        // Keep any acquire still pending on the old block
+        newBlock->setEpoch(epoch_, oldBlock.epoch());
 
         newBlock->addOwner(mode, accPtr + offset);
         i->second = newBlock;
@@ -101,15 +106,63 @@ BlockGroup<State>::repopulateBlocks(accptr_t accPtr, core::Mode &mode)
     return gmacSuccess;
 }
 
+template<typename State>
+gmacError_t
+BlockGroup<State>::resizeBlocks(size_t blockSize)
+{
+    // Blocks of objects shared by several modes, or with per-block advice,
+    // are not replaced
+    if (owners_ != 1 || mapped_ == false || advised_ == true) {
+        fixedBlockSize_ = true;
+        return gmacSuccess;
+    }
+    // New blocks are created in a single state, so all the current blocks
+    // must share it (e.g., all invalid after acquiring the object), and no
+    // block can hold host changes still to be sent to the accelerator
+    BlockMap::iterator i = blocks_.begin();
+    if (i == blocks_.end()) return gmacSuccess;
+    typename State::ProtocolState state =
+        dynamic_cast<GenericBlock<State> &>(*i->second).getState();
+    for (; i != blocks_.end(); ++i) {
+        if (protocol_.needUpdate(*i->second) == false) return gmacSuccess;
+        if (dynamic_cast<GenericBlock<State> &>(*i->second).getState() != state)
+            return gmacSuccess;
+    }
+
+    TRACE(LOCAL, "Resizing blocks of BlockGroup @ %p: "FMT_SIZE" -> "FMT_SIZE" bytes",
+          addr_, blockSize_, blockSize);
+    gmacError_t ret = coherenceOp(&Protocol::deleteBlock);
+    if (ret != gmacSuccess) return ret;
+    for (i = blocks_.begin(); i != blocks_.end(); ++i) {
+        i->second->decRef();
+    }
+    blocks_.clear();
+
+    blockSize_ = blockSize;
+    ret = populateBlocks(state);
+    if (ret != gmacSuccess) return ret;
+
+    accptr_t acceleratorAddr = acceleratorAddr_.begin()->first;
+    for (i = blocks_.begin(); i != blocks_.end(); ++i) {
+        ptroff_t offset = ptroff_t(i->second->addr() - addr_);
+        GenericBlock<State> &block = dynamic_cast<GenericBlock<State> &>(*i->second);
+        block.addOwner(*ownerShortcut_, acceleratorAddr + offset);
+    }
+    Recorder::record(GMAC_RECORD_BLOCKSIZE, ownerShortcut_->getId(), addr_, blockSize_);
+    return gmacSuccess;
+}
+
 template<typename State>
 BlockGroup<State>::BlockGroup(Protocol &protocol, core::Mode &owner,
-                              hostptr_t hostAddr, size_t size, typename State::ProtocolState init, gmacError_t &err) :
-    Object(hostAddr, size),
+                              hostptr_t hostAddr, size_t size, typename State::ProtocolState init, gmacError_t &err,
+                              size_t blockSize) :
+    Object(hostAddr, size, blockSize),
     hasUserMemory_(hostAddr != NULL),
     owners_(0),
     ownerShortcut_(NULL),
     protocol_(protocol),
-    init_(init)
+    init_(init),
+    mapped_(false)
 {
     shadow_ = NULL;
     err = gmacSuccess;
@@ -120,6 +173,13 @@ BlockGroup<State>::BlockGroup(Protocol &protocol, core::Mode &owner,
 template<typename State>
 BlockGroup<State>::~BlockGroup()
 {
+    // Blocks still referenced by the protocol must not touch the memory
+    // once it is unmapped
+    lockWrite();
+    gmacError_t ret = coherenceOp(&Protocol::deleteBlock);
+    ASSERTION(ret == gmacSuccess);
+    unlock();
+
     AcceleratorMap::iterator i;
     for (i = acceleratorAddr_.begin(); i != acceleratorAddr_.end(); i++) {
         std::list<core::Mode *> modes = i->second;
@@ -209,7 +269,7 @@ BlockGroup<State>::addOwner(core::Mode &mode)
             return ret;
         }
 
-        ret = populateBlocks();
+        ret = populateBlocks(init_);
         if (ret != gmacSuccess) {
             unlock();
             return ret;
@@ -236,6 +296,7 @@ BlockGroup<State>::addOwner(core::Mode &mode)
         ownerShortcut_ = NULL;
     }
     owners_++;
+    mapped_ = true;
     unlock();
     return gmacSuccess;
 }
@@ -262,11 +323,14 @@ BlockGroup<State>::removeOwner(core::Mode &mode)
             TRACE(LOCAL, "BlockGroup @ %p is NOT going orphan", addr_);
         }
 
-        gmacError_t ret = coherenceOp(&Protocol::deleteBlock);
+        // Deleted blocks are host-only, so they are brought to the host first
+        gmacError_t ret = coherenceOp(&Protocol::unmapFromAccelerator);
         ASSERTION(ret == gmacSuccess);
-        ret = coherenceOp(&Protocol::unmapFromAccelerator);
+        ret = coherenceOp(&Protocol::deleteBlock);
         ASSERTION(ret == gmacSuccess);
-        ownerShortcut_->unmap(addr_, size_);
+        // Evicted objects do not have accelerator memory any more
+        if (mapped_) ownerShortcut_->unmap(addr_, size_);
+        mapped_ = false;
 
         acceleratorAddr_.clear();
 
@@ -312,6 +376,7 @@ BlockGroup<State>::removeOwner(core::Mode &mode)
 
     owners_--;
     unlock();
+    TranslationCache::invalidate();
     return gmacSuccess;
 }
 
@@ -337,14 +402,21 @@ BlockGroup<State>::mapToAccelerator()
             AcceleratorMap::iterator it = acceleratorAddr_.find(newAcceleratorAddr);
             it->second.push_back(ownerShortcut_);
             
+            // Register the new mapping, so the memory can be unmapped later
+            ret = ownerShortcut_->add_mapping(newAcceleratorAddr, addr_, size_);
+        }
+        if (ret == gmacSuccess) {
             // Recreate accelerator blocks
             repopulateBlocks(newAcceleratorAddr, *ownerShortcut_);
             // Add blocks to the coherence domain
             ret = coherenceOp(&Protocol::mapToAccelerator);
+            mapped_ = true;
+            // The object has a new accelerator address
+            TranslationCache::invalidate();
         }
     } else {
         // Not supported for now
-        return gmacErrorFeatureNotSupported;
+        ret = gmacErrorFeatureNotSupported;
     }
 
     unlock();
@@ -360,7 +432,10 @@ BlockGroup<State>::unmapFromAccelerator()
 
     lockWrite();
     // Not supported for now
-    if (owners_ == 1) {
+    if (owners_ == 1 && mapped_ == false) {
+        // The object has been already unmapped
+        ret = gmacSuccess;
+    } else if (owners_ == 1) {
         // Remove blocks from the coherence domain
         ret = coherenceOp(&Protocol::unmapFromAccelerator);
 
@@ -368,6 +443,8 @@ BlockGroup<State>::unmapFromAccelerator()
         if (ret == gmacSuccess) {
             ret = ownerShortcut_->unmap(addr_, size_);
             ASSERTION(ret == gmacSuccess, "Error unmapping object from accelerator");
+            mapped_ = false;
+            TranslationCache::invalidate();
         }
     } else {
         ret = gmacErrorFeatureNotSupported;
@@ -376,6 +453,13 @@ BlockGroup<State>::unmapFromAccelerator()
     return ret;
 }
 
+template<typename State>
+inline bool
+BlockGroup<State>::isMapped() const
+{
+    return mapped_;
+}
+
 }}
 
 #endif
@@ -59,13 +59,16 @@ protected:
     core::Mode *ownerShortcut_;
     Protocol &protocol_;
     typename State::ProtocolState init_;
+    bool mapped_;
 
-    gmacError_t populateBlocks();
+    gmacError_t populateBlocks(typename State::ProtocolState state);
     gmacError_t repopulateBlocks(accptr_t accPtr, core::Mode &mode);
+    gmacError_t resizeBlocks(size_t blockSize);
 
     void modifiedObject();
 public:
-    BlockGroup(Protocol &protocol, core::Mode &owner, hostptr_t cpuAddr, size_t size, typename State::ProtocolState init, gmacError_t &err);
+    BlockGroup(Protocol &protocol, core::Mode &owner, hostptr_t cpuAddr, size_t size, typename State::ProtocolState init, gmacError_t &err,
+               size_t blockSize = 0);
     virtual ~BlockGroup();
 
     accptr_t acceleratorAddr(core::Mode &current, const hostptr_t addr) const;
@@ -76,6 +79,7 @@ public:
 
     gmacError_t mapToAccelerator();
     gmacError_t unmapFromAccelerator();
+    bool isMapped() const;
 
     static gmacError_t split(BlockGroup &group, size_t offset, size_t size);
 };
@@ -0,0 +1,17 @@
+#ifndef GMAC_MEMORY_CHECKPOINT_IMPL_H_
+#define GMAC_MEMORY_CHECKPOINT_IMPL_H_
+
+namespace __impl { namespace memory {
+
+inline bool
+Checkpoint::captured() const
+{
+    lock();
+    bool ret = (pending_ == 0);
+    unlock();
+    return ret;
+}
+
+}}
+
+#endif
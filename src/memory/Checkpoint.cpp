@@ -0,0 +1,376 @@
+#if defined(POSIX)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "Checkpoint.h"
+
+#include "core/IOBuffer.h"
+#include "core/Mode.h"
+#include "memory/Object.h"
+#include "memory/ObjectMap.h"
+#include "trace/Tracer.h"
+#include "util/Logger.h"
+#include "util/Parameter.h"
+
+namespace __impl { namespace memory {
+
+static const char CheckpointMagic_[8] = { 'G', 'M', 'A', 'C', 'C', 'K', 'P', 'T' };
+static const uint32_t CheckpointVersion_ = 1;
+
+/** Header at the beginning of checkpoint files */
+struct CheckpointHeader {
+    char magic_[8];
+    uint32_t version_;
+    uint32_t objects_;
+};
+
+/** Description of each object in a checkpoint file, after the header */
+struct CheckpointObject {
+    uint64_t addr_;
+    uint64_t size_;
+};
+
+#if defined(POSIX)
+static gmacError_t
+writeFile(int fd, const void *addr, size_t size, off_t offset)
+{
+    const uint8_t *ptr = static_cast<const uint8_t *>(addr);
+    while(size > 0) {
+        ssize_t ret = ::pwrite(fd, ptr, size, offset);
+        if(ret <= 0) return gmacErrorUnknown;
+        ptr += ret;
+        size -= size_t(ret);
+        offset += ret;
+    }
+    return gmacSuccess;
+}
+
+static gmacError_t
+readFile(int fd, void *addr, size_t size, off_t offset)
+{
+    uint8_t *ptr = static_cast<uint8_t *>(addr);
+    while(size > 0) {
+        ssize_t ret = ::pread(fd, ptr, size, offset);
+        if(ret <= 0) return gmacErrorInvalidValue;
+        ptr += ret;
+        size -= size_t(ret);
+        offset += ret;
+    }
+    return gmacSuccess;
+}
+#endif
+
+Checkpoint::Checkpoint(core::Mode &mode, int fd, const std::vector<Object *> &objects) :
+    gmac::util::Lock("Checkpoint"),
+    mode_(mode),
+    fd_(fd),
+    objects_(objects),
+    pending_(0),
+    error_(gmacSuccess),
+    started_(false),
+    finished_(false),
+    waiters_(0),
+    done_(0)
+{
+    size_t chunkSize = util::params::ParamBlockSize;
+    off_t fileOffset = off_t(sizeof(CheckpointHeader) + objects_.size() * sizeof(CheckpointObject));
+    std::vector<Object *>::const_iterator i;
+    for(i = objects_.begin(); i != objects_.end(); ++i) {
+        for(size_t offset = 0; offset < (*i)->size(); offset += chunkSize) {
+            Chunk chunk;
+            chunk.object_ = *i;
+            chunk.offset_ = offset;
+            chunk.size_ = (*i)->size() - offset < chunkSize? (*i)->size() - offset: chunkSize;
+            chunk.fileOffset_ = fileOffset;
+            chunk.state_ = Pending;
+            chunk.copy_ = NULL;
+            chunks_.push_back(chunk);
+            fileOffset += off_t(chunk.size_);
+        }
+    }
+    pending_ = chunks_.size();
+
+    buffers_[0] = &mode_.createIOBuffer(chunkSize, GMAC_PROT_READ);
+    buffers_[1] = &mode_.createIOBuffer(chunkSize, GMAC_PROT_READ);
+}
+
+Checkpoint::~Checkpoint()
+{
+    wait();
+    mode_.destroyIOBuffer(*buffers_[0]);
+    mode_.destroyIOBuffer(*buffers_[1]);
+    std::vector<Chunk>::iterator c;
+    for(c = chunks_.begin(); c != chunks_.end(); ++c) {
+        if(c->copy_ != NULL) delete [] c->copy_;
+    }
+    std::vector<Object *>::iterator i;
+    for(i = objects_.begin(); i != objects_.end(); ++i) (*i)->decRef();
+#if defined(POSIX)
+    ::close(fd_);
+#endif
+}
+
+gmacError_t Checkpoint::start()
+{
+#if defined(POSIX)
+    CheckpointHeader header;
+    ::memcpy(header.magic_, CheckpointMagic_, sizeof(header.magic_));
+    header.version_ = CheckpointVersion_;
+    header.objects_ = uint32_t(objects_.size());
+    gmacError_t ret = writeFile(fd_, &header, sizeof(header), 0);
+    if(ret != gmacSuccess) return ret;
+
+    off_t offset = sizeof(header);
+    std::vector<Object *>::const_iterator i;
+    for(i = objects_.begin(); i != objects_.end(); ++i) {
+        CheckpointObject object;
+        object.addr_ = uint64_t((*i)->addr());
+        object.size_ = uint64_t((*i)->size());
+        ret = writeFile(fd_, &object, sizeof(object), offset);
+        if(ret != gmacSuccess) return ret;
+        offset += sizeof(object);
+
+        // Host writes to dirty data must fault, so it is copied aside first
+        ret = (*i)->writeProtect();
+        if(ret != gmacSuccess) return ret;
+    }
+
+    pthread_t tid;
+    if(pthread_create(&tid, NULL, worker, this) != 0) {
+        WARNING("Unable to create checkpoint thread");
+        return gmacErrorUnknown;
+    }
+    pthread_detach(tid);
+    started_ = true;
+    TRACE(LOCAL, "Checkpointing "FMT_SIZE" objects in "FMT_SIZE" chunks", objects_.size(), chunks_.size());
+    return gmacSuccess;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+void *Checkpoint::worker(void *arg)
+{
+    Checkpoint &checkpoint = *static_cast<Checkpoint *>(arg);
+    checkpoint.run();
+    checkpoint.lock();
+    checkpoint.finished_ = true;
+    for(; checkpoint.waiters_ > 0; checkpoint.waiters_--) checkpoint.done_.post();
+    checkpoint.unlock();
+    return NULL;
+}
+
+void Checkpoint::run()
+{
+    core::IOBuffer *active = buffers_[0];
+    core::IOBuffer *passive = buffers_[1];
+    size_t n = chunks_.size();
+    if(n > 0) issue(0, *active);
+    for(size_t i = 0; i < n; i++) {
+        // The next chunk is read while the current one is written
+        if(i + 1 < n) issue(i + 1, *passive);
+        write(i, *active);
+        core::IOBuffer *tmp = active;
+        active = passive;
+        passive = tmp;
+    }
+}
+
+void Checkpoint::issue(size_t n, core::IOBuffer &buffer)
+{
+    Chunk &chunk = chunks_[n];
+    lock();
+    if(chunk.state_ != Pending) {
+        unlock();
+        return;
+    }
+    chunk.state_ = InFlight;
+    unlock();
+
+    gmacError_t ret = chunk.object_->copyToBuffer(buffer, chunk.size_, 0, chunk.offset_);
+    if(ret == gmacSuccess) return;
+
+    // Fall back to a copy, which is written once the buffer is ready
+    lock();
+    if(chunk.state_ == InFlight) ret = capture(mode_, chunk);
+    if(ret != gmacSuccess && error_ == gmacSuccess) error_ = ret;
+    unlock();
+}
+
+void Checkpoint::write(size_t n, core::IOBuffer &buffer)
+{
+    Chunk &chunk = chunks_[n];
+    gmacError_t ret = buffer.wait();
+
+    lock();
+    uint8_t *copy = NULL;
+    if(chunk.state_ == InFlight) {
+        chunk.state_ = Done;
+        pending_--;
+    } else if(chunk.state_ == Captured) {
+        // The chunk was modified while being read, so use the copy
+        copy = chunk.copy_;
+        chunk.copy_ = NULL;
+        chunk.state_ = Done;
+    }
+    unlock();
+
+#if defined(POSIX)
+    if(ret == gmacSuccess) {
+        if(copy != NULL) ret = writeFile(fd_, copy, chunk.size_, chunk.fileOffset_);
+        else ret = writeFile(fd_, buffer.addr(), chunk.size_, chunk.fileOffset_);
+    }
+#endif
+    if(copy != NULL) delete [] copy;
+    if(ret != gmacSuccess) {
+        lock();
+        if(error_ == gmacSuccess) error_ = ret;
+        unlock();
+    }
+}
+
+gmacError_t Checkpoint::capture(core::Mode &mode, Chunk &chunk)
+{
+    ASSERTION(chunk.state_ == Pending || chunk.state_ == InFlight);
+    chunk.copy_ = new uint8_t[chunk.size_];
+    gmacError_t ret = chunk.object_->memcpyFromObject(mode, hostptr_t(chunk.copy_),
+                                                      chunk.offset_, chunk.size_);
+    if(ret != gmacSuccess) {
+        delete [] chunk.copy_;
+        chunk.copy_ = NULL;
+        return ret;
+    }
+    chunk.state_ = Captured;
+    pending_--;
+    return gmacSuccess;
+}
+
+gmacError_t Checkpoint::capture(core::Mode &mode, hostptr_t addr, size_t size)
+{
+    gmacError_t ret = gmacSuccess;
+    lock();
+    if(pending_ == 0) {
+        unlock();
+        return ret;
+    }
+    std::vector<Chunk>::iterator c;
+    for(c = chunks_.begin(); c != chunks_.end(); ++c) {
+        if(c->state_ != Pending && c->state_ != InFlight) continue;
+        hostptr_t start = c->object_->addr() + c->offset_;
+        if(start >= addr + size || start + c->size_ <= addr) continue;
+        TRACE(LOCAL, "Capturing chunk %p before it is modified", start);
+        ret = capture(mode, *c);
+        if(ret != gmacSuccess) break;
+    }
+    unlock();
+    return ret;
+}
+
+gmacError_t Checkpoint::captureAll(core::Mode &mode)
+{
+    gmacError_t ret = gmacSuccess;
+    lock();
+    std::vector<Chunk>::iterator c;
+    for(c = chunks_.begin(); c != chunks_.end() && pending_ > 0; ++c) {
+        if(c->state_ != Pending && c->state_ != InFlight) continue;
+        ret = capture(mode, *c);
+        if(ret != gmacSuccess) break;
+    }
+    unlock();
+    return ret;
+}
+
+gmacError_t Checkpoint::wait()
+{
+    lock();
+    if(started_ == true && finished_ == false) {
+        waiters_++;
+        unlock();
+        done_.wait();
+        lock();
+    }
+    gmacError_t ret = error_;
+    unlock();
+    return ret;
+}
+
+gmacError_t Checkpoint::restore(core::Mode &mode, int fd, const std::vector<hostptr_t> &addrs)
+{
+#if defined(POSIX)
+    CheckpointHeader header;
+    gmacError_t ret = readFile(fd, &header, sizeof(header), 0);
+    if(ret != gmacSuccess) return ret;
+    if(::memcmp(header.magic_, CheckpointMagic_, sizeof(header.magic_)) != 0 ||
+       header.version_ != CheckpointVersion_) return gmacErrorInvalidValue;
+    if(addrs.empty() == false && addrs.size() != header.objects_) return gmacErrorInvalidValue;
+
+    // Look up all the objects before modifying any of them
+    std::vector<Object *> objects;
+    off_t offset = sizeof(header);
+    ObjectMap &map = mode.getAddressSpace();
+    for(uint32_t n = 0; n < header.objects_; n++) {
+        CheckpointObject object;
+        ret = readFile(fd, &object, sizeof(object), offset);
+        if(ret != gmacSuccess) break;
+        offset += sizeof(object);
+        hostptr_t addr = addrs.empty()? hostptr_t(object.addr_): addrs[n];
+        Object *obj = map.getObject(addr);
+        if(obj == NULL) {
+            ret = gmacErrorInvalidValue;
+            break;
+        }
+        objects.push_back(obj);
+        if(obj->addr() != addr || uint64_t(obj->size()) != object.size_) {
+            ret = gmacErrorInvalidSize;
+            break;
+        }
+    }
+
+    size_t chunkSize = util::params::ParamBlockSize;
+    core::IOBuffer *active = NULL;
+    core::IOBuffer *passive = NULL;
+    if(ret == gmacSuccess) {
+        active = &mode.createIOBuffer(chunkSize, GMAC_PROT_WRITE);
+        passive = &mode.createIOBuffer(chunkSize, GMAC_PROT_WRITE);
+    }
+
+    std::vector<Object *>::iterator i;
+    for(i = objects.begin(); i != objects.end() && ret == gmacSuccess; ++i) {
+        Object &obj = **i;
+        TRACE(GLOBAL, "Restoring object %p", obj.addr());
+        // Data goes straight to the accelerator memory
+        ret = obj.invalidate();
+        for(size_t off = 0; off < obj.size() && ret == gmacSuccess; off += chunkSize) {
+            size_t size = obj.size() - off < chunkSize? obj.size() - off: chunkSize;
+            // Wait for the previous transfer using the buffer
+            ret = active->wait();
+            if(ret != gmacSuccess) break;
+            ret = readFile(fd, active->addr(), size, offset);
+            if(ret != gmacSuccess) break;
+            offset += off_t(size);
+            ret = obj.copyFromBuffer(*active, size, 0, off);
+            core::IOBuffer *tmp = active;
+            active = passive;
+            passive = tmp;
+        }
+    }
+
+    if(active != NULL) {
+        gmacError_t err = active->wait();
+        if(ret == gmacSuccess) ret = err;
+        err = passive->wait();
+        if(ret == gmacSuccess) ret = err;
+        mode.destroyIOBuffer(*active);
+        mode.destroyIOBuffer(*passive);
+    }
+    for(i = objects.begin(); i != objects.end(); ++i) (*i)->decRef();
+    return ret;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+}}
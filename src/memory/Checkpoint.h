@@ -0,0 +1,209 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_CHECKPOINT_H_
+#define GMAC_MEMORY_CHECKPOINT_H_
+
+#include <vector>
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "util/Lock.h"
+#include "util/Semaphore.h"
+
+namespace __impl {
+
+namespace core {
+class IOBuffer;
+class Mode;
+}
+
+namespace memory {
+
+class Object;
+
+/**
+ * Snapshot of a set of objects being written to a file. The snapshot is taken
+ * when the checkpoint is created, and a run-time thread streams the objects
+ * to the file while the application keeps running. Any part of an object
+ * that is about to be modified before being written is copied aside first
+ */
+class GMAC_LOCAL Checkpoint : protected gmac::util::Lock {
+    // Lock protects the state of the chunks
+protected:
+    /** State of a chunk of object data */
+    enum ChunkState {
+        Pending,  /*!< Not read yet */
+        InFlight, /*!< Being copied to an I/O buffer by the checkpoint thread */
+        Captured, /*!< Copied aside before being modified */
+        Done      /*!< Written to the file or being written */
+    };
+
+    /** Piece of an object that is read and written at once */
+    struct Chunk {
+        Object *object_;
+        size_t offset_;
+        size_t size_;
+        off_t fileOffset_;
+        ChunkState state_;
+        uint8_t *copy_;
+    };
+
+    /** Execution mode that requested the checkpoint */
+    core::Mode &mode_;
+
+    /** File descriptor of the checkpoint file */
+    int fd_;
+
+    /** Objects in the checkpoint */
+    std::vector<Object *> objects_;
+
+    /** Chunks of the objects, in file order */
+    std::vector<Chunk> chunks_;
+
+    /** Number of chunks that still hold the data in the objects */
+    size_t pending_;
+
+    /** I/O buffers used to stream the objects */
+    core::IOBuffer *buffers_[2];
+
+    /** First error produced by the checkpoint thread */
+    gmacError_t error_;
+
+    /** Whether the checkpoint thread has been spawned */
+    bool started_;
+    /** Whether all the chunks have been written */
+    bool finished_;
+    /** Number of threads waiting for the checkpoint thread */
+    unsigned waiters_;
+    /** Posted once per waiter when all the chunks have been written */
+    util::Semaphore done_;
+
+    /**
+     * Entry point for the checkpoint thread
+     * \param arg Checkpoint the thread belongs to
+     */
+    static void *worker(void *arg);
+
+    /** Writes all the chunks to the file */
+    void run();
+
+    /**
+     * Starts copying a chunk to an I/O buffer, unless it has been captured
+     * \param n Index of the chunk
+     * \param buffer I/O buffer where to copy the chunk
+     */
+    void issue(size_t n, core::IOBuffer &buffer);
+
+    /**
+     * Writes a chunk to the file, from the I/O buffer or from its captured copy
+     * \param n Index of the chunk
+     * \param buffer I/O buffer where the chunk was copied
+     */
+    void write(size_t n, core::IOBuffer &buffer);
+
+    /**
+     * Copies a chunk aside. The checkpoint lock must be held
+     * \param mode Execution mode requesting the copy
+     * \param chunk Chunk to be copied
+     * \return Error code
+     */
+    gmacError_t capture(core::Mode &mode, Chunk &chunk);
+
+public:
+    /**
+     * Takes a snapshot of a set of objects. The objects are written to the
+     * file by a run-time thread
+     * \param mode Execution mode requesting the checkpoint
+     * \param fd File descriptor of the checkpoint file
+     * \param objects Objects to be written
+     */
+    Checkpoint(core::Mode &mode, int fd, const std::vector<Object *> &objects);
+
+    /** Waits for the checkpoint thread and closes the checkpoint file */
+    ~Checkpoint();
+
+    /**
+     * Writes the file header and starts the checkpoint thread
+     * \return Error code
+     */
+    gmacError_t start();
+
+    /**
+     * Copies aside the chunks in a memory range that have not been written
+     * yet. It must be called before the range is modified
+     * \param mode Execution mode that is going to modify the range
+     * \param addr Starting address of the memory range
+     * \param size Size (in bytes) of the memory range
+     * \return Error code
+     */
+    gmacError_t capture(core::Mode &mode, hostptr_t addr, size_t size);
+
+    /**
+     * Copies aside all the chunks that have not been written yet. It must be
+     * called before accelerators can modify the objects
+     * \param mode Execution mode that is going to modify the objects
+     * \return Error code
+     */
+    gmacError_t captureAll(core::Mode &mode);
+
+    /**
+     * Waits until all the chunks have been written to the file
+     * \return Error code
+     */
+    gmacError_t wait();
+
+    /**
+     * Tells if all the chunks have been read from the objects
+     * \return True if there are no chunks left in the objects
+     */
+    bool captured() const;
+
+    /**
+     * Reads a checkpoint file back into a set of objects. The objects are
+     * invalidated and the data is sent to the accelerator memory
+     * \param mode Execution mode requesting the restore
+     * \param fd File descriptor of the checkpoint file
+     * \param addrs Starting address of the objects to be restored, in the
+     * order they were written. If empty, the addresses recorded in the file
+     * are used
+     * \return Error code
+     */
+    static gmacError_t restore(core::Mode &mode, int fd, const std::vector<hostptr_t> &addrs);
+};
+
+}}
+
+#include "Checkpoint-impl.h"
+
+#endif
@@ -6,6 +6,9 @@
 #include "core/Mode.h"
 #include "core/IOBuffer.h"
 
+#include "memory/AcceleratorCopy.h"
+#include "util/StagingCopy.h"
+
 namespace __impl { namespace memory {
 
 template<typename State>
@@ -45,7 +48,10 @@ GenericBlock<State>::addOwner(core::Mode &mode, accptr_t addr)
 
         if(StateBlock<State>::protocol_.needUpdate(*this) == true &&
            acceleratorAddr_.size() > 1) {
-            gmacError_t ret = mode.copyToAccelerator(addr, StateBlock<State>::shadow_, StateBlock<State>::size_);
+            // Existing copies are up to date even if the host copy is invalid
+            AcceleratorAddrMap::const_iterator src = acceleratorAddr_.begin();
+            if(src->first == addr) ++src;
+            gmacError_t ret = AcceleratorCopy(mode, addr, *src->second.front(), src->first, StateBlock<State>::size_);
             ASSERTION(ret == gmacSuccess);
         }
     } else {
@@ -144,7 +150,7 @@ GenericBlock<State>::acceleratorAddr(core::Mode &current) const
 
 template<typename State>
 inline gmacError_t
-GenericBlock<State>::toHost(unsigned blockOff, size_t count)
+GenericBlock<State>::toHost(size_t blockOff, size_t count)
 {
     gmacError_t ret = gmacSuccess;
 
@@ -153,7 +159,9 @@ GenericBlock<State>::toHost(unsigned blockOff, size_t count)
         ModeMap::const_iterator m;
         m = owners_.begin();
         ret = ownerShortcut_->copyToHost(this->shadow_ + blockOff, m->second + blockOff, count);
-    } else { // TODO Implement this path
+    } else {
+        // Replicated blocks are only written by the host, so the host copy
+        // is still valid
         ret = gmacSuccess;
     }
 
@@ -162,7 +170,7 @@ GenericBlock<State>::toHost(unsigned blockOff, size_t count)
 
 template<typename State>
 inline gmacError_t
-GenericBlock<State>::toAccelerator(unsigned blockOff, size_t count)
+GenericBlock<State>::toAccelerator(size_t blockOff, size_t count)
 {
     gmacError_t ret = gmacSuccess;
 
@@ -172,14 +180,51 @@ GenericBlock<State>::toAccelerator(unsigned blockOff, size_t count)
         m = owners_.begin();
         ret = ownerShortcut_->copyToAccelerator(m->second + blockOff, StateBlock<State>::shadow_ + blockOff, count);
     } else {
-        AcceleratorAddrMap::const_iterator a;
-        for(a = acceleratorAddr_.begin(); a != acceleratorAddr_.end(); a++) {
-            const std::list<core::Mode *> &list = a->second;
-            ASSERTION(list.size() > 0);
-            core::Mode *mode = list.front();
-            ret = mode->copyToAccelerator(a->first + blockOff, StateBlock<State>::shadow_ + blockOff, count);
-            if(ret != gmacSuccess) break;
+        // Send the data from the host once and replicate it between accelerators
+        AcceleratorAddrMap::const_iterator first = acceleratorAddr_.begin();
+        ASSERTION(first->second.size() > 0);
+        core::Mode *mode = first->second.front();
+        ret = mode->copyToAccelerator(first->first + blockOff, StateBlock<State>::shadow_ + blockOff, count);
+        if(ret == gmacSuccess) ret = propagate(first, blockOff, count, StateBlock<State>::shadow_ + blockOff);
+    }
+    return ret;
+}
+
+template<typename State>
+gmacError_t
+GenericBlock<State>::scatterToAccelerator(const size_t *offsets, unsigned count, size_t size)
+{
+    gmacError_t ret = gmacSuccess;
+    AcceleratorAddrMap::const_iterator a;
+    for(a = acceleratorAddr_.begin(); a != acceleratorAddr_.end(); a++) {
+        const std::list<core::Mode *> &list = a->second;
+        ASSERTION(list.size() > 0);
+        ret = list.front()->scatterToAccelerator(a->first, StateBlock<State>::shadow_, offsets, count, size);
+        if(ret != gmacSuccess) break;
+    }
+    return ret;
+}
+
+template<typename State>
+gmacError_t
+GenericBlock<State>::propagate(AcceleratorAddrMap::const_iterator src, size_t blockOff, size_t count, const hostptr_t host) const
+{
+    gmacError_t ret = gmacSuccess;
+    core::Mode &srcMode = *src->second.front();
+    AcceleratorAddrMap::const_iterator a;
+    for(a = acceleratorAddr_.begin(); a != acceleratorAddr_.end(); a++) {
+        if(a == src) continue;
+        const std::list<core::Mode *> &list = a->second;
+        ASSERTION(list.size() > 0);
+        core::Mode *mode = list.front();
+        ret = gmacErrorFeatureNotSupported;
+        if(mode->hasPeerAccess(srcMode) == true) {
+            ret = mode->copyAcceleratorPeer(a->first + blockOff, srcMode, src->first + blockOff, count);
         }
+        if(ret == gmacErrorFeatureNotSupported) {
+            ret = mode->copyToAccelerator(a->first + blockOff, host, count);
+        }
+        if(ret != gmacSuccess) break;
     }
     return ret;
 }
@@ -193,7 +238,7 @@ GenericBlock<State>::copyFromBuffer(size_t blockOff, core::IOBuffer &buffer,
     trace::EnterCurrentFunction();
     switch (dst) {
     case StateBlock<State>::HOST:
-        ::memcpy(StateBlock<State>::shadow_ + blockOff, buffer.addr() + bufferOff, size);
+        util::StagingCopy::fromStaging(StateBlock<State>::shadow_ + blockOff, buffer.addr() + bufferOff, size);
         break;
 
     case StateBlock<State>::ACCELERATOR:
@@ -228,7 +273,7 @@ GenericBlock<State>::copyToBuffer(core::IOBuffer &buffer, size_t bufferOff,
     trace::EnterCurrentFunction();
     switch (src) {
     case StateBlock<State>::HOST:
-        ::memcpy(buffer.addr() + bufferOff, StateBlock<State>::shadow_ + blockOff, size);
+        util::StagingCopy::toStaging(buffer.addr() + bufferOff, StateBlock<State>::shadow_ + blockOff, size);
         break;
     case StateBlock<State>::ACCELERATOR:
         if (owners_.size() == 1) { // Fast path
@@ -236,7 +281,8 @@ GenericBlock<State>::copyToBuffer(core::IOBuffer &buffer, size_t bufferOff,
             m = owners_.begin();
             ret = ownerShortcut_->acceleratorToBuffer(buffer, m->second + ptroff_t(blockOff), size, bufferOff);
         } else {
-            ret = gmacErrorFeatureNotSupported;
+            // Accelerator copies of replicated blocks match the host copy
+            util::StagingCopy::toStaging(buffer.addr() + bufferOff, StateBlock<State>::shadow_ + blockOff, size);
         }
         break;
     }
@@ -265,7 +311,8 @@ GenericBlock<State>::copyFromBlock(size_t dstOff, StateBlock<State> &srcBlock,
             core::Mode &mode = *list.front();
             accptr_t srcPtr = srcBlock.acceleratorAddr(mode) + srcOff;
             if (i->first.pasId_ != srcPtr.pasId_) {
-                ret = mode.copyToAccelerator(i->first + dstOff, srcBlock.getShadow() + srcOff, size);
+                // The source block lives in a different accelerator
+                ret = AcceleratorCopy(mode, i->first + dstOff, srcBlock.owner(mode), srcPtr, size);
             } else {
                 ret = mode.copyAccelerator(i->first + dstOff, srcPtr, size);
             }
@@ -283,13 +330,9 @@ GenericBlock<State>::copyFromBlock(size_t dstOff, StateBlock<State> &srcBlock,
         }
     } else if (src == StateBlock<State>::ACCELERATOR &&
                dst == StateBlock<State>::HOST) {
-        if (owners_.size() == 1) { // Fast path
-            ModeMap::const_iterator m;
-            m = owners_.begin();
-            ret = srcBlock.owner(*ownerShortcut_).copyToHost(this->shadow_ + dstOff, srcBlock.acceleratorAddr(*ownerShortcut_) + srcOff, size);
-        } else {
-            ret = gmacErrorFeatureNotSupported;
-        }
+        // Any owner of the destination can be used to reach the source block
+        core::Mode &mode = (owners_.size() == 1)? *ownerShortcut_: *owners_.begin()->first;
+        ret = srcBlock.owner(mode).copyToHost(this->shadow_ + dstOff, srcBlock.acceleratorAddr(mode) + srcOff, size);
     }
 
     return ret;
@@ -63,6 +63,19 @@ protected:
     ModeMap owners_;
     core::Mode *ownerShortcut_;
 
+    /**
+     * Copy a range of the block from one of its accelerator copies to the
+     * rest of copies. Accelerators without peer access to the source are
+     * updated from host memory
+     *
+     * \param src Accelerator copy that holds the data
+     * \param blockOff Offset (in bytes) of the range within the block
+     * \param count Size (in bytes) of the range
+     * \param host Host memory address that holds the same data
+     * \return Error code
+     */
+    gmacError_t propagate(AcceleratorAddrMap::const_iterator src, size_t blockOff, size_t count, const hostptr_t host) const;
+
 public:
     /**
      * Default construcutor
@@ -102,9 +115,11 @@ public:
      */
     accptr_t acceleratorAddr(core::Mode &current) const;
 
-    gmacError_t toAccelerator(unsigned blockOff, size_t count);
+    gmacError_t toAccelerator(size_t blockOff, size_t count);
+
+    gmacError_t scatterToAccelerator(const size_t *offsets, unsigned count, size_t size);
 
-    gmacError_t toHost(unsigned blockOff, size_t count);
+    gmacError_t toHost(size_t blockOff, size_t count);
 
     gmacError_t copyToBuffer(core::IOBuffer &buffer, size_t bufferOff,
                              size_t blockOff, size_t size, typename StateBlock<State>::Source src) const;
@@ -1,5 +1,6 @@
 #include "core/Mode.h"
 #include "memory/HostMappedObject.h"
+#include "memory/TranslationCache.h"
 #include "util/Logger.h"
 
 namespace __impl { namespace memory {
@@ -38,6 +39,7 @@ bool HostMappedSet::remove(hostptr_t addr)
     bool ret = (i != end()) && (addr == i->second->addr());
     if(ret == true) erase(i);
     unlock();
+    if(ret == true) TranslationCache::invalidate();
     return ret;
 }
 
@@ -68,7 +70,7 @@ accptr_t HostMappedObject::acceleratorAddr(core::Mode &current, const hostptr_t
     //ASSERTION(current == owner_);
     accptr_t ret = accptr_t(0);
     if(addr_ != NULL) {
-        unsigned offset = unsigned(addr - addr_);
+        size_t offset = size_t(addr - addr_);
         accptr_t acceleratorAddr = getAccPtr(current);
         ret = acceleratorAddr + offset;
     }
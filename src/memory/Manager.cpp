@@ -1,13 +1,26 @@
+#if defined(POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "core/IOBuffer.h"
 #include "core/Mode.h"
 #include "core/Process.h"
+#include "core/Thread.h"
 
+#include "memory/Checkpoint.h"
 #include "memory/Handler.h"
 #include "memory/HostMappedObject.h"
 #include "memory/Manager.h"
 #include "memory/Object.h"
+#include "memory/Recorder.h"
+#include "memory/ReleasePool.h"
+#include "memory/TranslationCache.h"
+#include "util/Monitor.h"
+#include "util/StagingCopy.h"
 
 using __impl::util::params::ParamAutoSync;
+using __impl::util::params::ParamOversubscribe;
 
 
 namespace __impl { namespace memory {
@@ -15,7 +28,9 @@ namespace __impl { namespace memory {
 ListAddr AllAddresses;
 
 Manager::Manager(core::Process &proc) :
-    proc_(proc)
+    gmac::util::RWLock("Manager"),
+    proc_(proc),
+    checkpoint_(NULL)
 {
     TRACE(LOCAL,"Memory manager starts");
     Init();
@@ -24,6 +39,23 @@ Manager::Manager(core::Process &proc) :
 
 Manager::~Manager()
 {
+    // Let the last checkpoint reach its file
+    if(checkpoint_ != NULL) delete checkpoint_;
+    ReleasePool::destroy();
+    util::StagingCopy::destroy();
+}
+
+void
+Manager::capture(core::Mode &mode, hostptr_t addr, size_t size)
+{
+    // Avoid taking the lock if no checkpoint has been started
+    if(checkpoint_ == NULL) return;
+    lockRead();
+    if(checkpoint_ != NULL && checkpoint_->captured() == false) {
+        gmacError_t ret = checkpoint_->capture(mode, addr, size);
+        ASSERTION(ret == gmacSuccess);
+    }
+    unlock();
 }
 
 gmacError_t
@@ -115,7 +147,7 @@ Manager::unmap(core::Mode &mode, hostptr_t addr, size_t size)
     return ret;
 }
 
-gmacError_t Manager::alloc(core::Mode &mode, hostptr_t *addr, size_t size)
+gmacError_t Manager::alloc(core::Mode &mode, hostptr_t *addr, size_t size, size_t blockSize)
 {
     TRACE(LOCAL, "New allocation");
     trace::EnterCurrentFunction();
@@ -131,7 +163,7 @@ gmacError_t Manager::alloc(core::Mode &mode, hostptr_t *addr, size_t size)
 
     // Create new shared object. We set the memory as invalid to avoid stupid data transfers
     // to non-initialized objects
-    Object *object = map.getProtocol().createObject(mode, size, NULL, GMAC_PROT_READ, 0);
+    Object *object = map.getProtocol().createObject(mode, size, NULL, GMAC_PROT_READ, 0, blockSize);
     if(object == NULL) {
         trace::ExitCurrentFunction();
         return gmacErrorMemoryAllocation;
@@ -142,6 +174,9 @@ gmacError_t Manager::alloc(core::Mode &mode, hostptr_t *addr, size_t size)
         Memory::protect(*addr, size, GMAC_PROT_READ);
         // Insert object into memory maps
         map.addObject(*object);
+        if (ParamOversubscribe) map.insertResident(*object);
+        Recorder::record(GMAC_RECORD_ALLOC, mode.getId(), *addr, size, GMAC_PROT_READ);
+        Recorder::record(GMAC_RECORD_BLOCKSIZE, mode.getId(), *addr, object->blockSize());
     }
     object->decRef();
     trace::ExitCurrentFunction();
@@ -186,6 +221,10 @@ gmacError_t Manager::globalAlloc(core::Mode &mode, hostptr_t *addr, size_t size,
         return hostMappedAlloc(mode, addr, size); // Try using a host mapped object
     }
     gmacError_t ret = proc_.globalMalloc(*object);
+    if(ret == gmacSuccess) {
+        Recorder::record(GMAC_RECORD_ALLOC, mode.getId(), *addr, size, GMAC_PROT_NONE);
+        Recorder::record(GMAC_RECORD_BLOCKSIZE, mode.getId(), *addr, object->blockSize());
+    }
     object->decRef();
     trace::ExitCurrentFunction();
     return ret;
@@ -201,6 +240,7 @@ gmacError_t Manager::free(core::Mode &mode, hostptr_t addr)
 
     Object *object = map.getObject(addr);
     if(object != NULL)  {
+        Recorder::record(GMAC_RECORD_FREE, mode.getId(), addr);
         map.removeObject(*object);
         object->decRef();
     } else {
@@ -218,6 +258,66 @@ gmacError_t Manager::free(core::Mode &mode, hostptr_t addr)
     return ret;
 }
 
+gmacError_t Manager::mapFile(core::Mode &mode, hostptr_t *addr, size_t size, int fd, off_t offset,
+                             GmacProtection prot)
+{
+    TRACE(LOCAL, "New file allocation");
+#if defined(POSIX)
+    trace::EnterCurrentFunction();
+    memory::ObjectMap &map = mode.getAddressSpace();
+
+    // The object keeps its own descriptor, so the caller can close the file
+    int objectFd = ::dup(fd);
+    if(objectFd < 0) {
+        trace::ExitCurrentFunction();
+        return gmacErrorInvalidValue;
+    }
+
+    // Small files still take a whole page, but only the requested bytes are
+    // read from and written back to the file
+    size_t objectSize = (size < size_t(getpagesize()))? getpagesize(): size;
+    Object *object = map.getProtocol().createObject(mode, objectSize, *addr, GMAC_PROT_READ, 0);
+    if(object == NULL) {
+        ::close(objectFd);
+        trace::ExitCurrentFunction();
+        return gmacErrorMemoryAllocation;
+    }
+    gmacError_t ret = object->addOwner(mode);
+    bool writeBack = (prot == GMAC_PROT_WRITE || prot == GMAC_PROT_READWRITE);
+    if(ret == gmacSuccess) ret = object->mapFile(objectFd, offset, size, writeBack);
+    else ::close(objectFd);
+    if(ret == gmacSuccess) {
+        *addr = object->addr();
+        // File objects are not evicted, because their blocks might not have
+        // been read from the file yet
+        map.addObject(*object);
+    }
+    object->decRef();
+    trace::ExitCurrentFunction();
+    return ret;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+gmacError_t Manager::unmapFile(core::Mode &mode, hostptr_t addr)
+{
+    TRACE(LOCAL, "Free file allocation");
+    trace::EnterCurrentFunction();
+    memory::ObjectMap &map = mode.getAddressSpace();
+    Object *object = map.getObject(addr);
+    if(object == NULL || object->addr() != addr || object->isFileMapped() == false) {
+        if(object != NULL) object->decRef();
+        trace::ExitCurrentFunction();
+        return gmacErrorInvalidValue;
+    }
+    gmacError_t ret = object->writeFile();
+    map.removeObject(*object);
+    object->decRef();
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
 gmacError_t
 Manager::getAllocSize(core::Mode &mode, const hostptr_t addr, size_t &size) const
 {
@@ -248,14 +348,36 @@ accptr_t
 Manager::translate(core::Mode &mode, const hostptr_t addr)
 {
     trace::EnterCurrentFunction();
-    accptr_t ret = proc_.translate(addr);
-    if(ret == 0) {
-        HostMappedObject *object = HostMappedObject::get(addr);
-        if(object != NULL) {
-            ret = object->acceleratorAddr(mode, addr);
-            object->decRef();
+    accptr_t ret = accptr_t(0);
+    TranslationCache &cache = core::Thread::getTranslationCache();
+    if(cache.lookup(mode, addr, ret) == true) {
+        trace::ExitCurrentFunction();
+        return ret;
+    }
+
+    // Objects removed or remapped after this point do not get cached
+    unsigned generation = TranslationCache::generation();
+    hostptr_t start = NULL;
+    size_t size = 0;
+    Object *object = mode.getAddressSpace().getObject(addr);
+    if(object != NULL) {
+        start = object->addr();
+        size = object->size();
+        ret = object->acceleratorAddr(mode, start);
+        object->decRef();
+    } else {
+        HostMappedObject *hostMappedObject = HostMappedObject::get(addr);
+        if(hostMappedObject != NULL) {
+            start = hostMappedObject->addr();
+            size = hostMappedObject->size();
+            ret = hostMappedObject->acceleratorAddr(mode, start);
+            hostMappedObject->decRef();
         }
     }
+    if(ret != 0) {
+        cache.insert(mode, start, size, ret, generation);
+        ret = ret + ptroff_t(addr - start);
+    }
     trace::ExitCurrentFunction();
     return ret;
 }
@@ -265,12 +387,15 @@ Manager::acquireObjects(core::Mode &mode, const ListAddr &addrs)
 {
     trace::EnterCurrentFunction();
     gmacError_t ret = gmacSuccess;
+    util::MonitorMode *monitor = mode.monitor();
+    uint64_t start = (monitor != NULL)? util::Monitor::now(): 0;
 
     memory::ObjectMap &map = mode.getAddressSpace();
     if (addrs.size() == 0) {
         if (map.hasModifiedObjects() && map.releasedObjects()) {
             TRACE(LOCAL,"Acquiring Objects");
             GmacProtection prot = GMAC_PROT_READWRITE;
+            Recorder::record(GMAC_RECORD_ACQUIRE, mode.getId(), NULL, 0, prot);
             ret = map.forEachObject<GmacProtection>(&Object::acquire, prot);
             map.acquireObjects();
         }
@@ -288,12 +413,18 @@ Manager::acquireObjects(core::Mode &mode, const ListAddr &addrs)
                 hostMappedObject->decRef();
             } else {
                 GmacProtection prot = it->second;
+                Recorder::record(GMAC_RECORD_ACQUIRE, mode.getId(), it->first, 0, prot);
                 ret = obj->acquire(prot);
                 ASSERTION(ret == gmacSuccess);
                 obj->decRef();
             }
         }
     }
+    if (monitor != NULL) {
+        util::Monitor::add(monitor->acquires_, 1);
+        util::Monitor::add(monitor->acquireTime_, util::Monitor::now() - start);
+        util::Monitor::set(monitor->dirtyBlocks_, map.getProtocol().dirtyBlocks());
+    }
     trace::ExitCurrentFunction();
     return ret;
 }
@@ -303,11 +434,24 @@ Manager::releaseObjects(core::Mode &mode, const ListAddr &addrs)
 {
     trace::EnterCurrentFunction();
     gmacError_t ret = gmacSuccess;
+    util::MonitorMode *monitor = mode.monitor();
+    uint64_t start = (monitor != NULL)? util::Monitor::now(): 0;
+
+    // Accelerators might modify the objects of the checkpoint in progress
+    if (checkpoint_ != NULL) {
+        lockRead();
+        if (checkpoint_ != NULL && checkpoint_->captured() == false) {
+            ret = checkpoint_->captureAll(mode);
+            ASSERTION(ret == gmacSuccess);
+        }
+        unlock();
+    }
 
     memory::ObjectMap &map = mode.getAddressSpace();
     if (addrs.size() == 0) { // Release all objects
         TRACE(LOCAL,"Releasing Objects");
         if (map.hasModifiedObjects()) {
+            Recorder::record(GMAC_RECORD_RELEASE, mode.getId(), NULL);
             // Mark objects as released
             ret = map.forEachObject(&Object::release);
             ASSERTION(ret == gmacSuccess);
@@ -336,6 +480,7 @@ Manager::releaseObjects(core::Mode &mode, const ListAddr &addrs)
                 hostMappedObject->decRef();
             } else {
                 // Release all the blocks in the object
+                Recorder::record(GMAC_RECORD_RELEASE, mode.getId(), it->first);
                 ret = obj->releaseBlocks();
                 ASSERTION(ret == gmacSuccess);
                 obj->decRef();
@@ -353,6 +498,53 @@ Manager::releaseObjects(core::Mode &mode, const ListAddr &addrs)
         }
         map.releaseObjects();
     }
+    if (monitor != NULL) {
+        util::Monitor::add(monitor->releases_, 1);
+        util::Monitor::add(monitor->releaseTime_, util::Monitor::now() - start);
+        util::Monitor::set(monitor->dirtyBlocks_, map.getProtocol().dirtyBlocks());
+    }
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
+gmacError_t
+Manager::useObjects(core::Mode &mode, const ListAddr &addrs)
+{
+    trace::EnterCurrentFunction();
+    memory::ObjectMap &map = mode.getAddressSpace();
+    std::vector<Object *> objects;
+    ListAddr::const_iterator it;
+    for (it = addrs.begin(); it != addrs.end(); ++it) {
+        Object *obj = map.getObject(it->first);
+        // Host mapped objects do not use accelerator memory
+        if (obj != NULL) objects.push_back(obj);
+    }
+
+    gmacError_t ret = map.useObjects(objects);
+
+    std::vector<Object *>::const_iterator i;
+    for (i = objects.begin(); i != objects.end(); ++i) (*i)->decRef();
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
+gmacError_t
+Manager::evictObjects(core::Mode &mode, size_t size, const ListAddr &addrs)
+{
+    trace::EnterCurrentFunction();
+    memory::ObjectMap &map = mode.getAddressSpace();
+    std::vector<Object *> keep;
+    ListAddr::const_iterator it;
+    for (it = addrs.begin(); it != addrs.end(); ++it) {
+        Object *obj = map.getObject(it->first);
+        if (obj != NULL) keep.push_back(obj);
+    }
+
+    TRACE(LOCAL, "Evicting objects to release "FMT_SIZE" bytes", size);
+    gmacError_t ret = map.evictObjects(size, keep);
+
+    std::vector<Object *>::const_iterator i;
+    for (i = keep.begin(); i != keep.end(); ++i) (*i)->decRef();
     trace::ExitCurrentFunction();
     return ret;
 }
@@ -408,6 +600,7 @@ gmacError_t Manager::fromIOBuffer(core::Mode &mode, hostptr_t addr, core::IOBuff
 {
     if (count > (buffer.size() - bufferOff)) return gmacErrorInvalidSize;
     trace::EnterCurrentFunction();
+    capture(mode, addr, count);
     gmacError_t ret = gmacSuccess;
     size_t off = 0;
     do {
@@ -470,6 +663,8 @@ Manager::signalRead(core::Mode &mode, hostptr_t addr)
         return false;
     }
     TRACE(LOCAL,"Read access for object %p: %p", obj->addr(), addr);
+    Recorder::record(GMAC_RECORD_READ, mode.getId(), addr);
+    if(mode.monitor() != NULL) util::Monitor::add(mode.monitor()->faultsRead_, 1);
     gmacError_t err = obj->signalRead(addr);
     ASSERTION(err == gmacSuccess);
     obj->decRef();
@@ -499,8 +694,14 @@ Manager::signalWrite(core::Mode &mode, hostptr_t addr)
         return false;
     }
     TRACE(LOCAL,"Write access for object %p: %p", obj->addr(), addr);
+    Recorder::record(GMAC_RECORD_WRITE, mode.getId(), addr);
+    capture(mode, addr, 1);
     if(obj->signalWrite(addr) != gmacSuccess) ret = false;
     obj->decRef();
+    if(mode.monitor() != NULL) {
+        util::Monitor::add(mode.monitor()->faultsWrite_, 1);
+        util::Monitor::set(mode.monitor()->dirtyBlocks_, map.getProtocol().dirtyBlocks());
+    }
     trace::ExitCurrentFunction();
     return ret;
 }
@@ -526,6 +727,7 @@ Manager::memset(core::Mode &mode, hostptr_t s, int c, size_t size)
 #endif
 
     gmacError_t ret = gmacSuccess;
+    capture(mode, s, size);
 
     memory::ObjectMap &map = owner->getAddressSpace();
     Object *obj = map.getObject(s);
@@ -551,7 +753,7 @@ Manager::memset(core::Mode &mode, hostptr_t s, int c, size_t size)
         } else {
             // Check if there is a memory gap of host memory at the begining of the
             // memory range that remains to be initialized
-            int gap = int(obj->addr() - s);
+            ssize_t gap = ssize_t(obj->addr() - s);
             if(gap > 0) { // If there is gap, initialize and advance the pointer
                 ::memset(s, c, gap);
                 left -= gap;
@@ -615,6 +817,8 @@ Manager::memcpy(core::Mode &mode, hostptr_t dst, const hostptr_t src,
         return gmacSuccess;
     }
 
+    if(dstMode != NULL) capture(mode, dst, size);
+
     Object *dstObject = NULL;
     Object *srcObject = NULL;
 
@@ -727,4 +931,146 @@ gmacError_t Manager::moveTo(hostptr_t addr, core::Mode &mode)
     return gmacSuccess;
 }
 #endif
+
+gmacError_t
+Manager::checkpoint(core::Mode &mode, const char *path, const hostptr_t *addrs, size_t count)
+{
+#if defined(POSIX)
+    trace::EnterCurrentFunction();
+    // Only one checkpoint is written at a time
+    checkpointWait();
+
+    gmacError_t ret = gmacSuccess;
+    std::vector<Object *> objects;
+    memory::ObjectMap &map = mode.getAddressSpace();
+    if(addrs == NULL) map.getObjects(objects);
+    for(size_t n = 0; addrs != NULL && n < count; n++) {
+        Object *obj = map.getObject(addrs[n]);
+        if(obj == NULL) {
+            ret = gmacErrorInvalidValue;
+            break;
+        }
+        objects.push_back(obj);
+        if(obj->addr() != addrs[n]) {
+            ret = gmacErrorInvalidValue;
+            break;
+        }
+    }
+
+    int fd = -1;
+    if(ret == gmacSuccess) {
+        fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0) ret = gmacErrorInvalidValue;
+    }
+    if(ret != gmacSuccess) {
+        std::vector<Object *>::iterator i;
+        for(i = objects.begin(); i != objects.end(); ++i) (*i)->decRef();
+        trace::ExitCurrentFunction();
+        return ret;
+    }
+
+    // Writes must not be signaled to the checkpoint before the snapshot is taken
+    lockWrite();
+    Checkpoint *checkpoint = new Checkpoint(mode, fd, objects);
+    ret = checkpoint->start();
+    if(ret == gmacSuccess) checkpoint_ = checkpoint;
+    else delete checkpoint;
+    unlock();
+    trace::ExitCurrentFunction();
+    return ret;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+gmacError_t
+Manager::checkpointWait()
+{
+    if(checkpoint_ == NULL) return gmacSuccess;
+    lockRead();
+    Checkpoint *checkpoint = checkpoint_;
+    gmacError_t ret = gmacSuccess;
+    if(checkpoint != NULL) ret = checkpoint->wait();
+    unlock();
+
+    // Finished checkpoints do not need to be checked on every write
+    lockWrite();
+    if(checkpoint_ == checkpoint) {
+        delete checkpoint_;
+        checkpoint_ = NULL;
+    }
+    unlock();
+    return ret;
+}
+
+gmacError_t
+Manager::restore(core::Mode &mode, const char *path, const hostptr_t *addrs, size_t count)
+{
+#if defined(POSIX)
+    trace::EnterCurrentFunction();
+    // The checkpoint in progress might include the objects being restored
+    checkpointWait();
+
+    gmacError_t ret = gmacSuccess;
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0) ret = gmacErrorInvalidValue;
+    else {
+        std::vector<hostptr_t> objects;
+        if(addrs != NULL) objects.assign(addrs, addrs + count);
+        ret = Checkpoint::restore(mode, fd, objects);
+        ::close(fd);
+    }
+    trace::ExitCurrentFunction();
+    return ret;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+template <typename T>
+static gmacError_t
+rangeOp(core::Process &proc, hostptr_t addr, size_t size,
+        gmacError_t (Object::*op)(size_t, size_t, T), T param)
+{
+    core::Mode *owner = proc.owner(addr, size);
+    if(owner == NULL) return gmacErrorInvalidValue;
+
+    gmacError_t ret = gmacSuccess;
+    memory::ObjectMap &map = owner->getAddressSpace();
+    hostptr_t end = addr + size;
+    // The range might span several objects
+    Object *obj = map.getObject(addr, size);
+    while(obj != NULL && ret == gmacSuccess) {
+        hostptr_t start = (obj->addr() > addr)? obj->addr(): addr;
+        hostptr_t stop = (obj->end() < end)? obj->end(): end;
+        if(start < stop) ret = (obj->*op)(size_t(start - obj->addr()), size_t(stop - start), param);
+        hostptr_t next = obj->end();
+        obj->decRef();
+        if(next >= end) break;
+        obj = map.getObject(next, size_t(end - next));
+    }
+    return ret;
+}
+
+gmacError_t
+Manager::prefetch(core::Mode &mode, hostptr_t addr, size_t size, GmacPrefetchDestination dst)
+{
+    trace::EnterCurrentFunction();
+    TRACE(LOCAL, "Prefetching %p ("FMT_SIZE" bytes) to the %s", addr, size,
+          dst == GMAC_PREFETCH_HOST? "host": "accelerator");
+    gmacError_t ret = rangeOp(proc_, addr, size, &Object::prefetch, dst);
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
+gmacError_t
+Manager::memAdvise(core::Mode &mode, hostptr_t addr, size_t size, GmacMemAdvice advice)
+{
+    trace::EnterCurrentFunction();
+    TRACE(LOCAL, "Advice %d for %p ("FMT_SIZE" bytes)", int(advice), addr, size);
+    gmacError_t ret = rangeOp(proc_, addr, size, &Object::memAdvise, advice);
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
 }}
@@ -36,6 +36,7 @@ WITH THE SOFTWARE.  */
 
 #include "config/common.h"
 #include "include/gmac/types.h"
+#include "util/Lock.h"
 #include "util/Singleton.h"
 
 namespace __impl {
@@ -48,6 +49,7 @@ class IOBuffer;
 
 namespace memory {
 
+class Checkpoint;
 class Object;
 class Protocol;
 
@@ -58,12 +60,26 @@ extern ListAddr AllAddresses;
 //! Memory Manager Interface
 
 //! Memory Managers orchestate the data transfers between host and accelerator memories
-class GMAC_LOCAL Manager : public __impl::util::Singleton<gmac::memory::Manager> {
+class GMAC_LOCAL Manager : public __impl::util::Singleton<gmac::memory::Manager>,
+                           protected gmac::util::RWLock {
+    // Lock protects the checkpoint in progress
     DBC_FORCE_TEST(Manager)
 protected:
     /** Process where the memory manager is being used */
     core::Process &proc_;
 
+    /** Last checkpoint started, or NULL if there is none */
+    Checkpoint *checkpoint_;
+
+    /**
+     * Copies aside the data of the checkpoint in progress within a memory
+     * range. It must be called before the range is modified
+     * \param mode Execution mode that is going to modify the range
+     * \param addr Starting address of the memory range
+     * \param size Size (in bytes) of the memory range
+     */
+    void capture(core::Mode &mode, hostptr_t addr, size_t size);
+
     /**
      * Allocates a host mapped memory
      * \param mode Execution mode requesting the allocation
@@ -124,9 +140,11 @@ public:
      * \param addr Memory address of a pointer to store the host address of the
      * allocated memory
      * \param size Size (in bytes) of shared memory to be allocated
+     * \param blockSize Size (in bytes) of the blocks of the allocation. 0
+     * lets the run-time choose the block size
      * \return Error code
      */
-    TESTABLE gmacError_t alloc(core::Mode &mode, hostptr_t *addr, size_t size);
+    TESTABLE gmacError_t alloc(core::Mode &mode, hostptr_t *addr, size_t size, size_t blockSize = 0);
 
     /**
      * Allocate public shared read-only memory.
@@ -149,6 +167,30 @@ public:
      */
     TESTABLE gmacError_t free(core::Mode &mode, hostptr_t addr);
 
+    /**
+     * Allocates shared memory whose contents come from a file. Each block is
+     * read from the file the first time the host or the accelerator uses it
+     * \param mode Execution mode where to allocate memory
+     * \param addr Memory address to be used by the allocation, or NULL to let
+     * the library choose. On return it contains the address of the allocation
+     * \param size Size (in bytes) of shared memory to be allocated
+     * \param fd Descriptor of the file. It can be closed after the call
+     * \param offset Offset (in bytes) within the file of the allocation contents
+     * \param prot Access to the file. Allocations mapped for writing are
+     * written back to the file when they are released with unmapFile
+     * \return Error code
+     */
+    gmacError_t mapFile(core::Mode &mode, hostptr_t *addr, size_t size, int fd, off_t offset,
+                        GmacProtection prot);
+
+    /**
+     * Releases shared memory allocated with mapFile
+     * \param mode Execution mode where to release the memory
+     * \param addr Memory address of the allocation
+     * \return Error code
+     */
+    gmacError_t unmapFile(core::Mode &mode, hostptr_t addr);
+
     /** Get the accelerator address associated to a shared memory address
      * \param mode Execution mode requesting the translation
      * \param addr Host shared memory address
@@ -175,6 +217,27 @@ public:
      */
     gmacError_t releaseObjects(core::Mode &mode, const ListAddr &addrs = AllAddresses);
 
+    /**
+     * Marks the objects used by a kernel as the most recently used ones, and
+     * maps back to accelerator memory the objects that have been evicted
+     * \param mode Execution mode launching the kernel
+     * \param addrs List of addresses used by the kernel
+     * \return Error code. gmacErrorMemoryAllocation if there is not enough
+     * accelerator memory to map back the objects
+     */
+    gmacError_t useObjects(core::Mode &mode, const ListAddr &addrs);
+
+    /**
+     * Evicts the least recently used objects of an execution mode to host
+     * memory. Kernels using the objects must have finished
+     * \param mode Execution mode whose objects are evicted
+     * \param size Accelerator memory (in bytes) to be released
+     * \param addrs List of addresses that cannot be evicted
+     * \return Error code. gmacErrorMemoryAllocation if no object can be
+     * evicted
+     */
+    gmacError_t evictObjects(core::Mode &mode, size_t size, const ListAddr &addrs = AllAddresses);
+
     /**
      * Notify a memory fault caused by a load operation
      * \param mode Execution mode causing the fault
@@ -239,6 +302,56 @@ public:
     TESTABLE gmacError_t memcpy(core::Mode &mode, hostptr_t dst, const hostptr_t src, size_t size);
 
     gmacError_t flushDirty(core::Mode &mode);
+
+    /**
+     * Takes a snapshot of a set of objects and writes it to a file in the
+     * background. Objects modified before being written are copied aside
+     * \param mode Execution mode requesting the checkpoint
+     * \param path Path of the checkpoint file
+     * \param addrs Starting address of the objects, or NULL for all the
+     * objects of the execution mode
+     * \param count Number of objects in addrs
+     * \return Error code
+     */
+    gmacError_t checkpoint(core::Mode &mode, const char *path, const hostptr_t *addrs, size_t count);
+
+    /**
+     * Waits until the last checkpoint has been written to its file
+     * \return Error code produced while writing the checkpoint
+     */
+    gmacError_t checkpointWait();
+
+    /**
+     * Reads a checkpoint file back into a set of objects
+     * \param mode Execution mode requesting the restore
+     * \param path Path of the checkpoint file
+     * \param addrs Starting address of the objects, in the order they were
+     * checkpointed, or NULL to use the addresses recorded in the file
+     * \param count Number of objects in addrs
+     * \return Error code
+     */
+    gmacError_t restore(core::Mode &mode, const char *path, const hostptr_t *addrs, size_t count);
+
+    /**
+     * Starts moving a shared memory range to the host or to the accelerator
+     * memory. The call does not wait for the transfers
+     * \param mode Execution mode requesting the prefetch
+     * \param addr Starting host address of the memory range
+     * \param size Size (in bytes) of the memory range
+     * \param dst Memory the range is moved to
+     * \return Error code
+     */
+    gmacError_t prefetch(core::Mode &mode, hostptr_t addr, size_t size, GmacPrefetchDestination dst);
+
+    /**
+     * Sets the expected access pattern of a shared memory range
+     * \param mode Execution mode giving the advice
+     * \param addr Starting host address of the memory range
+     * \param size Size (in bytes) of the memory range
+     * \param advice Expected access pattern
+     * \return Error code
+     */
+    gmacError_t memAdvise(core::Mode &mode, hostptr_t addr, size_t size, GmacMemAdvice advice);
 };
 
 }}
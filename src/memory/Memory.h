@@ -112,7 +112,8 @@ GetSubBlockIndex(const hostptr_t _start, const hostptr_t _addr)
     long_t start = long_t(_start);
     long_t addr = long_t(_addr);
     long_t off = addr - start;
-    return (off >> SubBlockShift_) & SubBlockMask_;
+    // Blocks might be larger than BlockSize_, so the index is not masked
+    return off >> SubBlockShift_;
 }
 
 static inline
@@ -11,12 +11,27 @@
 
 namespace __impl { namespace memory {
 
-inline Object::Object(hostptr_t addr, size_t size) :
+inline Object::Object(hostptr_t addr, size_t size, size_t blockSize) :
     gmac::util::RWLock("Object"),
     util::Reference("Object"),
     addr_(addr),
     size_(size),
-    released_(false)
+#ifdef USE_VM
+    // The bitmap assumes the same block size for all objects
+    blockSize_(BlockSize_),
+    fixedBlockSize_(true),
+#else
+    blockSize_(blockSize == 0? defaultBlockSize(size): blockSize),
+    fixedBlockSize_(blockSize != 0),
+#endif
+    faults_(0),
+    released_(false),
+    epoch_(0),
+    advised_(false),
+    fileFd_(-1),
+    fileOffset_(0),
+    fileSize_(0),
+    fileWriteBack_(false)
 {
 #ifdef DEBUG
     id_ = AtomicInc(Object::Id_);
@@ -45,6 +60,12 @@ Object::addr() const
     return addr_;
 }
 
+inline bool
+Object::isFileMapped() const
+{
+    return fileFd_ >= 0;
+}
+
 inline hostptr_t
 Object::end() const
 {
@@ -70,7 +91,7 @@ Object::blockEnd(size_t offset) const
 inline size_t
 Object::blockSize() const
 {
-    return BlockSize_;
+    return blockSize_;
 }
 
 inline size_t
@@ -98,9 +119,27 @@ Object::acquire(GmacProtection &prot)
     lockWrite();
     gmacError_t ret = gmacSuccess;
     TRACE(LOCAL, "Acquiring object %p?", addr_);
-    if (released_ == true) {
+    // Objects the accelerator could not write keep a valid host copy
+    if (released_ == true &&
+        (prot == GMAC_PROT_WRITE || prot == GMAC_PROT_READWRITE)) {
         TRACE(LOCAL, "Acquiring object %p", addr_);
+#ifdef USE_VM
         ret = coherenceOp<GmacProtection>(&Protocol::acquire, prot);
+#else
+        size_t blockSize = adaptBlockSize();
+        if (blocks_.empty() == false && blockSize != blockSize_) {
+            // Blocks are replaced, so the acquire cannot be deferred
+            ret = coherenceOp<GmacProtection>(&Protocol::acquire, prot);
+            if (ret == gmacSuccess) ret = resizeBlocks(blockSize);
+        } else if (blocks_.empty() == false) {
+            // Blocks apply the acquire lazily on their next access
+            Protocol &protocol = blocks_.begin()->second->getProtocol();
+            ret = protocol.acquireObject(*this, prot);
+            if (ret == gmacSuccess) AtomicInc(epoch_);
+        }
+        faults_ = 0;
+#endif
+        if (ret == gmacSuccess && advised_ == true) ret = refreshHost();
     }
     released_ = false;
     unlock();
@@ -174,6 +213,22 @@ inline gmacError_t Object::toAccelerator()
     return ret;
 }
 
+inline gmacError_t Object::invalidate()
+{
+    lockRead();
+    gmacError_t ret = coherenceOp(&Protocol::invalidate);
+    unlock();
+    return ret;
+}
+
+inline gmacError_t Object::writeProtect()
+{
+    lockRead();
+    gmacError_t ret = coherenceOp(&Protocol::writeProtect);
+    unlock();
+    return ret;
+}
+
 inline gmacError_t
 Object::copyToBuffer(core::IOBuffer &buffer, size_t size,
                      size_t bufferOffset, size_t objectOffset)
@@ -1,9 +1,15 @@
+#if defined(POSIX)
+#include <unistd.h>
+#endif
+
 #include "config/config.h"
 #include "core/IOBuffer.h"
 #include "core/Mode.h"
 
 #include "Object.h"
 #include "memory/Memory.h"
+#include "util/Parameter.h"
+#include "util/StagingCopy.h"
 
 namespace __impl { namespace memory {
 
@@ -22,22 +28,60 @@ Object::~Object()
     }
     blocks_.clear();
     unlock();
+#if defined(POSIX)
+    if(fileFd_ >= 0) ::close(fileFd_);
+#endif
 }
 
 Object::BlockMap::const_iterator
 Object::firstBlock(size_t objectOffset, size_t &blockOffset) const
 {
-    BlockMap::const_iterator i = blocks_.begin();
+    // Blocks are indexed by their end address, so the lookup does not depend
+    // on the size of the blocks
+    BlockMap::const_iterator i = blocks_.upper_bound(addr_ + objectOffset);
     if(i == blocks_.end()) return i;
-    while(objectOffset >= i->second->size()) {
-        objectOffset -= i->second->size();
-        ++i;
-        if(i == blocks_.end()) return i;
-    }
-    blockOffset = objectOffset;
+    blockOffset = size_t(addr_ + objectOffset - i->second->addr());
     return i;
 }
 
+size_t
+Object::defaultBlockSize(size_t size)
+{
+    if(util::params::ParamAdaptiveBlockSize == false) return BlockSize_;
+    size_t blockSize = size / util::params::ParamBlocksPerObject;
+    if(blockSize < util::params::ParamBlockSizeMin) blockSize = util::params::ParamBlockSizeMin;
+    if(blockSize > util::params::ParamBlockSizeMax) blockSize = util::params::ParamBlockSizeMax;
+    // Blocks must contain a power of two number of whole sub-blocks
+    size_t ret = util::params::ParamSubBlockSize;
+    while(ret < blockSize) ret <<= 1;
+    return ret;
+}
+
+size_t
+Object::adaptBlockSize() const
+{
+    if(util::params::ParamAdaptiveBlockSize == false || fixedBlockSize_ == true) return blockSize_;
+    if(blocks_.empty() == true) return blockSize_;
+    unsigned faults = unsigned(faults_);
+    // Objects the host does not touch keep their blocks
+    if(faults == 0) return blockSize_;
+    float ratio = float(faults) / float(blocks_.size());
+    size_t ret = blockSize_;
+    if(ratio >= util::params::ParamBlockGrowRatio) {
+        // Most blocks are touched, so fewer and larger blocks save faults
+        if(ret < util::params::ParamBlockSizeMax && ret < size_) ret <<= 1;
+    }
+    else if(ratio <= util::params::ParamBlockShrinkRatio) {
+        // Few blocks are touched, so smaller blocks save transfers
+        if((ret >> 1) >= util::params::ParamBlockSizeMin &&
+           (ret >> 1) >= util::params::ParamSubBlockSize) ret >>= 1;
+    }
+    if(ret != blockSize_)
+        TRACE(LOCAL, "Object %p: %u faults in "FMT_SIZE" blocks, block size "FMT_SIZE" -> "FMT_SIZE,
+              addr_, faults, blocks_.size(), blockSize_, ret);
+    return ret;
+}
+
 gmacError_t Object::coherenceOp(gmacError_t (Protocol::*f)(Block &))
 {
     gmacError_t ret = gmacSuccess;
@@ -82,6 +126,155 @@ gmacError_t Object::memset(size_t offset, int v, size_t size)
         blockOffset = 0;
         size -= blockSize;
     }
+    // Protocols might defer the fill until the next release
+    modifiedObject();
+    return ret;
+}
+
+gmacError_t Object::prefetch(size_t offset, size_t count, GmacPrefetchDestination dst)
+{
+    gmacError_t ret = gmacSuccess;
+    size_t blockOffset = 0;
+    lockRead();
+    BlockMap::const_iterator i = firstBlock(offset, blockOffset);
+    for(; i != blocks_.end() && count > 0; ++i) {
+        Block &block = *i->second;
+        size_t blockSize = block.size() - blockOffset;
+        blockSize = count < blockSize? count: blockSize;
+        ret = block.coherenceOp(&Protocol::prefetch, dst);
+        if(ret != gmacSuccess) break;
+        blockOffset = 0;
+        count -= blockSize;
+    }
+    unlock();
+    return ret;
+}
+
+gmacError_t Object::memAdvise(size_t offset, size_t count, GmacMemAdvice advice)
+{
+    size_t blockOffset = 0;
+    lockWrite();
+    BlockMap::const_iterator i = firstBlock(offset, blockOffset);
+    for(; i != blocks_.end() && count > 0; ++i) {
+        Block &block = *i->second;
+        size_t blockSize = block.size() - blockOffset;
+        blockSize = count < blockSize? count: blockSize;
+        block.setAdvice(advice);
+        blockOffset = 0;
+        count -= blockSize;
+    }
+    if(advice != GMAC_ADVICE_NONE) advised_ = true;
+    unlock();
+    return gmacSuccess;
+}
+
+FileMapping Object::fileMapping(const Block &block) const
+{
+    size_t offset = size_t(block.addr() - addr_);
+    FileMapping mapping = { fileFd_, fileOffset_ + off_t(offset), 0 };
+    if(offset < fileSize_) {
+        size_t left = fileSize_ - offset;
+        mapping.size_ = (left < block.size())? left: block.size();
+    }
+    return mapping;
+}
+
+gmacError_t Object::mapFile(int fd, off_t offset, size_t size, bool writeBack)
+{
+    gmacError_t ret = gmacSuccess;
+    lockWrite();
+    // Blocks pending the file contents cannot be replaced
+    fixedBlockSize_ = true;
+    fileFd_ = fd;
+    fileOffset_ = offset;
+    fileSize_ = size;
+    fileWriteBack_ = writeBack;
+    BlockMap::const_iterator i;
+    for(i = blocks_.begin(); i != blocks_.end(); ++i) {
+        Block &block = *i->second;
+        FileMapping mapping = fileMapping(block);
+        ret = block.coherenceOp(&Protocol::mapFile, mapping);
+        if(ret != gmacSuccess) break;
+    }
+    unlock();
+    // The file is read into the accelerator on the next release
+    modifiedObject();
+    return ret;
+}
+
+gmacError_t Object::writeFile()
+{
+    if(fileFd_ < 0) return gmacErrorInvalidValue;
+    if(fileWriteBack_ == false) return gmacSuccess;
+    gmacError_t ret = gmacSuccess;
+    lockRead();
+    BlockMap::const_iterator i;
+    for(i = blocks_.begin(); i != blocks_.end(); ++i) {
+        Block &block = *i->second;
+        FileMapping mapping = fileMapping(block);
+        ret = block.coherenceOp(&Protocol::writeFile, mapping);
+        if(ret != gmacSuccess) break;
+    }
+    unlock();
+    return ret;
+}
+
+gmacError_t Object::refreshHost()
+{
+    gmacError_t ret = gmacSuccess;
+    GmacPrefetchDestination dst = GMAC_PREFETCH_HOST;
+    BlockMap::const_iterator i;
+    for(i = blocks_.begin(); i != blocks_.end() && ret == gmacSuccess; ++i) {
+        Block &block = *i->second;
+        switch(block.advice()) {
+        case GMAC_ADVICE_READ_MOSTLY:
+            // Read-mostly blocks are refreshed in the background
+            ret = block.coherenceOp(&Protocol::prefetch, dst);
+            break;
+        case GMAC_ADVICE_HOST_PREFERRED:
+            ret = block.coherenceOp(&Protocol::toHost);
+            break;
+        default:
+            break;
+        }
+    }
+    return ret;
+}
+
+gmacError_t
+Object::memcpyPinned(core::Mode &mode, hostptr_t addr, size_t objOffset, size_t size, GmacProtection prot)
+{
+    core::IOBuffer *active = mode.registerIOBuffer(addr, size, prot);
+    if(active == NULL) return gmacErrorFeatureNotSupported;
+    // A second buffer on the same memory keeps two transfers in flight
+    core::IOBuffer *passive = mode.registerIOBuffer(addr, size, prot);
+    TRACE(LOCAL, "Copying "FMT_SIZE" bytes %s pinned memory %p", size,
+          prot == GMAC_PROT_WRITE? "from": "to", addr);
+
+    gmacError_t ret = gmacSuccess;
+    size_t bufOff = 0;
+    while(bufOff < size) {
+        size_t copySize = size - bufOff;
+        if(copySize > blockEnd(objOffset)) copySize = blockEnd(objOffset);
+        active->wait(); // Wait for the previous transfer using the buffer
+        if(prot == GMAC_PROT_WRITE) ret = copyFromBuffer(*active, copySize, bufOff, objOffset);
+        else ret = copyToBuffer(*active, copySize, bufOff, objOffset);
+        if(ret != gmacSuccess) break;
+        bufOff    += copySize;
+        objOffset += copySize;
+        if(passive != NULL) {
+            core::IOBuffer *tmp = active;
+            active = passive;
+            passive = tmp;
+        }
+    }
+    // User memory cannot be touched until the transfers are done
+    active->wait();
+    mode.unregisterIOBuffer(*active);
+    if(passive != NULL) {
+        passive->wait();
+        mode.unregisterIOBuffer(*passive);
+    }
     return ret;
 }
 
@@ -89,7 +282,13 @@ gmacError_t
 Object::memcpyToObject(core::Mode &mode, size_t objOffset, const hostptr_t src, size_t size)
 {
     trace::EnterCurrentFunction();
-    gmacError_t ret = gmacSuccess;
+    // Pinned user memory does not need to be staged in I/O buffers
+    gmacError_t ret = memcpyPinned(mode, src, objOffset, size, GMAC_PROT_WRITE);
+    if(ret != gmacErrorFeatureNotSupported) {
+        trace::ExitCurrentFunction();
+        return ret;
+    }
+    ret = gmacSuccess;
 
     // We need to I/O buffers to double-buffer the copy
     core::IOBuffer *active;
@@ -112,11 +311,11 @@ Object::memcpyToObject(core::Mode &mode, size_t objOffset, const hostptr_t src,
     }
 
     // Copy the data to the first block
-    ::memcpy(active->addr(), src, copySize);
+    util::StagingCopy::toStaging(active->addr(), src, copySize);
 
     hostptr_t ptr = src;
     while(left > 0) {
-        // We do not need for the active buffer to be full because ::memcpy() is
+        // We do not need for the active buffer to be full because the staging copy is
         // a synchronous call
         ret = copyFromBuffer(*active, copySize, 0, objOffset);
         ASSERTION(ret == gmacSuccess);
@@ -129,7 +328,7 @@ Object::memcpyToObject(core::Mode &mode, size_t objOffset, const hostptr_t src,
             copySize = (left < passive->size()) ? left : passive->size();
             ASSERTION(bufSize >= copySize);
             passive->wait(); // Avoid overwritten a buffer that is already in use
-            ::memcpy(passive->addr(), ptr, copySize);
+            util::StagingCopy::toStaging(passive->addr(), ptr, copySize);
         }
         // Swap buffers
         core::IOBuffer *tmp = active;
@@ -164,43 +363,29 @@ Object::memcpyObjectToObject(core::Mode &mode,
     core::Mode &dstOwner = dstObj.owner(mode, dstPtr);
     core::Mode &srcOwner = owner(mode, srcPtr);
 
-    if (__impl::util::params::ParamMemcpyAccToAcc &&
-        dstObj.acceleratorAddr(dstOwner, dstPtr).pasId_ ==
-        acceleratorAddr(srcOwner, srcPtr).pasId_) {
-        TRACE(LOCAL, "Using fast path: %p -> %p ("FMT_SIZE")",        addr() + srcOffset,
-                                                               dstObj.addr() + dstOffset, size);
-        size_t dummyOffset = 0;
-        BlockMap::const_iterator i = firstBlock(srcOffset, dummyOffset);
-        BlockMap::const_iterator j = dstObj.firstBlock(dstOffset, dummyOffset);
+    if (__impl::util::params::ParamMemcpyAccToAcc) {
+        // Blocks in different accelerators are copied using peer transfers
+        // or a pipelined staging copy (see AcceleratorCopy)
+        TRACE(LOCAL, "Using fast path: %p -> %p ("FMT_SIZE") %s",      addr() + srcOffset,
+                                                               dstObj.addr() + dstOffset, size,
+              dstObj.acceleratorAddr(dstOwner, dstPtr).pasId_ ==
+              acceleratorAddr(srcOwner, srcPtr).pasId_? "": "across accelerators");
         size_t left = size;
         while (left > 0) {
-            size_t copySize = left < dstObj.blockEnd(dstOffset)? left: dstObj.blockEnd(dstOffset);
-            // Single copy from the source to fill the buffer
-            if (copySize <= blockEnd(srcOffset)) {
-                ret = i->second->copyOp(&Protocol::copyBlockToBlock, *j->second, dstOffset % blockSize(), srcOffset % blockSize(), copySize);
-                ASSERTION(ret == gmacSuccess);
-                ++i;
-            }
-            else { // Two copies from the source to fill the buffer
-                size_t firstCopySize = blockEnd(srcOffset);
-                size_t secondCopySize = copySize - firstCopySize;
-
-                ret = i->second->copyOp(&Protocol::copyBlockToBlock, *j->second,
-                                        dstOffset % blockSize(),
-                                        srcOffset % blockSize(),
-                                        firstCopySize);
-                ASSERTION(ret == gmacSuccess);
-                ++i;
-                ret = i->second->copyOp(&Protocol::copyBlockToBlock, *j->second,
-                                        (dstOffset + firstCopySize) % blockSize(),
-                                        (srcOffset + firstCopySize) % blockSize(),
-                                        secondCopySize);
-                ASSERTION(ret == gmacSuccess);
-            }
+            // Objects might use different block sizes, so each copy stays
+            // within a single source and a single destination block
+            size_t srcBlockOffset = 0, dstBlockOffset = 0;
+            BlockMap::const_iterator i = firstBlock(srcOffset, srcBlockOffset);
+            BlockMap::const_iterator j = dstObj.firstBlock(dstOffset, dstBlockOffset);
+            ASSERTION(i != blocks_.end() && j != dstObj.blocks_.end());
+            size_t copySize = left < blockEnd(srcOffset)? left: blockEnd(srcOffset);
+            if (copySize > dstObj.blockEnd(dstOffset)) copySize = dstObj.blockEnd(dstOffset);
+            ret = i->second->copyOp(&Protocol::copyBlockToBlock, *j->second,
+                                    dstBlockOffset, srcBlockOffset, copySize);
+            ASSERTION(ret == gmacSuccess);
             left -= copySize;
             dstOffset += copySize;
             srcOffset += copySize;
-            ++j;
         }
 
         trace::ExitCurrentFunction();
@@ -227,21 +412,9 @@ Object::memcpyObjectToObject(core::Mode &mode,
         passive = NULL;
     }
 
-    // Single copy from the source to fill the buffer
-    if (copySize <= blockEnd(srcOffset)) {
-        ret = copyToBuffer(*active, copySize, 0, srcOffset);
-        ASSERTION(ret == gmacSuccess);
-    }
-    else { // Two copies from the source to fill the buffer
-        size_t firstCopySize = blockEnd(srcOffset);
-        size_t secondCopySize = copySize - firstCopySize;
-        ASSERTION(bufSize >= firstCopySize + secondCopySize);
-
-        ret = copyToBuffer(*active, firstCopySize, 0, srcOffset);
-        ASSERTION(ret == gmacSuccess);
-        ret = copyToBuffer(*active, secondCopySize, firstCopySize, srcOffset + firstCopySize);
-        ASSERTION(ret == gmacSuccess);
-    }
+    // The copy to the buffer spans as many source blocks as needed
+    ret = copyToBuffer(*active, copySize, 0, srcOffset);
+    ASSERTION(ret == gmacSuccess);
 
     // Copy first chunk of data
     while(left > 0) {
@@ -261,21 +434,8 @@ Object::memcpyObjectToObject(core::Mode &mode,
             passive->wait();
 
             // Request the next copy
-            // Single copy from the source to fill the buffer
-            if (copySize <= blockEnd(srcOffset)) {
-                ret = copyToBuffer(*passive, copySize, 0, srcOffset);
-                ASSERTION(ret == gmacSuccess);
-            }
-            else { // Two copies from the source to fill the buffer
-                size_t firstCopySize = blockEnd(srcOffset);
-                size_t secondCopySize = copySize - firstCopySize;
-                ASSERTION(bufSize >= firstCopySize + secondCopySize);
-
-                ret = copyToBuffer(*passive, firstCopySize, 0, srcOffset);
-                ASSERTION(ret == gmacSuccess);
-                ret = copyToBuffer(*passive, secondCopySize, firstCopySize, srcOffset + firstCopySize);
-                ASSERTION(ret == gmacSuccess);
-            }
+            ret = copyToBuffer(*passive, copySize, 0, srcOffset);
+            ASSERTION(ret == gmacSuccess);
 
             // Swap buffers
             core::IOBuffer *tmp = active;
@@ -302,7 +462,12 @@ Object::memcpyFromObject(core::Mode &mode, hostptr_t dst,
                           size_t objOffset, size_t size)
 {
     trace::EnterCurrentFunction();
-    gmacError_t ret = gmacSuccess;
+    gmacError_t ret = memcpyPinned(mode, dst, objOffset, size, GMAC_PROT_READ);
+    if(ret != gmacErrorFeatureNotSupported) {
+        trace::ExitCurrentFunction();
+        return ret;
+    }
+    ret = gmacSuccess;
 
     // We need to I/O buffers to double-buffer the copy
     core::IOBuffer *active;
@@ -345,7 +510,7 @@ Object::memcpyFromObject(core::Mode &mode, hostptr_t dst,
         // Wait for the active buffer to be full
         active->wait();
         // Copy the active buffer to host
-        ::memcpy(dst, active->addr(), previousCopySize);
+        util::StagingCopy::fromStaging(dst, active->addr(), previousCopySize);
         dst += previousCopySize;
 
         // Swap buffers
@@ -371,7 +536,10 @@ Object::signalRead(hostptr_t addr)
     BlockMap::const_iterator i = blocks_.upper_bound(addr);
     if(i == blocks_.end()) ret = gmacErrorInvalidValue;
     else if(i->second->addr() > addr) ret = gmacErrorInvalidValue;
-    else ret = i->second->signalRead(addr);
+    else {
+        AtomicInc(faults_);
+        ret = i->second->signalRead(addr);
+    }
     unlock();
     return ret;
 }
@@ -385,7 +553,10 @@ Object::signalWrite(hostptr_t addr)
     BlockMap::const_iterator i = blocks_.upper_bound(addr);
     if(i == blocks_.end()) ret = gmacErrorInvalidValue;
     else if(i->second->addr() > addr) ret = gmacErrorInvalidValue;
-    else ret = i->second->signalWrite(addr);
+    else {
+        AtomicInc(faults_);
+        ret = i->second->signalWrite(addr);
+    }
     unlock();
     return ret;
 }
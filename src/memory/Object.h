@@ -74,6 +74,15 @@ protected:
     /// Object size in bytes
     size_t size_;
 
+    /// Size (in bytes) of the blocks forming the object
+    size_t blockSize_;
+
+    /// Tells whether the block size was requested by the application
+    bool fixedBlockSize_;
+
+    /// Faults on the object blocks since the object was last acquired
+    Atomic faults_;
+
     typedef std::map<hostptr_t, Block *> BlockMap;
     /// Collection of blocks forming the object
     BlockMap blocks_;
@@ -81,6 +90,41 @@ protected:
     /// Tells whether the object has been released or not
     bool released_;
 
+    /// Incremented each time the object is acquired as a whole
+    Atomic epoch_;
+
+    /// Tells whether the application has given advice for any block
+    bool advised_;
+
+    /// File the object contents are read from, or -1 if there is none
+    int fileFd_;
+
+    /// Offset (in bytes) within the file of the object contents
+    off_t fileOffset_;
+
+    /// Size (in bytes) of the file contents mapped to the object
+    size_t fileSize_;
+
+    /// Tells whether the object contents are written back to the file
+    bool fileWriteBack_;
+
+    /**
+     * Brings back the host copy of the blocks the application reads on the
+     * host, according to their advice
+     *
+     * \return Error code
+     */
+    gmacError_t refreshHost();
+
+    /**
+     * Gets the location within the file of the contents of a block. Bytes
+     * past the size of the mapping do not belong to the file
+     *
+     * \param block Block of the object
+     * \return Location within the file of the block contents
+     */
+    FileMapping fileMapping(const Block &block) const;
+
     /**
      * Returns the block corresponding to a given offset from the begining of the object
      *
@@ -90,6 +134,23 @@ protected:
      */
     BlockMap::const_iterator firstBlock(size_t objectOffset, size_t &blockOffset) const;
 
+    /**
+     * Chooses the size of the blocks for the next kernel calls from the
+     * faults produced since the object was last acquired
+     *
+     * \return Block size to be used by the object
+     */
+    size_t adaptBlockSize() const;
+
+    /**
+     * Divides the object in blocks of a different size. Blocks are created
+     * in the state of the current blocks
+     *
+     * \param blockSize Size (in bytes) of the new blocks
+     * \return Error code
+     */
+    virtual gmacError_t resizeBlocks(size_t blockSize) = 0;
+
     /** Execute a coherence operation on all the blocks of the object
      *
      * \param op Coherence operation to be performed
@@ -135,8 +196,10 @@ protected:
      *
      * \param addr Host memory address where the object begins
      * \param size Size (in bytes) of the memory object
+     * \param blockSize Size (in bytes) of the blocks forming the object. 0
+     * lets the object choose the block size
      */
-    Object(hostptr_t addr, size_t size);
+    Object(hostptr_t addr, size_t size, size_t blockSize = 0);
 
     //! Default destructor
     virtual ~Object();
@@ -182,6 +245,14 @@ public:
      */
     size_t blockSize() const;
 
+    /**
+     * Get the default block size for an object
+     *
+     * \param size Size (in bytes) of the object
+     * \return Block size used by objects of the given size
+     */
+    static size_t defaultBlockSize(size_t size);
+
     /**
      * Get the size (in bytes) of the object
      *
@@ -269,6 +340,20 @@ public:
      */
     gmacError_t toAccelerator();
 
+    /**
+     * Discards the object contents before overwriting them in the accelerator
+     * memory
+     *
+     * \return Error code
+     */
+    gmacError_t invalidate();
+
+    /**
+     * Makes the next host write to any block of the object to be signaled
+     *
+     * \return Error code
+     */
+    gmacError_t writeProtect();
 
     /**
      * Dump object information to a file
@@ -330,6 +415,58 @@ public:
      */
     TESTABLE gmacError_t memset(size_t offset, int v, size_t count);
 
+    /**
+     * Starts moving a memory range within the object to the host or to the
+     * accelerator memory
+     *
+     * \param offset Offset within the object of the memory to be moved
+     * \param count Size (in bytes) of the memory region to be moved
+     * \param dst Memory the region is moved to
+     * \return Error code
+     */
+    gmacError_t prefetch(size_t offset, size_t count, GmacPrefetchDestination dst);
+
+    /**
+     * Sets the expected access pattern of a memory range within the object.
+     * The advice applies to all the blocks the range touches
+     *
+     * \param offset Offset within the object of the memory region
+     * \param count Size (in bytes) of the memory region
+     * \param advice Expected access pattern
+     * \return Error code
+     */
+    gmacError_t memAdvise(size_t offset, size_t count, GmacMemAdvice advice);
+
+    /**
+     * Makes the contents of the object come from a file. Each block is read
+     * from the file the first time the host or the accelerator uses it
+     *
+     * \param fd Descriptor of the file. The object closes it when it is
+     * destroyed
+     * \param offset Offset (in bytes) within the file of the object contents
+     * \param size Size (in bytes) of the file contents mapped to the object.
+     * It might be smaller than the object
+     * \param writeBack Tells whether writeFile writes the object contents back
+     * to the file
+     * \return Error code
+     */
+    gmacError_t mapFile(int fd, off_t offset, size_t size, bool writeBack);
+
+    /**
+     * Writes back to its file the contents of the object read from the file,
+     * if the object was mapped for writing
+     *
+     * \return Error code
+     */
+    gmacError_t writeFile();
+
+    /**
+     * Tells if the object contents come from a file
+     *
+     * \return True if the object was mapped to a file
+     */
+    bool isFileMapped() const;
+
     /**
      * Adds the object to the coherence domain.
      *
@@ -348,6 +485,28 @@ public:
     */
     virtual gmacError_t unmapFromAccelerator() = 0;
 
+    /**
+     * Tells if the object has accelerator memory
+     * \return False if the object has been unmapped from the accelerator
+     */
+    virtual bool isMapped() const = 0;
+
+    /**
+     * Copies data between host memory and the object using the host memory
+     * directly in the transfers. The host memory must be pinned in the
+     * accelerator by the registration cache
+     * \param mode Execution mode requesting the memory copy
+     * \param addr Host memory address
+     * \param objOffset Offset (in bytes) from the begining of the object
+     * \param count Size (in bytes) of the data to be copied
+     * \param prot GMAC_PROT_WRITE to copy to the object, GMAC_PROT_READ to
+     * copy from the object
+     * \return Error code, gmacErrorFeatureNotSupported if the host memory
+     * is not pinned
+     */
+    gmacError_t memcpyPinned(core::Mode &mode, hostptr_t addr,
+                             size_t objOffset, size_t count, GmacProtection prot);
+
     /**
      * Copies data from host memory to an object
      * \param mode Execution mode requesting the memory copy
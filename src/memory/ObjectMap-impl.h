@@ -5,6 +5,14 @@
 
 namespace __impl { namespace memory {
 
+inline
+bool
+ObjectMap::mayContain(const hostptr_t addr, size_t size)
+{
+    if(size == 0) size = 1;
+    return addr < AddrHigh_ && addr + size > AddrLow_;
+}
+
 inline
 gmacError_t
 ObjectMap::forEachObject(gmacError_t (Object::*f)(void))
@@ -1,9 +1,13 @@
+#include <algorithm>
+
 #include "core/Mode.h"
+#include "util/Atomics.h"
 #include "util/FileSystem.h"
 
 #include "ObjectMap.h"
 #include "Object.h"
 #include "Protocol.h"
+#include "TranslationCache.h"
 
 namespace __impl { namespace memory {
 
@@ -33,6 +37,21 @@ ObjectMap::statsInit()
 }
 #endif
 
+hostptr_t volatile ObjectMap::AddrLow_ = hostptr_t(~uintptr_t(0));
+hostptr_t volatile ObjectMap::AddrHigh_ = NULL;
+
+void
+ObjectMap::growRange(const hostptr_t start, const hostptr_t end)
+{
+    hostptr_t old;
+    while((old = AddrLow_) > start) {
+        if(AtomicTestAndSetPtr(AddrLow_, old, start) == old) break;
+    }
+    while((old = AddrHigh_) < end) {
+        if(AtomicTestAndSetPtr(AddrHigh_, old, end) == old) break;
+    }
+}
+
 Object *
 ObjectMap::mapFind(const hostptr_t addr, size_t size) const
 {
@@ -87,6 +106,8 @@ size_t ObjectMap::size() const
 
 bool ObjectMap::addObject(Object &obj)
 {
+    // The range is grown before the object can be found in the map
+    growRange(obj.addr(), obj.end());
     lockWrite();
     TRACE(LOCAL, "Insert object: %p", obj.addr());
     std::pair<iterator, bool> ret = Parent::insert(value_type(obj.end(), &obj));
@@ -116,8 +137,11 @@ bool ObjectMap::removeObject(Object &obj)
 #endif
 
         TRACE(LOCAL, "Remove object: %p", obj.addr());
+        if(resident_.empty() == false) resident_.remove(&obj);
         obj.decRef();
         Parent::erase(i);
+        // Threads might have cached the translation of the object
+        TranslationCache::invalidate();
     } else {
         TRACE(LOCAL, "CANNOT Remove object: %p from map with "FMT_SIZE" elems", obj.addr(), Parent::size());
     }
@@ -152,6 +176,18 @@ size_t ObjectMap::memorySize() const
     return total;
 }
 
+void ObjectMap::getObjects(std::vector<Object *> &objects) const
+{
+    const_iterator i;
+    lockRead();
+    objects.reserve(objects.size() + Parent::size());
+    for(i = begin(); i != end(); ++i) {
+        i->second->incRef();
+        objects.push_back(i->second);
+    }
+    unlock();
+}
+
 gmacError_t ObjectMap::releaseObjects()
 {
     lockWrite();
@@ -183,5 +219,67 @@ ObjectMap::acquireObjects()
     return gmacSuccess;
 }
 
+void ObjectMap::insertResident(Object &obj)
+{
+    lockWrite();
+    resident_.push_back(&obj);
+    unlock();
+}
+
+gmacError_t ObjectMap::useObjects(const std::vector<Object *> &objects)
+{
+    std::vector<Object *>::const_iterator i;
+    lockWrite();
+    for(i = objects.begin(); i != objects.end(); ++i) {
+        std::list<Object *>::iterator j = std::find(resident_.begin(), resident_.end(), *i);
+        // Objects not registered are never evicted
+        if(j == resident_.end()) continue;
+        resident_.splice(resident_.end(), resident_, j);
+    }
+    unlock();
+
+    gmacError_t ret = gmacSuccess;
+    for(i = objects.begin(); i != objects.end() && ret == gmacSuccess; ++i) {
+        if((*i)->isMapped() == true) continue;
+        TRACE(LOCAL, "Mapping back evicted object %p", (*i)->addr());
+        ret = (*i)->mapToAccelerator();
+    }
+    return ret;
+}
+
+gmacError_t ObjectMap::evictObjects(size_t size, const std::vector<Object *> &keep)
+{
+    std::vector<Object *> victims;
+    size_t evicted = 0;
+    std::list<Object *>::const_iterator i;
+    lockWrite();
+    for(i = resident_.begin(); i != resident_.end() && evicted < size; ++i) {
+        Object *obj = *i;
+        if(obj->isMapped() == false) continue;
+        if(std::find(keep.begin(), keep.end(), obj) != keep.end()) continue;
+        obj->incRef();
+        victims.push_back(obj);
+        evicted += obj->size();
+    }
+    bool released = releasedObjects_;
+    unlock();
+
+    if(victims.empty() == true) return gmacErrorMemoryAllocation;
+
+    gmacError_t ret = gmacSuccess;
+    std::vector<Object *>::const_iterator j;
+    for(j = victims.begin(); j != victims.end(); ++j) {
+        TRACE(LOCAL, "Evicting object %p ("FMT_SIZE" bytes)", (*j)->addr(), (*j)->size());
+        // Kernels might have modified the objects released to the accelerator
+        if(ret == gmacSuccess && released == true) {
+            GmacProtection prot = GMAC_PROT_READWRITE;
+            ret = (*j)->acquire(prot);
+        }
+        if(ret == gmacSuccess) ret = (*j)->unmapFromAccelerator();
+        (*j)->decRef();
+    }
+    return ret;
+}
+
 
 }}
@@ -34,8 +34,10 @@ WITH THE SOFTWARE.  */
 #ifndef GMAC_MEMORY_MAP_H_
 #define GMAC_MEMORY_MAP_H_
 
+#include <list>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "config/common.h"
 #include "util/Lock.h"
@@ -69,6 +71,12 @@ protected:
     bool modifiedObjects_;
     bool releasedObjects_;
 
+    /**
+     * Objects whose accelerator memory can be evicted, from the least to
+     * the most recently used by a kernel
+     */
+    std::list<Object *> resident_;
+
 #ifdef USE_VM
     __impl::memory::vm::Bitmap bitmap_;
 #endif
@@ -82,6 +90,20 @@ protected:
 
     void modifiedObjects_unlocked();
 
+    /** Lowest host address ever used by an object in any map */
+    static hostptr_t volatile AddrLow_;
+    /** Highest host address ever used by an object in any map */
+    static hostptr_t volatile AddrHigh_;
+
+    /**
+     * Grows the range of host addresses used by objects to include a new
+     * object. The range never shrinks, so it can be read without locking
+     *
+     * \param start Starting host address of the object
+     * \param end Ending host address of the object
+     */
+    static void growRange(const hostptr_t start, const hostptr_t end);
+
     /**
      * Find an object in the map
      *
@@ -152,6 +174,20 @@ public:
      */
     virtual Object *getObject(const hostptr_t addr, size_t size = 0) const;
 
+    /**
+     * Tells if a memory range might belong to an object. This check does not
+     * take any lock, and it is meant to quickly discard memory not allocated
+     * by GMAC. The range only grows and is shared by all maps, because
+     * shrinking it on removal would need a lock on every map. After objects
+     * are freed, memory that the host allocates inside the old range still
+     * takes the locked lookup
+     *
+     * \param addr Starting address of the memory range
+     * \param size Size (in bytes) of the memory range
+     * \return False if no object has ever been allocated in the memory range
+     */
+    static bool mayContain(const hostptr_t addr, size_t size = 0);
+
     /**
      * Get the amount of memory consumed by all objects in the map
      *
@@ -159,6 +195,14 @@ public:
      */
     size_t memorySize() const;
 
+    /**
+     * Gets all the objects in the map. The caller must release the returned
+     * objects
+     *
+     * \param objects Vector where the objects are appended
+     */
+    void getObjects(std::vector<Object *> &objects) const;
+
     /**
      * Execute an operation on all the objects in the map
      *
@@ -223,6 +267,35 @@ public:
      */
     gmacError_t acquireObjects();
 
+    /**
+     * Registers an object whose accelerator memory can be evicted to host
+     * memory when the accelerator runs out of memory
+     *
+     * \param obj Object to be registered
+     */
+    void insertResident(Object &obj);
+
+    /**
+     * Marks objects as the most recently used by a kernel, and maps back to
+     * the accelerator the objects that have been evicted
+     *
+     * \param objects Objects used by the kernel
+     * \return Error code. gmacErrorMemoryAllocation if there is not enough
+     * accelerator memory to map back the objects
+     */
+    gmacError_t useObjects(const std::vector<Object *> &objects);
+
+    /**
+     * Evicts the least recently used objects to host memory. Kernels using
+     * the evicted objects must have finished
+     *
+     * \param size Accelerator memory (in bytes) to be released
+     * \param keep Objects that cannot be evicted
+     * \return Error code. gmacErrorMemoryAllocation if no object can be
+     * evicted
+     */
+    gmacError_t evictObjects(size_t size, const std::vector<Object *> &keep);
+
     /**
      * Gets a reference to the memory protocol used by the mode
      * \return A reference to the memory protocol used by the mode
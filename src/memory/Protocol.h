@@ -34,6 +34,8 @@ WITH THE SOFTWARE.  */
 #ifndef GMAC_MEMORY_PROTOCOL_H_
 #define GMAC_MEMORY_PROTOCOL_H_
 
+#include <sys/types.h>
+
 #include <fstream>
 #include <list>
 
@@ -54,6 +56,16 @@ namespace memory {
 class Block;
 class Object;
 
+/** Location within a file of the contents of a memory block */
+struct GMAC_LOCAL FileMapping {
+    /// Descriptor of the file
+    int fd_;
+    /// Offset (in bytes) within the file
+    off_t offset_;
+    /// Bytes of the block that belong to the file mapping
+    size_t size_;
+};
+
 /**
  * Base class that defines the operations to be implemented by any protocol
  */
@@ -71,10 +83,12 @@ public:
      * \param prot Memory protection for the object host memory after it is
      * created
      * \param flags Protocool specific flags
+     * \param blockSize Size (in bytes) of the object blocks. 0 lets the
+     * object choose the block size
      * \return Pointer to the created object
      */
     virtual Object *createObject(core::Mode &current, size_t size, hostptr_t cpuPtr,
-                                 GmacProtection prot, unsigned flags) = 0;
+                                 GmacProtection prot, unsigned flags, size_t blockSize = 0) = 0;
 
     /**
      * Deletes an object created by this protocol
@@ -125,6 +139,16 @@ public:
      * execution
      */
     virtual gmacError_t acquire(Block &block, GmacProtection &prot) = 0;
+
+    /** Acquires the ownership of a whole memory object for the CPU. The
+     * protocol changes the object memory protection at once, and applies the
+     * acquire to each block the next time the block is used
+     *
+     * \param object Memory object whose ownership is acquired
+     * \param prot Access permissions the accelerator had on the object
+     * \return Error code
+     */
+    virtual gmacError_t acquireObject(Object &object, GmacProtection &prot) = 0;
 #ifdef USE_VM
     virtual gmacError_t acquireWithBitmap(Block &block) = 0;
 #endif
@@ -198,6 +222,26 @@ public:
      */
     virtual gmacError_t toHost(Block &block) = 0;
 
+    /**
+     * Discards the contents of a block before it is overwritten in the
+     * accelerator memory
+     *
+     * \param block Memory block to be invalidated
+     * \return Error code
+     * \warning This method assumes that the block is not modified during its
+     * execution
+     */
+    virtual gmacError_t invalidate(Block &block) = 0;
+
+    /**
+     * Makes the next host write to a block to be signaled, even if the block
+     * is already modified in host memory
+     *
+     * \param block Memory block to be protected
+     * \return Error code
+     */
+    virtual gmacError_t writeProtect(Block &block) = 0;
+
 #if 0
     /**
      * Ensures that the accelerator memory of a block contains an updated copy
@@ -211,6 +255,36 @@ public:
     virtual gmacError_t toAccelerator(Block &block) = 0;
 #endif
 
+    /**
+     * Starts moving the data of a block to the host or to the accelerator
+     * memory. The call does not wait for the transfer
+     *
+     * \param block Memory block to be moved
+     * \param dst Memory the block data is moved to
+     * \return Error code
+     */
+    virtual gmacError_t prefetch(Block &block, GmacPrefetchDestination &dst) = 0;
+
+    /**
+     * Makes the contents of a block come from a file. The file is read the
+     * first time any of the copies of the block is used
+     *
+     * \param block Memory block backed by the file
+     * \param mapping Location within the file of the block contents
+     * \return Error code
+     */
+    virtual gmacError_t mapFile(Block &block, FileMapping &mapping) = 0;
+
+    /**
+     * Writes the contents of a block to a file. Blocks whose contents have
+     * not been read from the file yet are not written
+     *
+     * \param block Memory block to be written
+     * \param mapping Location within the file where the block is written
+     * \return Error code
+     */
+    virtual gmacError_t writeFile(Block &block, FileMapping &mapping) = 0;
+
     /** Copy the contents of a memory block to an I/O buffer
      *
      * \param block Memory block from where data is being copied
@@ -256,11 +330,18 @@ public:
      * \warning This method assumes that the block is not modified during its
      * execution
      */
-    virtual gmacError_t memset(const Block &block, int v, size_t size,
+    virtual gmacError_t memset(Block &block, int v, size_t size,
                                size_t blockOffset) = 0;
 
     virtual gmacError_t flushDirty() = 0;
 
+    /**
+     * Gets the number of blocks waiting to be released to the accelerator
+     * \return Number of dirty blocks. The value might be stale if other
+     * threads are modifying blocks
+     */
+    virtual size_t dirtyBlocks() const = 0;
+
     /**
      * Copies between two memory blocks, assuming that direct copies are
      * possible regardless the location of the data (accelerator or host memory)
@@ -0,0 +1,15 @@
+#ifndef GMAC_MEMORY_RECORDER_IMPL_H_
+#define GMAC_MEMORY_RECORDER_IMPL_H_
+
+namespace __impl { namespace memory {
+
+inline void
+Recorder::record(GmacRecordType type, unsigned mode, hostptr_t addr, size_t size, GmacProtection prot)
+{
+    if(Recorder_ == NULL) return;
+    Recorder_->add(type, mode, addr, size, prot);
+}
+
+}}
+
+#endif
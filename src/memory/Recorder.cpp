@@ -0,0 +1,131 @@
+#if defined(POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Recorder.h"
+
+#include "util/Logger.h"
+#include "util/Parameter.h"
+#include "util/Thread.h"
+
+namespace __impl { namespace memory {
+
+Recorder *Recorder::Recorder_ = NULL;
+
+#if defined(POSIX)
+// pwrite is used because the I/O wrappers interpose write
+static bool
+writeFile(int fd, const void *ptr, size_t size, off_t offset)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(ptr);
+    while(size > 0) {
+        ssize_t ret = ::pwrite(fd, p, size, offset);
+        if(ret <= 0) return false;
+        p += ret;
+        size -= size_t(ret);
+        offset += ret;
+    }
+    return true;
+}
+
+static void
+syncAtExit()
+{
+    Recorder::sync();
+}
+#endif
+
+Recorder::Recorder(int fd) :
+    gmac::util::Lock("Recorder"),
+    fd_(fd),
+    offset_(sizeof(GmacRecordHeader)),
+    start_(uint64_t(util::GetTimeStamp())),
+    buffer_(new GmacRecordEvent[Events_]),
+    used_(0)
+{
+}
+
+void Recorder::flush()
+{
+    if(used_ == 0) return;
+#if defined(POSIX)
+    size_t size = used_ * sizeof(GmacRecordEvent);
+    if(writeFile(fd_, buffer_, size, offset_) == false)
+        WARNING("Unable to write "FMT_SIZE" coherence events", used_);
+    offset_ += off_t(size);
+#endif
+    used_ = 0;
+}
+
+void Recorder::add(GmacRecordType type, unsigned mode, hostptr_t addr, size_t size, GmacProtection prot)
+{
+    lock();
+    GmacRecordEvent &event = buffer_[used_++];
+    event.type_ = uint8_t(type);
+    event.prot_ = uint8_t(prot);
+    event.reserved_ = 0;
+    event.mode_ = uint32_t(mode);
+    event.time_ = uint64_t(util::GetTimeStamp()) - start_;
+    event.addr_ = uint64_t(addr);
+    event.size_ = uint64_t(size);
+    if(used_ == Events_) flush();
+    unlock();
+}
+
+void Recorder::init()
+{
+    if(Recorder_ != NULL || util::params::ParamRecord[0] == '\0') return;
+#if defined(POSIX)
+    std::string path(util::params::ParamRecord);
+    size_t pos = path.find("%p");
+    if(pos != std::string::npos) {
+        char pid[32];
+        snprintf(pid, sizeof(pid), "%d", int(util::GetProcessId()));
+        path.replace(pos, 2, pid);
+    }
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        WARNING("Unable to create record file %s", path.c_str());
+        return;
+    }
+
+    GmacRecordHeader header;
+    ::memset(&header, 0, sizeof(header));
+    header.magic_ = GMAC_RECORD_MAGIC;
+    header.version_ = GMAC_RECORD_VERSION;
+    header.pid_ = uint64_t(util::GetProcessId());
+    header.blockSize_ = uint64_t(util::params::ParamBlockSize);
+    header.subBlockSize_ = uint64_t(util::params::ParamSubBlockSize);
+    header.rollThreshold_ = uint32_t(util::params::ParamRollThreshold);
+    ::strncpy(header.protocol_, util::params::ParamProtocol, sizeof(header.protocol_) - 1);
+    if(writeFile(fd, &header, sizeof(header), 0) == false) {
+        WARNING("Unable to write record file %s", path.c_str());
+        ::close(fd);
+        return;
+    }
+
+    TRACE(GLOBAL, "Recording coherence events in %s", path.c_str());
+    Recorder_ = new Recorder(fd);
+    // Other threads can still record events while the process exits, so the
+    // recorder is never destroyed and only the buffered events are written
+    atexit(syncAtExit);
+#else
+    WARNING("Recording coherence events is not supported on this platform");
+#endif
+}
+
+void Recorder::sync()
+{
+    if(Recorder_ == NULL) return;
+    Recorder_->lock();
+    Recorder_->flush();
+    Recorder_->unlock();
+}
+
+}}
@@ -0,0 +1,121 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_RECORDER_H_
+#define GMAC_MEMORY_RECORDER_H_
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "memory/RecorderFormat.h"
+#include "util/Lock.h"
+
+namespace __impl { namespace memory {
+
+/**
+ * Writes the coherence events of the run-time to a file, so coherence
+ * settings can be evaluated offline with gmac-replay. Events are kept in a
+ * buffer and written in batches. If GMAC_RECORD is not set, recording an
+ * event only costs a pointer check
+ */
+class GMAC_LOCAL Recorder : protected gmac::util::Lock {
+    // Lock protects the event buffer and the file
+protected:
+    /** Events written in each batch */
+    static const size_t Events_ = 4096;
+
+    /** Recorder of the process, or NULL if recording is disabled */
+    static Recorder *Recorder_;
+
+    /** File descriptor of the record file */
+    int fd_;
+    /** Offset in the record file where the next events are written */
+    off_t offset_;
+    /** Time stamp when the recorder was started */
+    uint64_t start_;
+    /** Events not written yet */
+    GmacRecordEvent *buffer_;
+    /** Number of events in the buffer */
+    size_t used_;
+
+    /**
+     * Creates a recorder writing to a file
+     * \param fd File descriptor of the record file
+     */
+    Recorder(int fd);
+
+    /**
+     * Writes the events in the buffer to the file. The recorder lock must be held
+     */
+    void flush();
+
+    /**
+     * Adds an event to the buffer
+     * \param type Type of the event
+     * \param mode Identifier of the execution mode
+     * \param addr Address of the event
+     * \param size Size of the event
+     * \param prot Protection of the event
+     */
+    void add(GmacRecordType type, unsigned mode, hostptr_t addr, size_t size, GmacProtection prot);
+
+public:
+    /**
+     * Opens the record file if GMAC_RECORD is set. Any "%p" in the file name
+     * is replaced with the process id
+     */
+    static void init();
+
+    /**
+     * Writes the pending events to the record file. It is called on exit; the
+     * recorder is never destroyed, because other threads might still record
+     * events
+     */
+    static void sync();
+
+    /**
+     * Records a coherence event
+     * \param type Type of the event
+     * \param mode Identifier of the execution mode
+     * \param addr Address of the event, or NULL
+     * \param size Size of the event
+     * \param prot Protection of the event
+     */
+    static void record(GmacRecordType type, unsigned mode, hostptr_t addr,
+                       size_t size = 0, GmacProtection prot = GMAC_PROT_NONE);
+};
+
+}}
+
+#include "Recorder-impl.h"
+
+#endif
@@ -0,0 +1,87 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_RECORDERFORMAT_H_
+#define GMAC_MEMORY_RECORDERFORMAT_H_
+
+/*
+ * Layout of the files written by the coherence event recorder. The files are
+ * read by gmac-replay, so this file only uses plain C types and must not
+ * depend on the rest of GMAC. All the fields are stored in host byte order
+ */
+
+#include <stdint.h>
+
+#define GMAC_RECORD_MAGIC 0x47524543u /* "GREC" */
+#define GMAC_RECORD_VERSION 2
+
+/** Types of recorded events */
+enum GmacRecordType {
+    GMAC_RECORD_ALLOC   = 1, /*!< Shared object created: addr_, size_, prot_ is the initial protection */
+    GMAC_RECORD_FREE    = 2, /*!< Shared object destroyed: addr_ */
+    GMAC_RECORD_READ    = 3, /*!< Read fault: addr_ */
+    GMAC_RECORD_WRITE   = 4, /*!< Write fault: addr_ */
+    GMAC_RECORD_RELEASE = 5, /*!< Object released before a kernel call: addr_, or 0 for all the objects */
+    GMAC_RECORD_ACQUIRE = 6, /*!< Object acquired after a kernel call: addr_ (or 0), prot_ */
+    GMAC_RECORD_BLOCKSIZE = 7 /*!< Block size of an object, after it is created or its blocks are resized: addr_, size_ */
+};
+
+/** Header at the beginning of the file */
+typedef struct {
+    uint32_t magic_;
+    uint32_t version_;
+    uint64_t pid_;
+    /** Settings of the recorded run. Objects might use other block sizes, given by
+        their GMAC_RECORD_BLOCKSIZE events, and faults are recorded at that granularity */
+    uint64_t blockSize_;
+    uint64_t subBlockSize_;
+    uint32_t rollThreshold_;
+    uint32_t reserved_;
+    char protocol_[16];
+} GmacRecordHeader;
+
+/** Recorded event */
+typedef struct {
+    uint8_t type_;
+    /** GmacProtection value, only used by some events */
+    uint8_t prot_;
+    uint16_t reserved_;
+    /** Identifier of the execution mode */
+    uint32_t mode_;
+    /** Time (in microseconds) since the recorder was started */
+    uint64_t time_;
+    uint64_t addr_;
+    uint64_t size_;
+} GmacRecordEvent;
+
+#endif
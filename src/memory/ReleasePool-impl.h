@@ -0,0 +1,14 @@
+#ifndef GMAC_MEMORY_RELEASEPOOL_IMPL_H_
+#define GMAC_MEMORY_RELEASEPOOL_IMPL_H_
+
+namespace __impl { namespace memory {
+
+inline unsigned
+ReleasePool::threads() const
+{
+    return threads_;
+}
+
+}}
+
+#endif
@@ -0,0 +1,137 @@
+#if defined(POSIX)
+#include <pthread.h>
+#endif
+
+#include "ReleasePool.h"
+
+#include "memory/Block.h"
+#include "trace/Tracer.h"
+#include "util/Logger.h"
+#include "util/Parameter.h"
+
+namespace __impl { namespace memory {
+
+ReleasePool *ReleasePool::Pool_ = NULL;
+
+ReleasePool::ReleasePool(unsigned threads) :
+    gmac::util::Lock("ReleasePool"),
+    threads_(threads),
+    started_(false),
+    exit_(false),
+    start_(0),
+    done_(0),
+    work_(NULL),
+    next_(0),
+    op_(NULL),
+    error_(int(gmacSuccess))
+{
+}
+
+ReleasePool::~ReleasePool()
+{
+    if(started_ == false) return;
+    lock();
+    exit_ = true;
+    for(unsigned i = 0; i < threads_; i++) start_.post();
+    for(unsigned i = 0; i < threads_; i++) done_.wait();
+    unlock();
+}
+
+ReleasePool *ReleasePool::get()
+{
+    // The pool is created during the memory initialization, which runs
+    // before any thread can release objects
+    if(Pool_ != NULL) return Pool_;
+#if defined(POSIX) && !defined(USE_VM)
+    // Workers do not have a current execution mode, so the bitmap used by
+    // USE_VM cannot be reached from them
+    if(util::params::ParamReleaseThreads > 0) {
+        TRACE(GLOBAL, "Using %u threads to release objects", util::params::ParamReleaseThreads);
+        Pool_ = new ReleasePool(util::params::ParamReleaseThreads);
+    }
+#endif
+    return Pool_;
+}
+
+void ReleasePool::destroy()
+{
+    if(Pool_ == NULL) return;
+    delete Pool_;
+    Pool_ = NULL;
+}
+
+gmacError_t ReleasePool::start()
+{
+#if defined(POSIX)
+    for(unsigned i = 0; i < threads_; i++) {
+        pthread_t tid;
+        if(pthread_create(&tid, NULL, worker, this) != 0) {
+            // Keep the workers we managed to create
+            WARNING("Unable to create release thread #%u", i);
+            threads_ = i;
+            break;
+        }
+        pthread_detach(tid);
+    }
+    started_ = true;
+    return gmacSuccess;
+#else
+    threads_ = 0;
+    started_ = true;
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+void *ReleasePool::worker(void *arg)
+{
+    ReleasePool &pool = *static_cast<ReleasePool *>(arg);
+    while(true) {
+        pool.start_.wait();
+        if(pool.exit_ == true) break;
+        pool.process();
+        pool.done_.post();
+    }
+    pool.done_.post();
+    return NULL;
+}
+
+void ReleasePool::process()
+{
+    while(true) {
+        size_t n = size_t(AtomicInc(next_)) - 1;
+        if(n >= work_->size()) return;
+        Block *block = (*work_)[n];
+
+        gmacError_t ret = block->coherenceOp(op_);
+        // Only the first error is reported back
+        if(ret != gmacSuccess) AtomicTestAndSet(error_, int(gmacSuccess), int(ret));
+    }
+}
+
+gmacError_t ReleasePool::run(std::vector<Block *> &blocks, Protocol::CoherenceOp op)
+{
+    if(blocks.empty() == true) return gmacSuccess;
+    trace::EnterCurrentFunction();
+    lock();
+    if(started_ == false) start();
+
+    work_ = &blocks;
+    next_ = 0;
+    op_ = op;
+    error_ = int(gmacSuccess);
+
+    TRACE(LOCAL, "Releasing "FMT_SIZE" blocks using %u threads", blocks.size(), threads_ + 1);
+    for(unsigned i = 0; i < threads_; i++) start_.post();
+    // The calling thread also takes blocks from the batch
+    process();
+    // Barrier: wait for all workers to finish their last block
+    for(unsigned i = 0; i < threads_; i++) done_.wait();
+
+    gmacError_t ret = gmacError_t(error_);
+    work_ = NULL;
+    unlock();
+    trace::ExitCurrentFunction();
+    return ret;
+}
+
+}}
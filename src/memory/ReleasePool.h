@@ -0,0 +1,143 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_RELEASEPOOL_H_
+#define GMAC_MEMORY_RELEASEPOOL_H_
+
+#include <vector>
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "util/Atomics.h"
+#include "util/Lock.h"
+#include "util/Semaphore.h"
+
+#include "Protocol.h"
+
+namespace __impl { namespace memory {
+
+class Block;
+
+/**
+ * Pool of run-time threads used to apply a coherence operation to a batch
+ * of blocks in parallel. Each worker performs the memory protection changes
+ * and the staging copies of the blocks it takes, and uses its own execution
+ * context in the block owner, so transfers are issued from several contexts
+ * at the same time.
+ */
+class GMAC_LOCAL ReleasePool : protected gmac::util::Lock {
+    // Lock is taken to serialize batches coming from different protocols
+protected:
+    /** Pool shared by all the protocols in the process */
+    static ReleasePool *Pool_;
+
+    /** Number of worker threads (the calling thread is not included) */
+    unsigned threads_;
+    /** Whether the worker threads have been already spawned */
+    bool started_;
+    /** Tells workers to exit */
+    bool exit_;
+
+    /** Posted once per worker when a new batch is ready */
+    util::Semaphore start_;
+    /** Posted by each worker when it has finished the current batch */
+    util::Semaphore done_;
+
+    /** Blocks in the current batch */
+    std::vector<Block *> *work_;
+    /** Next block to be taken from the current batch */
+    Atomic next_;
+    /** Coherence operation applied to the current batch */
+    Protocol::CoherenceOp op_;
+    /** First error produced while processing the current batch */
+    Atomic error_;
+
+    /**
+     * Spawns the worker threads
+     * \return Error code
+     */
+    gmacError_t start();
+
+    /**
+     * Applies the current operation to blocks in the batch until it is empty
+     */
+    void process();
+
+    /**
+     * Entry point for worker threads
+     * \param arg Pool the worker belongs to
+     */
+    static void *worker(void *arg);
+
+    /**
+     * Creates a pool with the given number of worker threads. Workers are
+     * spawned the first time the pool is used
+     * \param threads Number of worker threads
+     */
+    ReleasePool(unsigned threads);
+
+    /** Default destructor */
+    ~ReleasePool();
+
+public:
+    /**
+     * Gets the process-wide pool
+     * \return Pool of release threads, or NULL if parallel release is disabled
+     */
+    static ReleasePool *get();
+
+    /** Stops the worker threads and destroys the process-wide pool */
+    static void destroy();
+
+    /**
+     * Applies a coherence operation to a batch of blocks using the pool
+     * threads and the calling thread. The call returns once all the blocks
+     * have been processed, so it acts as a barrier for the batch
+     * \param blocks Blocks to be processed
+     * \param op Coherence operation to apply on each block
+     * \return Error code
+     */
+    gmacError_t run(std::vector<Block *> &blocks, Protocol::CoherenceOp op);
+
+    /**
+     * Gets the number of worker threads in the pool
+     * \return Number of worker threads
+     */
+    unsigned threads() const;
+};
+
+}}
+
+#include "ReleasePool-impl.h"
+
+#endif
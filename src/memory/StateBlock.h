@@ -49,6 +49,10 @@ class GMAC_LOCAL StateBlock :
     public State {
     friend gmacError_t State::syncToAccelerator();
     friend gmacError_t State::syncToHost();
+    friend gmacError_t State::fillAccelerator();
+#if defined(USE_SUBBLOCK_TRACKING)
+    friend gmacError_t State::gatherToAccelerator();
+#endif
 
 protected:
     /** Default construcutor
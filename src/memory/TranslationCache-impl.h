@@ -0,0 +1,68 @@
+#ifndef GMAC_MEMORY_TRANSLATIONCACHE_IMPL_H_
+#define GMAC_MEMORY_TRANSLATIONCACHE_IMPL_H_
+
+namespace __impl { namespace memory {
+
+inline
+TranslationCache::TranslationCache() :
+    last_(0),
+    next_(0)
+{
+    for(unsigned i = 0; i < Size_; i++) {
+        entries_[i].mode_ = NULL;
+        entries_[i].start_ = NULL;
+        entries_[i].end_ = NULL;
+        entries_[i].generation_ = 0;
+    }
+}
+
+inline bool
+TranslationCache::lookup(const core::Mode &mode, const hostptr_t addr, accptr_t &acc)
+{
+    unsigned generation = unsigned(Generation_);
+    // Consecutive translations usually fall in the same object
+    for(unsigned n = 0; n < Size_; n++) {
+        unsigned i = (last_ + n) % Size_;
+        Entry &entry = entries_[i];
+        if(entry.mode_ != &mode || addr < entry.start_ || addr >= entry.end_) continue;
+        if(entry.generation_ != generation) {
+            // The object might have been removed or remapped
+            entry.mode_ = NULL;
+            continue;
+        }
+        last_ = i;
+        acc = entry.base_ + ptroff_t(addr - entry.start_);
+        return true;
+    }
+    return false;
+}
+
+inline void
+TranslationCache::insert(const core::Mode &mode, hostptr_t start, size_t size, accptr_t base,
+                         unsigned generation)
+{
+    Entry &entry = entries_[next_];
+    entry.mode_ = &mode;
+    entry.start_ = start;
+    entry.end_ = start + size;
+    entry.base_ = base;
+    entry.generation_ = generation;
+    last_ = next_;
+    next_ = (next_ + 1) % Size_;
+}
+
+inline unsigned
+TranslationCache::generation()
+{
+    return unsigned(Generation_);
+}
+
+inline void
+TranslationCache::invalidate()
+{
+    AtomicInc(Generation_);
+}
+
+}}
+
+#endif
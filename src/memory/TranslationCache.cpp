@@ -0,0 +1,7 @@
+#include "TranslationCache.h"
+
+namespace __impl { namespace memory {
+
+Atomic TranslationCache::Generation_ = 0;
+
+}}
@@ -0,0 +1,125 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_TRANSLATIONCACHE_H_
+#define GMAC_MEMORY_TRANSLATIONCACHE_H_
+
+#include "config/common.h"
+#include "util/Atomics.h"
+#include "util/NonCopyable.h"
+
+namespace __impl {
+
+namespace core {
+class Mode;
+}
+
+namespace memory {
+
+/**
+ * Per-thread cache of host to accelerator address translations. Entries
+ * cover whole objects and are discarded when the global generation changes,
+ * which happens whenever an object is removed or gets a new accelerator
+ * address
+ */
+class GMAC_LOCAL TranslationCache : public util::NonCopyable {
+protected:
+    /** Translation of the host memory range of an object */
+    struct Entry {
+        /** Execution mode the translation is valid for */
+        const core::Mode *mode_;
+        /** Starting host address of the object */
+        hostptr_t start_;
+        /** Ending host address of the object */
+        hostptr_t end_;
+        /** Accelerator address of the start of the object */
+        accptr_t base_;
+        /** Generation when the entry was created */
+        unsigned generation_;
+    };
+
+    /** Number of entries in the cache */
+    static const unsigned Size_ = 8;
+
+    /** Current generation of all translations in the process */
+    static Atomic Generation_;
+
+    /** Cached translations */
+    Entry entries_[Size_];
+    /** Most recently used entry */
+    unsigned last_;
+    /** Entry to be replaced by the next insertion */
+    unsigned next_;
+
+public:
+    /** Default constructor */
+    TranslationCache();
+
+    /**
+     * Looks up the accelerator address of a host address
+     * \param mode Execution mode requesting the translation
+     * \param addr Host address to be translated
+     * \param acc Reference to store the accelerator address
+     * \return True if the translation was found in the cache
+     */
+    bool lookup(const core::Mode &mode, const hostptr_t addr, accptr_t &acc);
+
+    /**
+     * Inserts the translation of an object in the cache
+     * \param mode Execution mode the translation is valid for
+     * \param start Starting host address of the object
+     * \param size Size (in bytes) of the object
+     * \param base Accelerator address of the start of the object
+     * \param generation Generation read before translating the address
+     */
+    void insert(const core::Mode &mode, hostptr_t start, size_t size, accptr_t base,
+                unsigned generation);
+
+    /**
+     * Gets the current generation of translations. It must be read before
+     * looking up the objects whose translation is cached
+     * \return Current generation
+     */
+    static unsigned generation();
+
+    /**
+     * Discards the translations cached by all threads
+     */
+    static void invalidate();
+};
+
+}}
+
+#include "TranslationCache-impl.h"
+
+#endif
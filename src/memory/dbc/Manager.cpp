@@ -41,12 +41,12 @@ Manager::unmap(void *addr, size_t size)
 }
 #endif
 gmacError_t
-Manager::alloc(ModeImpl &mode, hostptr_t *addr, size_t size)
+Manager::alloc(ModeImpl &mode, hostptr_t *addr, size_t size, size_t blockSize)
 {
     // PRECONDITIONS
     REQUIRES(size > 0);
     // CALL IMPLEMENTATION
-    gmacError_t ret = Parent::alloc(mode, addr, size);
+    gmacError_t ret = Parent::alloc(mode, addr, size, blockSize);
     // POSTCONDITIONS
 
     return ret;
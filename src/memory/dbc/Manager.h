@@ -78,7 +78,7 @@ public:
      * \param size Size (in bytes) of shared memory to be allocated
      * \return Error code
      */
-    gmacError_t alloc(ModeImpl &mode, hostptr_t *addr, size_t size);
+    gmacError_t alloc(ModeImpl &mode, hostptr_t *addr, size_t size, size_t blockSize = 0);
 
     /**
      * Release shared memory
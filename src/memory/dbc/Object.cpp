@@ -5,8 +5,8 @@
 
 namespace __dbc { namespace memory {
 
-Object::Object(hostptr_t addr, size_t size) :
-    __impl::memory::Object(addr, size)
+Object::Object(hostptr_t addr, size_t size, size_t blockSize) :
+    __impl::memory::Object(addr, size, blockSize)
 {
 }
 
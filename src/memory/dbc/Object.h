@@ -42,7 +42,7 @@ class GMAC_LOCAL Object :
     DBC_TESTED(__impl::memory::Object)
 
 protected:
-	Object(hostptr_t addr, size_t size);
+	Object(hostptr_t addr, size_t size, size_t blockSize = 0);
     virtual ~Object();
 
     gmacError_t memoryOp(__impl::memory::Protocol::MemoryOp op, __impl::core::IOBuffer &buffer, size_t size, size_t bufferOffset, size_t objectOffset);
@@ -4,10 +4,11 @@
 #include "allocator/Slab.h"
 
 #include "memory/BlockGroup.h"
+#include "memory/Recorder.h"
+#include "memory/ReleasePool.h"
+#include "util/StagingCopy.h"
 
-#ifdef USE_VM
-//#include "protocol/Gather.h"
-#endif
+#include "protocol/Gather.h"
 #include "protocol/Lazy.h"
 
 #if defined(__GNUC__)
@@ -46,6 +47,9 @@ void Init()
     vm::Bitmap::Init();
 #endif
 #endif
+    ReleasePool::get();
+    util::StagingCopy::init();
+    Recorder::init();
 }
 
 Protocol *ProtocolInit(unsigned flags)
@@ -68,18 +72,19 @@ Protocol *ProtocolInit(unsigned flags)
                 memory::BlockGroup<protocol::lazy::BlockState> >(eager);
         }
     }
-#ifdef USE_VM
-    else if(strcasecmp(util::params::ParamProtocol, "Gather") == 0) {
-        if(0 != (flags & 0x1)) {
-            ret = new gmac::memory::protocol::Lazy<
-                memory::BlockGroup<protocol::lazy::BlockState> >(eager);
+    else if(strcasecmp(util::params::ParamProtocol, "RollingGather") == 0 ||
+            strcasecmp(util::params::ParamProtocol, "Gather") == 0) {
+        bool eager = strcasecmp(util::params::ParamProtocol, "RollingGather") == 0;
+#if !defined(USE_SUBBLOCK_TRACKING)
+        static bool warned = false;
+        if(warned == false) {
+            WARNING("Gather protocol built without subblock tracking: dirty blocks are sent whole");
+            warned = true;
         }
-        else {
-            ret = new gmac::memory::protocol::Lazy<
-                memory::BlockGroup<protocol::lazy::BlockState> >(eager);
-        }
-    }
 #endif
+        ret = new protocol::Gather<
+            memory::BlockGroup<protocol::lazy::BlockState> >(eager);
+    }
     else {
         FATAL("Memory Coherence Protocol not defined");
     }
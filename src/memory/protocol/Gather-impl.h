@@ -6,8 +6,8 @@
 namespace __impl { namespace memory { namespace protocol {
 
 template<typename T>
-inline Gather<T>::Gather(size_t limit) :
-    GatherBase(limit)
+inline Gather<T>::Gather(bool eager) :
+    GatherBase(eager)
 {}
 
 template<typename T>
@@ -15,20 +15,21 @@ inline Gather<T>::~Gather()
 {}
 
 template<typename T>
-inline memory::Object *Gather<T>::createObject(size_t size, hostptr_t cpuPtr, 
-                                               GmacProtection prot, unsigned flags)
+memory::Object *
+Gather<T>::createObject(core::Mode &current, size_t size, hostptr_t cpuPtr,
+                        GmacProtection prot, unsigned flags, size_t blockSize)
 {
-    // TODO: get mode as parameter
-    Object *ret = new T(*this, core::Mode::getCurrent(), cpuPtr, 
-		size, state(prot));
-	if(ret == NULL) return ret;
-	if(ret->valid() == false) {
-		ret->release();
-		return NULL;
-	}
-	Memory::protect(ret->addr(), ret->size(), prot);
-	return ret;
+    gmacError_t err;
+    Object *ret = new T(*this, current, cpuPtr,
+                        size, LazyBase::state(prot), err, blockSize);
+    if(ret == NULL) return ret;
+    if(err != gmacSuccess) {
+        ret->decRef();
+        return NULL;
+    }
+    return ret;
 }
 
 }}}
+
 #endif
@@ -17,11 +17,11 @@ inline Lazy<T>::~Lazy()
 template<typename T>
 memory::Object *
 Lazy<T>::createObject(core::Mode &current, size_t size, hostptr_t cpuPtr,
-                      GmacProtection prot, unsigned flags)
+                      GmacProtection prot, unsigned flags, size_t blockSize)
 {
     gmacError_t err;
     Object *ret = new T(*this, current, cpuPtr,
-                        size, LazyBase::state(prot), err);
+                        size, LazyBase::state(prot), err, blockSize);
     if(ret == NULL) return ret;
     if(err != gmacSuccess) {
         ret->decRef();
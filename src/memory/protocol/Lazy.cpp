@@ -5,8 +5,11 @@
 #include "config/config.h"
 
 #include "memory/Memory.h"
+#include "memory/ReleasePool.h"
 #include "memory/StateBlock.h"
 
+#include "WriteBack.h"
+
 #include "trace/Tracer.h"
 
 #ifdef DEBUG
@@ -26,12 +29,24 @@ namespace __impl { namespace memory { namespace protocol {
 LazyBase::LazyBase(bool eager) :
     gmac::util::Lock("LazyBase"),
     eager_(eager),
-    limit_(1)
+    limit_(1),
+    // The rolling limit evicts the oldest dirty blocks, which are only
+    // known if the list keeps a single FIFO order
+    dbl_(eager? 1: util::params::ParamDirtyShards),
+    writeBack_(NULL),
+    lastWrite_(NULL)
 {
+    // The thread is spawned now because blocks are queued for it from
+    // the fault handler, where no threads can be created
+    writeBack_ = new WriteBack(*this);
 }
 
 LazyBase::~LazyBase()
 {
+    delete writeBack_;
+    // Blocks still referenced here are destroyed with their objects
+    behind_.clear();
+    ahead_.clear();
 }
 
 lazy::State LazyBase::state(GmacProtection prot) const
@@ -49,6 +64,39 @@ lazy::State LazyBase::state(GmacProtection prot) const
 }
 
 
+bool LazyBase::applyAcquire(lazy::Block &block)
+{
+    if(block.pendingAcquire() == false) return false;
+    block.updateEpoch();
+    switch(block.getState()) {
+    case lazy::Invalid:
+    case lazy::ReadOnly:
+        // The object memory was already protected as a whole
+        block.setState(lazy::Invalid);
+        // The accelerator might have overwritten the constant
+        block.clearFill();
+        cbl_.remove(block);
+        break;
+    case lazy::Dirty:
+        WARNING("Block modified before gmacSynchronize: %p", block.addr());
+        if(block.unprotect() < 0)
+            FATAL("Unable to set memory permissions");
+        return true;
+    case lazy::HostOnly:
+        if(block.unprotect() < 0)
+            FATAL("Unable to set memory permissions");
+        return true;
+    }
+    return false;
+}
+
+lazy::Block &LazyBase::getBlock(Block &b)
+{
+    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    applyAcquire(block);
+    return block;
+}
+
 void LazyBase::deleteObject(Object &obj)
 {
     obj.decRef();
@@ -74,6 +122,9 @@ gmacError_t LazyBase::signalRead(Block &b, hostptr_t addr)
     lazy::Block &block = dynamic_cast<lazy::Block &>(b);
     gmacError_t ret = gmacSuccess;
 
+    // The fault might only come from acquiring the whole object
+    if(applyAcquire(block) == true) goto exit_func;
+
     block.read(addr);
     if(block.getState() == lazy::HostOnly) {
         WARNING("Signal on HostOnly block - Changing protection and continuing");
@@ -84,7 +135,9 @@ gmacError_t LazyBase::signalRead(Block &b, hostptr_t addr)
     }
 
     if (block.getState() == lazy::Invalid) {
-        ret = block.syncToHost();
+        // Constant blocks are filled in place instead of being transferred
+        if(block.hasFill()) ret = block.fillHost();
+        else ret = block.syncToHost();
         if(ret != gmacSuccess) goto exit_func;
         block.setState(lazy::ReadOnly);
     }
@@ -103,13 +156,17 @@ gmacError_t LazyBase::signalWrite(Block &b, hostptr_t addr)
     lazy::Block &block = dynamic_cast<lazy::Block &>(b);
     gmacError_t ret = gmacSuccess;
 
+    // The fault might only come from acquiring the whole object
+    if(applyAcquire(block) == true) goto exit_func;
+
     block.write(addr);
     switch (block.getState()) {
     case lazy::Dirty:
         block.unprotect();
         goto exit_func; // Somebody already fixed it
     case lazy::Invalid:
-        ret = block.syncToHost();
+        if(block.hasFill()) ret = block.fillHost();
+        else ret = block.syncToHost();
         if(ret != gmacSuccess) goto exit_func;
         break;
     case lazy::HostOnly:
@@ -121,6 +178,8 @@ gmacError_t LazyBase::signalWrite(Block &b, hostptr_t addr)
     block.unprotect();
     addDirty(block);
     TRACE(LOCAL,"Setting block %p to dirty state", block.addr());
+    if(util::params::ParamWriteBehind == true ||
+       block.advice() == GMAC_ADVICE_STREAMING) writeBehind(block, addr);
     //ret = addDirty(block);
 exit_func:
     trace::ExitCurrentFunction();
@@ -130,7 +189,7 @@ exit_func:
 gmacError_t LazyBase::acquire(Block &b, GmacProtection &prot)
 {
     gmacError_t ret = gmacSuccess;
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     switch(block.getState()) {
     case lazy::Invalid:
     case lazy::ReadOnly:
@@ -142,6 +201,9 @@ gmacError_t LazyBase::acquire(Block &b, GmacProtection &prot)
             block.setState(lazy::Invalid);
             //block.acquired();
 #endif
+            // The accelerator might have overwritten the constant
+            block.clearFill();
+            cbl_.remove(block);
         }
 
         break;
@@ -154,12 +216,22 @@ gmacError_t LazyBase::acquire(Block &b, GmacProtection &prot)
     return ret;
 }
 
+gmacError_t LazyBase::acquireObject(Object &obj, GmacProtection &prot)
+{
+    if (prot != GMAC_PROT_READWRITE && prot != GMAC_PROT_WRITE) return gmacSuccess;
+    // A single call protects all the blocks in the object
+    TRACE(LOCAL, "Protecting object %p ("FMT_SIZE" bytes)", obj.addr(), obj.size());
+    if(Memory::protect(obj.addr(), obj.size(), GMAC_PROT_NONE) < 0)
+        FATAL("Unable to set memory permissions");
+    return gmacSuccess;
+}
+
 #ifdef USE_VM
 gmacError_t LazyBase::acquireWithBitmap(Block &b)
 {
     /// \todo Change this to the new BlockState
     gmacError_t ret = gmacSuccess;
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     switch(block.getState()) {
     case lazy::Invalid:
     case lazy::ReadOnly:
@@ -185,7 +257,7 @@ gmacError_t LazyBase::acquireWithBitmap(Block &b)
 
 gmacError_t LazyBase::mapToAccelerator(Block &b)
 {
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     ASSERTION(block.getState() == lazy::HostOnly);
     TRACE(LOCAL,"Mapping block to accelerator %p", block.addr());
     block.setState(lazy::Dirty);
@@ -195,7 +267,7 @@ gmacError_t LazyBase::mapToAccelerator(Block &b)
 
 gmacError_t LazyBase::unmapFromAccelerator(Block &b)
 {
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     TRACE(LOCAL,"Unmapping block from accelerator %p", block.addr());
     gmacError_t ret = gmacSuccess;
     switch(block.getState()) {
@@ -204,45 +276,225 @@ gmacError_t LazyBase::unmapFromAccelerator(Block &b)
     case lazy::ReadOnly:
         break;
     case lazy::Invalid:
-        ret = block.syncToHost();
+        if(block.hasFill()) ret = block.fillHost();
+        else ret = block.syncToHost();
         if(ret != gmacSuccess) break;
     }
     if(block.unprotect() < 0)
         FATAL("Unable to set memory permissions");
     block.setState(lazy::HostOnly);
+    block.clearFill();
     dbl_.remove(block);
+    cbl_.remove(block);
     return ret;
 }
 
 void
 LazyBase::addDirty(lazy::Block &block)
 {
-    lock();
-    dbl_.push(block);
+    // The dirty list has its own locks, so the protocol lock is only needed
+    // to keep the rolling limit
     if (eager_ == false) {
-        unlock();
+        dbl_.push(block);
         return;
-    } else {
-        if (block.getCacheWriteFaults() >= __impl::util::params::ParamRollThreshold) {
-            block.resetCacheWriteFaults();
-            TRACE(LOCAL, "Increasing dirty block cache limit -> %u", limit_ + 1);
-            limit_++;
+    }
+    lock();
+    dbl_.push(block);
+    if (block.getCacheWriteFaults() >= __impl::util::params::ParamRollThreshold) {
+        block.resetCacheWriteFaults();
+        TRACE(LOCAL, "Increasing dirty block cache limit -> %u", limit_ + 1);
+        limit_++;
+    }
+    // Let the write-back thread drain the list unless it falls too far behind
+    if (util::params::ParamRollWriteBack == true &&
+        dbl_.size() <= limit_ * util::params::ParamRollHighWater) {
+        if (dbl_.size() <= limit_ || writeBack_->signal() == true) {
+            unlock();
+            return;
         }
     }
     while (dbl_.size() > limit_) {
-        Block &b = dbl_.front();
-        b.coherenceOp(&Protocol::release);
+        Block *b = dbl_.front();
+        if (b == NULL) break;
+        b->coherenceOp(&Protocol::release);
+        b->decRef();
     }
     unlock();
     return;
 }
 
+void
+LazyBase::writeBehind(lazy::Block &block, hostptr_t addr)
+{
+    lock();
+    lazy::Block *last = lastWrite_;
+    lastWrite_ = &block;
+    block.incRef();
+    if (last == NULL) {
+        unlock();
+        return;
+    }
+
+    // The writer has moved past the previous block if it faults at the
+    // beginning of the block that follows it
+    bool queued = false;
+    if (last != &block && last->addr() + last->size() == block.addr() &&
+        size_t(addr - block.addr()) < util::params::ParamSubBlockSize &&
+        last->getState() == lazy::Dirty && last->isSequential() == true) {
+        TRACE(LOCAL, "Writing behind block %p", last->addr());
+        behind_.push_back(last);
+        queued = true;
+    }
+    unlock();
+
+    if (queued == false) {
+        last->decRef();
+        return;
+    }
+    if (writeBack_->signal() == false) {
+        // Leave the block dirty until the next release
+        lock();
+        behind_.remove(last);
+        unlock();
+        last->decRef();
+    }
+}
+
+gmacError_t
+LazyBase::prefetch(Block &b, GmacPrefetchDestination &dst)
+{
+    lazy::Block &block = getBlock(b);
+    std::list<Block *> *queue = NULL;
+    switch(dst) {
+    case GMAC_PREFETCH_HOST:
+        // Only invalid blocks lack an updated host copy
+        if(block.getState() != lazy::Invalid) return gmacSuccess;
+        queue = &ahead_;
+        break;
+    case GMAC_PREFETCH_ACCELERATOR:
+        if(block.getState() != lazy::Dirty) return gmacSuccess;
+        queue = &behind_;
+        break;
+    }
+    TRACE(LOCAL, "Prefetching block %p to the %s", block.addr(),
+          dst == GMAC_PREFETCH_HOST? "host": "accelerator");
+    block.incRef();
+    lock();
+    queue->push_back(&block);
+    unlock();
+    if (writeBack_->signal() == true) return gmacSuccess;
+
+    // There is no run-time thread, so move the block now
+    lock();
+    queue->remove(&block);
+    unlock();
+    block.decRef();
+    if(dst == GMAC_PREFETCH_HOST) return toHost(block);
+    return release(block);
+}
+
+gmacError_t
+LazyBase::mapFile(Block &b, FileMapping &mapping)
+{
+    lazy::Block &block = getBlock(b);
+    if(block.getState() == lazy::HostOnly) return gmacErrorInvalidValue;
+    TRACE(LOCAL, "Mapping block %p to file offset "FMT_SIZE, block.addr(), size_t(mapping.offset_));
+    // The file is read on the first access to any of the copies of the block
+    if(block.protect(GMAC_PROT_NONE) < 0)
+        FATAL("Unable to set memory permissions");
+    if(block.getState() == lazy::Dirty) dbl_.remove(block);
+    block.setState(lazy::Invalid);
+    if(block.hasAcceleratorFill() == false) cbl_.push(block);
+    block.setFile(mapping.fd_, mapping.offset_, mapping.size_);
+    return gmacSuccess;
+}
+
+gmacError_t
+LazyBase::writeFile(Block &b, FileMapping &mapping)
+{
+    lazy::Block &block = getBlock(b);
+    // Blocks not read yet still hold the file contents
+    if(block.hasFileFill() == true && block.getState() == lazy::Invalid) return gmacSuccess;
+    // Blocks past the end of the mapping do not belong to the file
+    if(mapping.size_ == 0) return gmacSuccess;
+    gmacError_t ret = toHost(block);
+    if(ret != gmacSuccess) return ret;
+    TRACE(LOCAL, "Writing block %p to file offset "FMT_SIZE, block.addr(), size_t(mapping.offset_));
+    return block.writeFile(mapping.fd_, mapping.offset_, mapping.size_);
+}
+
+void
+LazyBase::writeBack()
+{
+    // Blocks completed by sequential writers go first
+    while (true) {
+        lock();
+        if (behind_.empty() == true) {
+            unlock();
+            break;
+        }
+        Block &b = *behind_.front();
+        behind_.pop_front();
+        unlock();
+        // The block is only sent if it is still dirty, and blocks deleted
+        // since they were queued are left as host-only
+        gmacError_t ret = b.coherenceOp(&Protocol::release);
+        ASSERTION(ret == gmacSuccess);
+        b.decRef();
+    }
+
+    // Blocks prefetched to the host
+    while (true) {
+        lock();
+        if (ahead_.empty() == true) {
+            unlock();
+            break;
+        }
+        Block &b = *ahead_.front();
+        ahead_.pop_front();
+        unlock();
+        // The block is only fetched if it is still invalid
+        gmacError_t ret = b.coherenceOp(&Protocol::toHost);
+        ASSERTION(ret == gmacSuccess);
+        b.decRef();
+    }
+
+    if (eager_ == false || util::params::ParamRollWriteBack == false) return;
+    while (true) {
+        lock();
+        if (dbl_.size() <= limit_) {
+            unlock();
+            return;
+        }
+        Block *b = dbl_.front();
+        if (b == NULL) {
+            unlock();
+            return;
+        }
+        unlock();
+        // The protocol lock is not held during the transfer, so faulting
+        // threads can keep adding blocks to the list
+        gmacError_t ret = b->coherenceOp(&Protocol::release);
+        ASSERTION(ret == gmacSuccess);
+        b->decRef();
+    }
+}
+
 gmacError_t LazyBase::releaseAll()
 {
+    // Write-backs take the protocol lock, so wait for them before taking it
+    writeBack_->wait();
+
     // We need to make sure that this operations is done before we
     // let other modes to proceed
     lock();
 
+    // Sequential streams do not continue across releases
+    if (lastWrite_ != NULL) {
+        lastWrite_->decRef();
+        lastWrite_ = NULL;
+    }
+
     // Shrink cache size if we have not filled it
     if (eager_ == true && dbl_.size() < limit_ && limit_ > 1) {
         limit_ /= 2;
@@ -251,10 +503,33 @@ gmacError_t LazyBase::releaseAll()
     // If the list of objects to be released is empty, assume a complete flush
     TRACE(LOCAL, "Releasing all blocks");
 
+    // Spread large flushes across the release threads
+    ReleasePool *pool = ReleasePool::get();
+    if(pool != NULL && dbl_.size() >= util::params::ParamReleaseMinBlocks) {
+        std::vector<Block *> blocks;
+        dbl_.snapshot(blocks);
+        gmacError_t ret = pool->run(blocks, &Protocol::release);
+        ASSERTION(ret == gmacSuccess);
+        // Released blocks leave the list, so only the snapshot keeps them
+        // alive until the pool is done with them
+        std::vector<Block *>::iterator i;
+        for(i = blocks.begin(); i != blocks.end(); ++i) (*i)->decRef();
+    }
+
     while(dbl_.empty() == false) {
-        Block &b = dbl_.front();
+        Block *b = dbl_.front();
+        if(b == NULL) break;
+        gmacError_t ret = b->coherenceOp(&Protocol::release);
+        ASSERTION(ret == gmacSuccess);
+        b->decRef();
+    }
+
+    // Constant blocks are filled in the accelerator, without any transfer
+    while(cbl_.empty() == false) {
+        Block &b = cbl_.front();
         gmacError_t ret = b.coherenceOp(&Protocol::release);
         ASSERTION(ret == gmacSuccess);
+        b.decRef();
     }
 
     unlock();
@@ -266,6 +541,11 @@ gmacError_t LazyBase::flushDirty()
     return releaseAll();
 }
 
+size_t LazyBase::dirtyBlocks() const
+{
+    return dbl_.size();
+}
+
 
 gmacError_t LazyBase::releasedAll()
 {
@@ -284,30 +564,85 @@ gmacError_t LazyBase::releasedAll()
 
 gmacError_t LazyBase::release(Block &b)
 {
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     TRACE(LOCAL,"Releasing block %p", block.addr());
     gmacError_t ret = gmacSuccess;
+    bool drop;
     switch(block.getState()) {
     case lazy::Dirty:
-        if(block.protect(GMAC_PROT_READ) < 0)
+        // Blocks preferred on the accelerator drop their host copy
+        drop = block.advice() == GMAC_ADVICE_ACCELERATOR_PREFERRED;
+        if(block.protect(drop? GMAC_PROT_NONE: GMAC_PROT_READ) < 0)
             FATAL("Unable to set memory permissions");
-        ret = block.syncToAccelerator();
+        // Parts of the block not written by the host still hold the fill
+        ret = releaseFill(block);
         if(ret != gmacSuccess) break;
-        block.setState(lazy::ReadOnly);
+        ret = updateAccelerator(block);
+        if(ret != gmacSuccess) break;
+        block.clearFill();
+        block.setState(drop? lazy::Invalid: lazy::ReadOnly);
         block.released();
         dbl_.remove(block);
         break;
     case lazy::Invalid:
     case lazy::ReadOnly:
+        ret = releaseFill(block);
+        break;
     case lazy::HostOnly:
         break;
     }
     return ret;
 }
 
-gmacError_t LazyBase::deleteBlock(Block &block)
+gmacError_t LazyBase::updateAccelerator(lazy::Block &block)
+{
+    return block.syncToAccelerator();
+}
+
+gmacError_t LazyBase::releaseFill(lazy::Block &block)
+{
+    if(block.hasAcceleratorFill() == false) return gmacSuccess;
+    gmacError_t ret = block.fillAccelerator();
+    if(ret != gmacSuccess) return ret;
+    cbl_.remove(block);
+    // File fills also load the host copy
+    if(block.hasFill() == false && block.getState() == lazy::Invalid) {
+        if(block.protect(GMAC_PROT_READ) < 0)
+            FATAL("Unable to set memory permissions");
+        block.setState(lazy::ReadOnly);
+    }
+    return gmacSuccess;
+}
+
+gmacError_t LazyBase::flushFill(lazy::Block &block)
+{
+    if(block.hasFill() == false) return gmacSuccess;
+    TRACE(LOCAL,"Flushing fill of block %p", block.addr());
+    gmacError_t ret = block.flushFill();
+    if(ret != gmacSuccess) return ret;
+    cbl_.remove(block);
+    // Both copies hold the same data now
+    if(block.getState() == lazy::Invalid) {
+        if(block.protect(GMAC_PROT_READ) < 0)
+            FATAL("Unable to set memory permissions");
+        block.setState(lazy::ReadOnly);
+    }
+    return gmacSuccess;
+}
+
+gmacError_t LazyBase::deleteBlock(Block &b)
 {
-    dbl_.remove(dynamic_cast<lazy::Block &>(block));
+    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    TRACE(LOCAL,"Deleting block %p", block.addr());
+    // The write-back thread and the write-behind and prefetch queues might
+    // still hold the block after its memory is released. Later releases
+    // and transfers to the host do nothing on host-only blocks, and the
+    // object of the block is not there to be acquired anymore
+    block.detachEpoch();
+    block.setState(lazy::HostOnly);
+    block.clearFill();
+    dbl_.remove(block);
+    cbl_.remove(block);
     return gmacSuccess;
 }
 
@@ -315,10 +650,11 @@ gmacError_t LazyBase::toHost(Block &b)
 {
     TRACE(LOCAL,"Sending block to host: %p", b.addr());
     gmacError_t ret = gmacSuccess;
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     switch(block.getState()) {
     case lazy::Invalid:
-        ret = block.syncToHost();
+        if(block.hasFill()) ret = block.fillHost();
+        else ret = block.syncToHost();
         TRACE(LOCAL,"Invalid block");
         if(block.protect(GMAC_PROT_READ) < 0)
             FATAL("Unable to set memory permissions");
@@ -338,12 +674,44 @@ gmacError_t LazyBase::toHost(Block &b)
     return ret;
 }
 
+gmacError_t LazyBase::invalidate(Block &b)
+{
+    lazy::Block &block = getBlock(b);
+    TRACE(LOCAL,"Invalidating block %p", block.addr());
+    switch(block.getState()) {
+    case lazy::HostOnly:
+        return gmacSuccess;
+    case lazy::Dirty:
+        dbl_.remove(block);
+    case lazy::ReadOnly:
+        if(block.protect(GMAC_PROT_NONE) < 0)
+            FATAL("Unable to set memory permissions");
+        block.setState(lazy::Invalid);
+    case lazy::Invalid:
+        break;
+    }
+    block.clearFill();
+    cbl_.remove(block);
+    return gmacSuccess;
+}
+
+gmacError_t LazyBase::writeProtect(Block &b)
+{
+    lazy::Block &block = getBlock(b);
+    // Other states already trap host writes, and HostOnly blocks are not shared
+    if(block.getState() == lazy::Dirty) {
+        if(block.protect(GMAC_PROT_READ) < 0)
+            FATAL("Unable to set memory permissions");
+    }
+    return gmacSuccess;
+}
+
 #if 0
 gmacError_t LazyBase::toAccelerator(Block &b)
 {
     TRACE(LOCAL,"Sending block to accelerator: %p", b.addr());
     gmacError_t ret = gmacSuccess;
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
     switch(block.getState()) {
     case lazy::Dirty:
         TRACE(LOCAL,"Dirty block");
@@ -370,8 +738,9 @@ gmacError_t LazyBase::toAccelerator(Block &b)
 gmacError_t LazyBase::copyToBuffer(Block &b, core::IOBuffer &buffer, size_t size,
                                    size_t bufferOff, size_t blockOff)
 {
-    gmacError_t ret = gmacSuccess;
-    const lazy::Block &block = dynamic_cast<const lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
+    gmacError_t ret = flushFill(block);
+    if(ret != gmacSuccess) return ret;
     switch(block.getState()) {
     case lazy::Invalid:
         ret = block.copyToBuffer(buffer, bufferOff, blockOff, size, lazy::Block::ACCELERATOR);
@@ -389,7 +758,14 @@ gmacError_t LazyBase::copyFromBuffer(Block &b, core::IOBuffer &buffer, size_t si
                                      size_t bufferOff, size_t blockOff)
 {
     gmacError_t ret = gmacSuccess;
-    lazy::Block &block = dynamic_cast<lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
+    if(block.getState() == lazy::Invalid && size == block.size() && blockOff == 0) {
+        // The whole constant is overwritten in the accelerator
+        block.clearFill();
+        cbl_.remove(block);
+    }
+    ret = flushFill(block);
+    if(ret != gmacSuccess) return ret;
     switch(block.getState()) {
     case lazy::Invalid:
         ret = block.copyFromBuffer(blockOff, buffer, bufferOff, size, lazy::Block::ACCELERATOR);
@@ -427,10 +803,25 @@ gmacError_t LazyBase::copyFromBuffer(Block &b, core::IOBuffer &buffer, size_t si
     return ret;
 }
 
-gmacError_t LazyBase::memset(const Block &b, int v, size_t size, size_t blockOffset)
+gmacError_t LazyBase::memset(Block &b, int v, size_t size, size_t blockOffset)
 {
     gmacError_t ret = gmacSuccess;
-    const lazy::Block &block = dynamic_cast<const lazy::Block &>(b);
+    lazy::Block &block = getBlock(b);
+    if(block.getState() != lazy::HostOnly) {
+        if(size == block.size() && blockOffset == 0) {
+            // Defer the fill until any of the copies of the block is used
+            TRACE(LOCAL,"Deferring fill of block %p", block.addr());
+            if(block.protect(GMAC_PROT_NONE) < 0)
+                FATAL("Unable to set memory permissions");
+            if(block.getState() == lazy::Dirty) dbl_.remove(block);
+            block.setState(lazy::Invalid);
+            if(block.hasAcceleratorFill() == false) cbl_.push(block);
+            block.setFill(v);
+            return gmacSuccess;
+        }
+        ret = flushFill(block);
+        if(ret != gmacSuccess) return ret;
+    }
     switch(block.getState()) {
     case lazy::Invalid:
         ret = block.memset(v, size, blockOffset, lazy::Block::ACCELERATOR);
@@ -460,10 +851,13 @@ LazyBase::isInAccelerator(Block &b)
 gmacError_t
 LazyBase::copyBlockToBlock(Block &d, size_t dstOffset, Block &s, size_t srcOffset, size_t count)
 {
-    lazy::Block &dst = dynamic_cast<lazy::Block &>(d);
-    lazy::Block &src = dynamic_cast<lazy::Block &>(s);
+    lazy::Block &dst = getBlock(d);
+    lazy::Block &src = getBlock(s);
 
-    gmacError_t ret = gmacSuccess;
+    gmacError_t ret = flushFill(dst);
+    if (ret != gmacSuccess) return ret;
+    ret = flushFill(src);
+    if (ret != gmacSuccess) return ret;
 
     if ((src.getState() == lazy::Invalid || src.getState() == lazy::ReadOnly) &&
         dst.getState() == lazy::Invalid) {
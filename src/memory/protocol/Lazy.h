@@ -55,7 +55,7 @@ public:
 
     // Protocol Interface
     memory::Object *createObject(core::Mode &current, size_t size, hostptr_t cpuPtr,
-                                 GmacProtection prot, unsigned flags);
+                                 GmacProtection prot, unsigned flags, size_t blockSize = 0);
 };
 
 }}}
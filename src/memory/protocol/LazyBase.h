@@ -34,6 +34,8 @@ WITH THE SOFTWARE.  */
 #ifndef GMAC_MEMORY_PROTOCOL_LAZYBASE_H_
 #define GMAC_MEMORY_PROTOCOL_LAZYBASE_H_
 
+#include <list>
+
 #include "config/common.h"
 #include "include/gmac/types.h"
 
@@ -42,6 +44,7 @@ WITH THE SOFTWARE.  */
 #include "util/Lock.h"
 
 #include "common/BlockList.h"
+#include "common/ShardedBlockList.h"
 #include "lazy/BlockState.h"
 
 namespace __impl {
@@ -57,6 +60,9 @@ class Object;
 template <typename State> class StateBlock;
 
 namespace protocol {
+
+class WriteBack;
+
 /**
  * A lazy memory coherence protocol.
  *
@@ -82,12 +88,82 @@ protected:
     /// Maximum number of blocks in dirty state
     size_t limit_;
 
-    /// Dirty block list. List of all memory blocks in Dirty state
-    BlockList dbl_;
+    /// Dirty block list. List of all memory blocks in Dirty state. It is
+    /// sharded so faults on different blocks do not serialize on its lock
+    ShardedBlockList dbl_;
+
+    /// Constant block list. Blocks whose accelerator copy is pending a fill
+    BlockList cbl_;
+
+    /// Thread writing back dirty blocks and prefetching blocks
+    WriteBack *writeBack_;
+
+    /// Last block that became dirty, used to detect sequential writers
+    lazy::Block *lastWrite_;
+
+    /// Blocks left behind by sequential writers or prefetched to the
+    /// accelerator, to be sent by writeBack_
+    std::list<Block *> behind_;
+
+    /// Blocks prefetched to the host, to be brought back by writeBack_
+    std::list<Block *> ahead_;
 
     /// Add a new block to the Dirty Block List
     void addDirty(lazy::Block &block);
 
+    /**
+     * Queues the previous dirty block for write-behind if the writer has
+     * moved from its end to the beginning of the given block
+     *
+     * \param block Block that has just become dirty
+     * \param addr Faulting address
+     */
+    void writeBehind(lazy::Block &block, hostptr_t addr);
+
+    /**
+     * Writes the pending constant fill of a block to the accelerator memory.
+     * The fill is kept, so the host copy can still be filled without a transfer
+     *
+     * \param block Block to be filled in the accelerator
+     * \return Error code
+     */
+    gmacError_t releaseFill(lazy::Block &block);
+
+    /**
+     * Writes the pending constant fill of a block to both the host and the
+     * accelerator memory, so the block can be accessed as a regular block
+     *
+     * \param block Block to be filled
+     * \return Error code
+     */
+    gmacError_t flushFill(lazy::Block &block);
+
+    /**
+     * Sends the contents of a dirty block to the accelerator memory. Called
+     * by release once the block has been protected and its fill released
+     *
+     * \param block Dirty block to be sent
+     * \return Error code
+     */
+    virtual gmacError_t updateAccelerator(lazy::Block &block);
+
+    /**
+     * Applies the last acquire of the block object to the block state, if
+     * it was acquired as a whole after the block was last used
+     *
+     * \param block Block to be updated
+     * \return True if the block memory protection had to be restored
+     */
+    bool applyAcquire(lazy::Block &block);
+
+    /**
+     * Gets the protocol view of a block, with any pending acquire applied
+     *
+     * \param block Block to be used by the protocol
+     * \return Lazy block
+     */
+    lazy::Block &getBlock(Block &block);
+
     /** Default constructor
      *
      * \param eager Tells if protocol uses eager update
@@ -109,6 +185,8 @@ public:
 
     TESTABLE gmacError_t acquire(Block &block, GmacProtection &prot);
 
+    gmacError_t acquireObject(Object &object, GmacProtection &prot);
+
     TESTABLE gmacError_t release(Block &block);
 
 #ifdef USE_VM
@@ -126,6 +204,16 @@ public:
 
     TESTABLE gmacError_t toHost(Block &block);
 
+    gmacError_t invalidate(Block &block);
+
+    gmacError_t writeProtect(Block &block);
+
+    gmacError_t prefetch(Block &block, GmacPrefetchDestination &dst);
+
+    gmacError_t mapFile(Block &block, FileMapping &mapping);
+
+    gmacError_t writeFile(Block &block, FileMapping &mapping);
+
 #if 0
     gmacError_t toAccelerator(Block &block);
 #endif
@@ -136,15 +224,25 @@ public:
     TESTABLE gmacError_t copyFromBuffer(Block &block, core::IOBuffer &buffer, size_t size,
                                         size_t bufferOffset, size_t blockOffset);
 
-    TESTABLE gmacError_t memset(const Block &block, int v, size_t size,
+    TESTABLE gmacError_t memset(Block &block, int v, size_t size,
                                 size_t blockOffset);
 
     TESTABLE gmacError_t flushDirty();
 
+    size_t dirtyBlocks() const;
+
     //bool isInAccelerator(Block &block);
     TESTABLE gmacError_t copyBlockToBlock(Block &d, size_t dstOffset, Block &s, size_t srcOffset, size_t count);
 
     gmacError_t dump(Block &block, std::ostream &out, common::Statistic stat);
+
+    /**
+     * Releases the blocks queued for write-behind, brings back the blocks
+     * prefetched to the host, and releases the oldest dirty blocks until the
+     * number of dirty blocks is within the eager update limit. Used by the
+     * write-back thread
+     */
+    void writeBack();
 };
 
 }}}
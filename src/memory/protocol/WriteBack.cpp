@@ -0,0 +1,112 @@
+#if defined(POSIX)
+#include <pthread.h>
+#endif
+
+#include "WriteBack.h"
+#include "LazyBase.h"
+
+#include "util/Logger.h"
+
+namespace __impl { namespace memory { namespace protocol {
+
+WriteBack::WriteBack(LazyBase &protocol) :
+    gmac::util::Lock("WriteBack"),
+    protocol_(protocol),
+    started_(false),
+    exit_(false),
+    pending_(false),
+    busy_(false),
+    waiters_(0),
+    work_(0),
+    idle_(0),
+    done_(0)
+{
+    // Faulting threads write back the blocks themselves if there is no thread
+    if(start() != gmacSuccess) exit_ = true;
+}
+
+WriteBack::~WriteBack()
+{
+    lock();
+    if(started_ == false) {
+        unlock();
+        return;
+    }
+    exit_ = true;
+    unlock();
+    work_.post();
+    done_.wait();
+}
+
+gmacError_t WriteBack::start()
+{
+#if defined(POSIX)
+    pthread_t tid;
+    if(pthread_create(&tid, NULL, worker, this) != 0) {
+        WARNING("Unable to create write-back thread");
+        return gmacErrorUnknown;
+    }
+    pthread_detach(tid);
+    started_ = true;
+    return gmacSuccess;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+void *WriteBack::worker(void *arg)
+{
+    WriteBack &writeBack = *static_cast<WriteBack *>(arg);
+    while(true) {
+        writeBack.work_.wait();
+        writeBack.lock();
+        if(writeBack.exit_ == true) {
+            writeBack.unlock();
+            break;
+        }
+        writeBack.pending_ = false;
+        writeBack.busy_ = true;
+        writeBack.unlock();
+
+        writeBack.protocol_.writeBack();
+
+        writeBack.lock();
+        writeBack.busy_ = false;
+        // Requests arrived while busy are served before waking up waiters
+        if(writeBack.pending_ == false) {
+            for(; writeBack.waiters_ > 0; writeBack.waiters_--) writeBack.idle_.post();
+        }
+        writeBack.unlock();
+    }
+    writeBack.done_.post();
+    return NULL;
+}
+
+bool WriteBack::signal()
+{
+    lock();
+    if(exit_ == true) {
+        unlock();
+        return false;
+    }
+    if(pending_ == false) {
+        pending_ = true;
+        work_.post();
+    }
+    unlock();
+    return true;
+}
+
+void WriteBack::wait()
+{
+    lock();
+    if(busy_ == false && pending_ == false) {
+        unlock();
+        return;
+    }
+    waiters_++;
+    unlock();
+    idle_.wait();
+}
+
+}}}
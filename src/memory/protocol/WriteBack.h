@@ -0,0 +1,114 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_PROTOCOL_WRITEBACK_H_
+#define GMAC_MEMORY_PROTOCOL_WRITEBACK_H_
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "util/Lock.h"
+#include "util/Semaphore.h"
+
+namespace __impl { namespace memory { namespace protocol {
+
+class LazyBase;
+
+/**
+ * Run-time thread that writes dirty blocks back to the accelerator on behalf
+ * of the Rolling protocol, so faulting threads do not wait for the transfers
+ * to finish
+ */
+class GMAC_LOCAL WriteBack : protected gmac::util::Lock {
+protected:
+    /** Protocol whose dirty blocks are written back */
+    LazyBase &protocol_;
+
+    /** Whether the thread has been already spawned */
+    bool started_;
+    /** Tells the thread to exit */
+    bool exit_;
+    /** Whether there is a wake-up request not yet taken by the thread */
+    bool pending_;
+    /** Whether the thread is writing back blocks */
+    bool busy_;
+    /** Number of threads waiting for the in-flight write-backs */
+    unsigned waiters_;
+
+    /** Posted to wake up the thread */
+    util::Semaphore work_;
+    /** Posted once per waiter when the thread becomes idle */
+    util::Semaphore idle_;
+    /** Posted by the thread when it exits */
+    util::Semaphore done_;
+
+    /**
+     * Spawns the write-back thread
+     * \return Error code
+     */
+    gmacError_t start();
+
+    /**
+     * Entry point for the write-back thread
+     * \param arg Write-back object the thread belongs to
+     */
+    static void *worker(void *arg);
+
+public:
+    /**
+     * Creates a write-back object for a protocol and spawns its thread. The
+     * thread is not spawned on demand because it is signaled from the fault
+     * handler
+     * \param protocol Protocol whose dirty blocks are written back
+     */
+    WriteBack(LazyBase &protocol);
+
+    /** Stops the write-back thread */
+    ~WriteBack();
+
+    /**
+     * Requests the thread to write back dirty blocks. The call does not wait
+     * for the transfers
+     * \return True if the thread will serve the request, false if the
+     * thread cannot be used
+     */
+    bool signal();
+
+    /**
+     * Waits until the thread has no requests and no write-back in flight
+     */
+    void wait();
+};
+
+}}}
+
+#endif
@@ -46,21 +46,45 @@ inline void BlockList::push(Block &block)
 
 inline Block &BlockList::front()
 {
-    ASSERTION(Parent::empty() == false);
     lock();
+    ASSERTION(Parent::empty() == false);
     Block *ret = Parent::front();
-    unlock();
     ASSERTION(ret != NULL);
-    ret->decRef();
+    // The block might be removed from the list as soon as it is unlocked
+    ret->incRef();
+    unlock();
     return *ret;
 }
 
-inline void BlockList::remove(Block &block)
+inline void BlockList::snapshot(std::vector<Block *> &blocks)
+{
+    size_t first = blocks.size();
+    lock();
+    blocks.reserve(first + Parent::size());
+    Parent::const_iterator i;
+    for(i = Parent::begin(); i != Parent::end(); ++i) {
+        (*i)->incRef();
+        blocks.push_back(*i);
+    }
+    unlock();
+}
+
+inline bool BlockList::remove(Block &block)
 {
+    unsigned erased = 0;
     lock();
-    Parent::remove(&block);
+    Parent::iterator i = Parent::begin();
+    while(i != Parent::end()) {
+        if(*i == &block) {
+            i = Parent::erase(i);
+            erased++;
+        }
+        else ++i;
+    }
     unlock();
-    return;
+    // The caller holds its own reference to the block
+    for(unsigned n = 0; n < erased; n++) block.decRef();
+    return erased > 0;
 }
 
 }}}
@@ -61,6 +61,9 @@ class GMAC_LOCAL BlockList :
 protected:
     typedef std::list<Block *> Parent;
 
+    // Sharded lists update their size with the shard locked
+    friend class ShardedBlockList;
+
 public:
     /// Default constructor
     BlockList();
@@ -80,23 +83,34 @@ public:
      */
     size_t size() const;
 
-    /** Add a block to the end of list
+    /** Add a block to the end of list. The list holds a reference to the
+     * block until it is removed
      *
      * \param block Block to be addded to the end of list
      */
     void push(Block &block);
 
-    /** Return the first Block in the list
+    /** Return the first Block in the list. The block is not removed from
+     * the list, and the caller must release the reference it gets
      *
      * \return Block from extracted from the begining of the list
      */
     Block &front();
 
-    /** Remove a block from the list
+    /** Append all the blocks in the list to a vector. Blocks are not
+     * removed from the list, and the caller must release the reference it
+     * gets to each of them
+     *
+     * \param blocks Vector where the blocks are appended
+     */
+    void snapshot(std::vector<Block *> &blocks);
+
+    /** Remove a block from the list, dropping the reference held by the list
      *
      * \param block Block to be removed from the list
+     * \return True if the block was in the list
      */
-    void remove(Block &block);
+    bool remove(Block &block);
 };
 
 }}}
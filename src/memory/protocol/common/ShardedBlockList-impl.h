@@ -0,0 +1,102 @@
+#ifndef GMAC_MEMORY_PROTOCOL_SHARDEDBLOCKLIST_IMPL_H_
+#define GMAC_MEMORY_PROTOCOL_SHARDEDBLOCKLIST_IMPL_H_
+
+#include "memory/Block.h"
+
+namespace __impl { namespace memory { namespace protocol {
+
+inline ShardedBlockList::ShardedBlockList(unsigned shards) :
+    n_(shards),
+    shards_(NULL),
+    size_(0),
+    next_(0)
+{
+    shards_ = new BlockList[n_];
+}
+
+inline ShardedBlockList::~ShardedBlockList()
+{
+    delete [] shards_;
+}
+
+inline BlockList &ShardedBlockList::shard(const Block &block) const
+{
+    // Consecutive blocks of an object go to consecutive shards, whatever
+    // the block size of the object is
+    size_t n = size_t(block.addr()) / block.size();
+    return shards_[n % n_];
+}
+
+inline bool ShardedBlockList::empty() const
+{
+    return size_ == 0;
+}
+
+inline size_t ShardedBlockList::size() const
+{
+    return size_t(size_);
+}
+
+inline void ShardedBlockList::push(Block &block)
+{
+    block.incRef();
+    BlockList &list = shard(block);
+    list.lock();
+    list.Parent::push_back(&block);
+    AtomicInc(size_);
+    list.unlock();
+}
+
+inline Block *ShardedBlockList::front()
+{
+    unsigned first = unsigned(next_);
+    for(unsigned i = 0; i < n_; i++) {
+        unsigned n = (first + i) % n_;
+        BlockList &list = shards_[n];
+        list.lock();
+        if(list.Parent::empty() == true) {
+            list.unlock();
+            continue;
+        }
+        Block *ret = list.Parent::front();
+        // The block might be removed from the list as soon as it is unlocked
+        ret->incRef();
+        list.unlock();
+        if(n != first) next_ = int(n);
+        return ret;
+    }
+    // Blocks might be removed from shards already scanned while the size
+    // is still being checked by the caller
+    return NULL;
+}
+
+inline void ShardedBlockList::snapshot(std::vector<Block *> &blocks)
+{
+    for(unsigned i = 0; i < n_; i++) shards_[i].snapshot(blocks);
+}
+
+inline bool ShardedBlockList::remove(Block &block)
+{
+    BlockList &list = shard(block);
+    unsigned erased = 0;
+    list.lock();
+    BlockList::Parent::iterator i = list.Parent::begin();
+    while(i != list.Parent::end()) {
+        if(*i == &block) {
+            i = list.Parent::erase(i);
+            erased++;
+        }
+        else ++i;
+    }
+    // The size is updated with the shard locked, so it never counts
+    // blocks that are no longer in the list
+    for(unsigned n = 0; n < erased; n++) AtomicDec(size_);
+    list.unlock();
+    // The caller holds its own reference to the block
+    for(unsigned n = 0; n < erased; n++) block.decRef();
+    return erased > 0;
+}
+
+}}}
+
+#endif
@@ -0,0 +1,130 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_MEMORY_PROTOCOL_SHARDEDBLOCKLIST_H_
+#define GMAC_MEMORY_PROTOCOL_SHARDEDBLOCKLIST_H_
+
+#include <vector>
+
+#include "config/common.h"
+#include "include/gmac/types.h"
+#include "util/Atomics.h"
+
+#include "BlockList.h"
+
+namespace __impl { namespace memory {
+class Block;
+
+namespace protocol {
+
+//! List of blocks split in several independently locked shards
+class GMAC_LOCAL ShardedBlockList {
+// Threads faulting on different blocks push to different shards, so they
+// do not contend for a single list lock
+protected:
+    /** Number of shards */
+    unsigned n_;
+    /** Shards holding the blocks. A block always goes to the same shard */
+    BlockList *shards_;
+    /** Total number of blocks in all the shards */
+    Atomic size_;
+    /** Shard where front() starts looking for blocks */
+    Atomic next_;
+
+    /** Gets the shard a block belongs to
+     *
+     * \param block Block to look for
+     * \return Shard the block is stored in
+     */
+    BlockList &shard(const Block &block) const;
+
+public:
+    /** Default constructor
+     *
+     * \param shards Number of shards in the list
+     */
+    explicit ShardedBlockList(unsigned shards);
+
+    /// Default destructor
+    virtual ~ShardedBlockList();
+
+    /** Whether the list is empty or not
+     *
+     * \return True if the list is empty
+     */
+    bool empty() const;
+
+    /** Size of the list
+     *
+     *  \return Number of blocks in the list
+     */
+    size_t size() const;
+
+    /** Add a block to the end of its shard. The list holds a reference to
+     * the block until it is removed
+     *
+     * \param block Block to be addded to the list
+     */
+    void push(Block &block);
+
+    /** Return the first Block in the first non-empty shard. Blocks come out
+     * in FIFO order within each shard, but not across shards. The block is
+     * not removed from the list, and the caller must release the reference
+     * it gets
+     *
+     * \return Block from the begining of a shard, or NULL if all the shards
+     * are empty
+     */
+    Block *front();
+
+    /** Append all the blocks in the list to a vector. Blocks are not
+     * removed from the list, and the caller must release the reference it
+     * gets to each of them
+     *
+     * \param blocks Vector where the blocks are appended
+     */
+    void snapshot(std::vector<Block *> &blocks);
+
+    /** Remove a block from the list, dropping the reference held by the list
+     *
+     * \param block Block to be removed from the list
+     * \return True if the block was in the list
+     */
+    bool remove(Block &block);
+};
+
+}}}
+
+#include "ShardedBlockList-impl.h"
+
+#endif
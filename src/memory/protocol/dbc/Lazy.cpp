@@ -58,7 +58,8 @@ LazyBase::release(BlockImpl &_block)
     gmacError_t ret = Parent::release(block);
 
     ENSURES(block.getState() == __impl::memory::protocol::lazy::ReadOnly ||
-            block.getState() == __impl::memory::protocol::lazy::Invalid);
+            block.getState() == __impl::memory::protocol::lazy::Invalid ||
+            block.getState() == __impl::memory::protocol::lazy::HostOnly);
 
     return ret;
 }
@@ -109,7 +110,7 @@ LazyBase::copyFromBuffer(BlockImpl &block, IOBufferImpl &buffer, size_t size,
 }
 
 gmacError_t
-LazyBase::memset(const BlockImpl &block, int v, size_t size, size_t blockOffset)
+LazyBase::memset(BlockImpl &block, int v, size_t size, size_t blockOffset)
 {
     REQUIRES(blockOffset + size <= block.size());
 
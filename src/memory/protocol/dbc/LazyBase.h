@@ -71,7 +71,7 @@ public:
     gmacError_t copyFromBuffer(BlockImpl &block, IOBufferImpl &buffer, size_t size,
                                size_t bufferOffset, size_t blockOffset);
 
-    gmacError_t memset(const BlockImpl &block, int v, size_t size, size_t blockOffset);
+    gmacError_t memset(BlockImpl &block, int v, size_t size, size_t blockOffset);
 
     gmacError_t flushDirty();
 
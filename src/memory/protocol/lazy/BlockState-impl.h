@@ -36,7 +36,13 @@ WITH THE SOFTWARE.  */
 
 #include "memory/StateBlock.h"
 
+#if defined(POSIX)
+#include <unistd.h>
+#endif
+
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 #if defined(USE_SUBBLOCK_TRACKING) || defined(USE_VM)
 
@@ -279,7 +285,13 @@ BlockState::BlockState(lazy::State init) :
     strideInfo_(block()),
     treeInfo_(block()),
     faultsRead_(0),
-    faultsWrite_(0)
+    faultsWrite_(0),
+    fillValue_(0),
+    fillHost_(false),
+    fillAccelerator_(false),
+    fillFd_(-1),
+    fillOffset_(0),
+    fillSize_(0)
 { 
     // Initialize subblock states
 #ifndef USE_VM
@@ -407,6 +419,48 @@ BlockState::syncToAccelerator()
 	return ret;
 }
 
+#if defined(USE_SUBBLOCK_TRACKING)
+inline gmacError_t
+BlockState::gatherToAccelerator()
+{
+    // Only whole subblocks can be packed
+    if (block().size() % SubBlockSize_ != 0) return syncToAccelerator();
+
+    std::vector<size_t> dirty;
+    unsigned groups = 0;
+    for (unsigned i = 0; i != subBlocks_; i++) {
+        if (subBlockState_[i] != lazy::Dirty) continue;
+        if (dirty.empty() == true || dirty.back() != (i - 1) * SubBlockSize_) groups++;
+        dirty.push_back(i * SubBlockSize_);
+    }
+    if (dirty.empty() == true) return gmacSuccess;
+
+    unsigned count = unsigned(dirty.size());
+    if (count > subBlocks_ * util::params::ParamGatherRatio) return syncToAccelerator();
+
+    // A gather pays one DMA and one kernel launch, while a regular update
+    // pays one DMA per group of contiguous subblocks
+    float gather  = vm::cost<vm::MODEL_TODEVICE>(SubBlockSize_, count) +
+                    vm::costConfig<vm::MODEL_TODEVICE>();
+    float groupsCost = groups * vm::costConfig<vm::MODEL_TODEVICE>() +
+                    vm::costTransfer<vm::MODEL_TODEVICE>(SubBlockSize_, count);
+    float whole   = vm::cost<vm::MODEL_TODEVICE>(SubBlockSize_, subBlocks_);
+    if (gather >= groupsCost || gather >= whole) return syncToAccelerator();
+
+    TRACE(LOCAL, "Gather %u subblocks of block %p", count, block().addr());
+    gmacError_t ret = block().scatterToAccelerator(&dirty[0], count, SubBlockSize_);
+    if (ret != gmacSuccess) return ret;
+    for (unsigned n = 0; n < count; n++) {
+        unsigned i = unsigned(dirty[n] / SubBlockSize_);
+        setSubBlock(i, lazy::ReadOnly);
+#ifdef DEBUG
+        transfersToAccelerator_[i]++;
+#endif
+    }
+    return ret;
+}
+#endif
+
 inline gmacError_t
 BlockState::syncToHost()
 {
@@ -529,6 +583,14 @@ BlockState::write(const hostptr_t addr)
     }
 }
 
+inline bool
+BlockState::isSequential() const
+{
+    // Without stride information there is nothing against it
+    if (subBlockState_.size() <= STRIDE_THRESHOLD || util::params::ParamSubBlockStride == false) return true;
+    return strideInfo_.isStrided() && strideInfo_.getStride() > 0;
+}
+
 inline bool
 BlockState::is(ProtocolState state) const
 {
@@ -684,13 +746,19 @@ Block &BlockState::block()
 
 inline
 BlockState::BlockState(ProtocolState init) :
-    common::BlockState<lazy::State>(init)
+    common::BlockState<lazy::State>(init),
 #ifdef DEBUG
-    , faultsRead_(0),
+    faultsRead_(0),
     faultsWrite_(0),
     transfersToAccelerator_(0),
-    transfersToHost_(0)
+    transfersToHost_(0),
 #endif
+    fillValue_(0),
+    fillHost_(false),
+    fillAccelerator_(false),
+    fillFd_(-1),
+    fillOffset_(0),
+    fillSize_(0)
 {
 }
 
@@ -752,6 +820,15 @@ BlockState::write(const hostptr_t /*addr*/)
     faultsCacheWrite_++;
 }
 
+inline
+bool
+BlockState::isSequential() const
+{
+    // Blocks are written in a single fault, so any block can be part of a
+    // sequential stream
+    return true;
+}
+
 inline
 bool
 BlockState::is(ProtocolState state) const
@@ -835,6 +912,138 @@ BlockState::dump(std::ostream &stream, common::Statistic stat)
 
 #endif
 
+namespace __impl {
+namespace memory {
+namespace protocol {
+namespace lazy {
+
+inline void
+BlockState::setFill(int v)
+{
+    fillValue_ = v;
+    fillFd_ = -1;
+    fillHost_ = true;
+    fillAccelerator_ = true;
+}
+
+inline void
+BlockState::setFile(int fd, off_t offset, size_t size)
+{
+    fillFd_ = fd;
+    fillOffset_ = offset;
+    fillSize_ = size;
+    fillHost_ = true;
+    fillAccelerator_ = true;
+}
+
+inline bool
+BlockState::hasFileFill() const
+{
+    return fillFd_ >= 0 && (fillHost_ || fillAccelerator_);
+}
+
+inline gmacError_t
+BlockState::readFile()
+{
+#if defined(POSIX)
+    TRACE(LOCAL, "Read block from file: %p", block().addr());
+    uint8_t *ptr = block().getShadow();
+    size_t size = fillSize_;
+    off_t offset = fillOffset_;
+    while(size > 0) {
+        ssize_t ret = ::pread(fillFd_, ptr, size, offset);
+        if(ret < 0) return gmacErrorInvalidValue;
+        if(ret == 0) break;
+        ptr += ret;
+        size -= size_t(ret);
+        offset += ret;
+    }
+    // Contents past the end of the file or the mapping read as zeros
+    size_t left = block().size() - size_t(ptr - block().getShadow());
+    if(left > 0) ::memset(ptr, 0, left);
+    return gmacSuccess;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+inline gmacError_t
+BlockState::writeFile(int fd, off_t offset, size_t size)
+{
+#if defined(POSIX)
+    ASSERTION(size <= block().size());
+    const uint8_t *ptr = block().getShadow();
+    while(size > 0) {
+        ssize_t ret = ::pwrite(fd, ptr, size, offset);
+        if(ret <= 0) return gmacErrorInvalidValue;
+        ptr += ret;
+        size -= size_t(ret);
+        offset += ret;
+    }
+    return gmacSuccess;
+#else
+    return gmacErrorFeatureNotSupported;
+#endif
+}
+
+inline bool
+BlockState::hasFill() const
+{
+    return fillHost_ || fillAccelerator_;
+}
+
+inline bool
+BlockState::hasAcceleratorFill() const
+{
+    return fillAccelerator_;
+}
+
+inline gmacError_t
+BlockState::fillHost()
+{
+    if (fillHost_ == false) return gmacSuccess;
+    TRACE(LOCAL, "Fill block in host: %p", block().addr());
+    gmacError_t ret;
+    if (fillFd_ >= 0) ret = readFile();
+    else ret = block().memset(fillValue_, block().size(), 0, lazy::Block::HOST);
+    if (ret == gmacSuccess) fillHost_ = false;
+    return ret;
+}
+
+inline gmacError_t
+BlockState::fillAccelerator()
+{
+    if (fillAccelerator_ == false) return gmacSuccess;
+    TRACE(LOCAL, "Fill block in accelerator: %p", block().addr());
+    gmacError_t ret;
+    if (fillFd_ >= 0) {
+        // File contents reach the accelerator through the host copy; the
+        // transfer overlaps with reading the next block from the file
+        ret = fillHost();
+        if (ret == gmacSuccess) ret = block().toAccelerator();
+    }
+    else ret = block().memset(fillValue_, block().size(), 0, lazy::Block::ACCELERATOR);
+    if (ret == gmacSuccess) fillAccelerator_ = false;
+    return ret;
+}
+
+inline gmacError_t
+BlockState::flushFill()
+{
+    gmacError_t ret = fillHost();
+    if (ret != gmacSuccess) return ret;
+    return fillAccelerator();
+}
+
+inline void
+BlockState::clearFill()
+{
+    fillHost_ = false;
+    fillAccelerator_ = false;
+}
+
+}}}}
+
 #endif /* BLOCKSTATE_IMPL_H */
 
 /* vim:set backspace=2 tabstop=4 shiftwidth=4 textwidth=120 foldmethod=marker expandtab: */
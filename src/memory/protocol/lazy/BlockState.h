@@ -177,6 +177,10 @@ protected:
     StrideInfo strideInfo_;
     BlockTreeInfo treeInfo_;
 
+    // Faults since the last release
+    unsigned faultsRead_;
+    unsigned faultsWrite_;
+
     void setSubBlock(const hostptr_t addr, ProtocolState state);
     void setSubBlock(long_t subBlock, ProtocolState state);
     void setAll(ProtocolState state);
@@ -192,6 +196,18 @@ protected:
     void writeTree(const hostptr_t addr);
 #endif
 
+    // Constant fill not yet written to the host and/or accelerator memory
+    int fillValue_;
+    bool fillHost_;
+    bool fillAccelerator_;
+
+    // File the fill is read from, or -1 for constant fills
+    int fillFd_;
+    off_t fillOffset_;
+    size_t fillSize_;
+
+    gmacError_t readFile();
+
 public:
     BlockState(lazy::State init);
 
@@ -204,9 +220,28 @@ public:
     gmacError_t syncToAccelerator();
     gmacError_t syncToHost();
 
+#if defined(USE_SUBBLOCK_TRACKING)
+    /**
+     * Sends the dirty subblocks to the accelerator. Sparse subblocks are
+     * packed and sent in a single transfer if the cost model tells that it is
+     * cheaper than transferring each group of subblocks or the whole block
+     *
+     * \return Error code
+     */
+    gmacError_t gatherToAccelerator();
+#endif
+
     void read(const hostptr_t addr);
     void write(const hostptr_t addr);
 
+    /**
+     * Tells if the faults received by the block are consistent with a
+     * writer filling it sequentially
+     *
+     * \return True if the block seems written sequentially
+     */
+    bool isSequential() const;
+
     bool is(ProtocolState state) const;
 
     int protect(GmacProtection prot);
@@ -216,6 +251,80 @@ public:
     void released();
 
     gmacError_t dump(std::ostream &stream, common::Statistic stat);
+
+    /**
+     * Records that the whole block holds a constant value that has not been
+     * written to host nor accelerator memory yet
+     *
+     * \param v Value the block is filled with
+     */
+    void setFill(int v);
+
+    /**
+     * Records that the whole block holds the contents of a file that have not
+     * been read into host nor accelerator memory yet
+     *
+     * \param fd Descriptor of the file
+     * \param offset Offset within the file of the contents of the block
+     * \param size Bytes of the block read from the file. The rest of the
+     * block is filled with zeros
+     */
+    void setFile(int fd, off_t offset, size_t size);
+
+    /**
+     * Tells if the pending fill of the block is read from a file
+     *
+     * \return True if the block is pending a file fill
+     */
+    bool hasFileFill() const;
+
+    /**
+     * Writes the host copy of the block to a file
+     *
+     * \param fd Descriptor of the file
+     * \param offset Offset within the file where the block is written
+     * \param size Bytes from the start of the block written to the file
+     * \return Error code
+     */
+    gmacError_t writeFile(int fd, off_t offset, size_t size);
+
+    /**
+     * Tells if the block holds a constant fill pending on any of its copies
+     *
+     * \return True if a fill is pending
+     */
+    bool hasFill() const;
+
+    /**
+     * Tells if the accelerator copy of the block is pending a constant fill
+     *
+     * \return True if the accelerator fill is pending
+     */
+    bool hasAcceleratorFill() const;
+
+    /**
+     * Writes the pending fill to the host copy of the block
+     *
+     * \return Error code
+     */
+    gmacError_t fillHost();
+
+    /**
+     * Writes the pending fill to the accelerator copy of the block
+     *
+     * \return Error code
+     */
+    gmacError_t fillAccelerator();
+
+    /**
+     * Writes the pending fill to both copies of the block and forgets it
+     *
+     * \return Error code
+     */
+    gmacError_t flushFill();
+
+    /** Forgets the fill without writing it */
+    void clearFill();
 };
 
 }}}}
@@ -27,12 +27,14 @@ hostptr_t Memory::map(hostptr_t addr, size_t count, GmacProtection prot)
 {
     hostptr_t cpuAddr = NULL;
 
-	// Create anonymous file to be mapped
-	HANDLE handle = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)count, NULL);
+	// Create anonymous file to be mapped. Sizes are split in two 32-bit halves
+	uint64_t size = uint64_t(count);
+	HANDLE handle = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+	                                  DWORD(size >> 32), DWORD(size & 0xffffffff), NULL);
 	if(handle == NULL) return NULL;
 	
 	// Create a view of the file in the previously allocated virtual memory range
-	if((cpuAddr = (hostptr_t)MapViewOfFileEx(handle, FILE_MAP_WRITE, 0, 0, (DWORD)count, addr)) == NULL) {
+	if((cpuAddr = (hostptr_t)MapViewOfFileEx(handle, FILE_MAP_WRITE, 0, 0, count, addr)) == NULL) {
 		CloseHandle(handle);
 		return NULL;
 	}
@@ -52,8 +54,10 @@ hostptr_t Memory::shadow(hostptr_t addr, size_t count)
 	TRACE(GLOBAL, "Getting shadow mapping for %p ("FMT_SIZE" bytes)", addr, count);
 	FileMapEntry entry = Files.find(addr);
 	if(entry.handle() == NULL) return NULL;
-	off_t offset = off_t(addr - entry.address());
-	hostptr_t ret = (hostptr_t)MapViewOfFile(entry.handle(), FILE_MAP_WRITE, 0, (DWORD)offset, (DWORD)count);
+	// off_t is 32-bit on Windows
+	uint64_t offset = uint64_t(addr - entry.address());
+	hostptr_t ret = (hostptr_t)MapViewOfFile(entry.handle(), FILE_MAP_WRITE,
+	                                         DWORD(offset >> 32), DWORD(offset & 0xffffffff), count);
 	return ret;
 }
 
@@ -0,0 +1,53 @@
+#ifndef GMAC_UTIL_MONITOR_IMPL_H_
+#define GMAC_UTIL_MONITOR_IMPL_H_
+
+#if defined(POSIX)
+#include <sys/time.h>
+#elif defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+namespace __impl { namespace util {
+
+inline MonitorAccelerator *
+Monitor::getAccelerator(unsigned id)
+{
+    if(Segment_ == NULL || id >= GMAC_MONITOR_ACCELERATORS) return NULL;
+    return &Segment_->accelerators_[id];
+}
+
+inline void
+Monitor::add(volatile uint64_t &counter, int64_t v)
+{
+#if defined(__GNUC__)
+    __sync_add_and_fetch(&counter, uint64_t(v));
+#elif defined(_MSC_VER)
+    InterlockedExchangeAdd64((volatile LONGLONG *)&counter, v);
+#endif
+}
+
+inline void
+Monitor::set(volatile uint64_t &counter, uint64_t v)
+{
+    // Aligned 64-bit stores are atomic on the supported platforms
+    counter = v;
+}
+
+inline uint64_t
+Monitor::now()
+{
+#if defined(POSIX)
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return uint64_t(tv.tv_sec) * 1000000 + tv.tv_usec;
+#elif defined(_MSC_VER)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return uint64_t(count.QuadPart * 1000000 / freq.QuadPart);
+#endif
+}
+
+}}
+
+#endif
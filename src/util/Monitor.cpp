@@ -0,0 +1,99 @@
+#if defined(POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Monitor.h"
+
+#include "util/Logger.h"
+#include "util/Parameter.h"
+#include "util/Thread.h"
+
+namespace __impl { namespace util {
+
+GmacMonitorSegment *Monitor::Segment_ = NULL;
+
+#if defined(POSIX)
+static char SegmentName_[64];
+
+static void
+unlinkAtExit()
+{
+    // Modes keep pointers to their slots until the very end, so the segment
+    // stays mapped; only its name is removed
+    ::shm_unlink(SegmentName_);
+}
+#endif
+
+void Monitor::init()
+{
+    if(Segment_ != NULL || util::params::ParamMonitor == false) return;
+#if defined(POSIX)
+    snprintf(SegmentName_, sizeof(SegmentName_), "%s%d", GMAC_MONITOR_PREFIX, int(GetProcessId()));
+    // Segments left by a previous process with the same id are replaced
+    ::shm_unlink(SegmentName_);
+    int fd = ::shm_open(SegmentName_, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0) {
+        WARNING("Unable to create monitor segment %s", SegmentName_);
+        return;
+    }
+    void *addr = MAP_FAILED;
+    if(::ftruncate(fd, sizeof(GmacMonitorSegment)) == 0)
+        addr = ::mmap(NULL, sizeof(GmacMonitorSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED) {
+        WARNING("Unable to map monitor segment %s", SegmentName_);
+        ::shm_unlink(SegmentName_);
+        return;
+    }
+    GmacMonitorSegment *segment = static_cast<GmacMonitorSegment *>(addr);
+    ::memset(segment, 0, sizeof(GmacMonitorSegment));
+    segment->version_ = GMAC_MONITOR_VERSION;
+    segment->pid_ = uint64_t(GetProcessId());
+    // Tools only trust the segment once the magic number is there
+    __sync_synchronize();
+    segment->magic_ = GMAC_MONITOR_MAGIC;
+    Segment_ = segment;
+    // Segments are not removed when the process dies, so the name is
+    // unlinked on a normal exit
+    atexit(unlinkAtExit);
+    TRACE(GLOBAL, "Publishing counters in %s", SegmentName_);
+#else
+    WARNING("The run-time monitor is not supported on this platform");
+#endif
+}
+
+MonitorMode *Monitor::acquireMode(uint64_t id)
+{
+    if(Segment_ == NULL) return NULL;
+    for(unsigned i = 0; i < GMAC_MONITOR_MODES; i++) {
+        MonitorMode &slot = Segment_->modes_[i];
+#if defined(__GNUC__)
+        if(__sync_val_compare_and_swap(&slot.inUse_, 0, 1) != 0) continue;
+#elif defined(_MSC_VER)
+        if(InterlockedCompareExchange((volatile LONG *)&slot.inUse_, 1, 0) != 0) continue;
+#endif
+        // Clear the counters of the previous owner but the slot flag
+        ::memset((uint8_t *)&slot + sizeof(slot.inUse_), 0, sizeof(slot) - sizeof(slot.inUse_));
+        slot.id_ = id;
+        return &slot;
+    }
+    TRACE(GLOBAL, "No free monitor slot for mode %u", unsigned(id));
+    return NULL;
+}
+
+void Monitor::releaseMode(MonitorMode *slot)
+{
+    if(slot == NULL) return;
+#if defined(__GNUC__)
+    __sync_synchronize();
+#endif
+    slot->inUse_ = 0;
+}
+
+}}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_UTIL_MONITOR_H_
+#define GMAC_UTIL_MONITOR_H_
+
+#include "config/common.h"
+#include "util/MonitorSegment.h"
+
+namespace __impl { namespace util {
+
+typedef GmacMonitorMode MonitorMode;
+typedef GmacMonitorAccelerator MonitorAccelerator;
+
+/**
+ * Publishes live counters of the run-time in a shared memory segment that
+ * external tools, such as gmac-top, can attach to. Counters are updated with
+ * atomic operations on the segment, so updates never take locks. If the
+ * monitor is disabled, all the slots are NULL and nothing is published
+ */
+class GMAC_LOCAL Monitor {
+protected:
+    /** Segment mapped in the process, or NULL if the monitor is disabled */
+    static GmacMonitorSegment *Segment_;
+
+public:
+    /**
+     * Creates the shared memory segment if GMAC_MONITOR is set. The segment
+     * is mapped until the process ends, and its name is removed on exit
+     */
+    static void init();
+
+    /**
+     * Takes a free slot for an execution mode
+     *
+     * \param id Identifier of the mode
+     * \return Slot of the mode, or NULL if the monitor is disabled or full
+     */
+    static MonitorMode *acquireMode(uint64_t id);
+
+    /**
+     * Gives back the slot of an execution mode
+     *
+     * \param slot Slot returned by acquireMode, or NULL
+     */
+    static void releaseMode(MonitorMode *slot);
+
+    /**
+     * Gets the slot of an accelerator
+     *
+     * \param id Identifier of the accelerator
+     * \return Slot of the accelerator, or NULL if the monitor is disabled
+     */
+    static MonitorAccelerator *getAccelerator(unsigned id);
+
+    /**
+     * Atomically adds a value to a counter
+     *
+     * \param counter Counter in the segment
+     * \param v Value to be added. It can be negative
+     */
+    static void add(volatile uint64_t &counter, int64_t v);
+
+    /**
+     * Sets the value of a counter
+     *
+     * \param counter Counter in the segment
+     * \param v New value of the counter
+     */
+    static void set(volatile uint64_t &counter, uint64_t v);
+
+    /**
+     * Gets a timestamp to measure the duration of operations
+     *
+     * \return Current time in microseconds
+     */
+    static uint64_t now();
+};
+
+}}
+
+#include "Monitor-impl.h"
+
+#endif
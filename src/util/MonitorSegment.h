@@ -0,0 +1,101 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_UTIL_MONITORSEGMENT_H_
+#define GMAC_UTIL_MONITORSEGMENT_H_
+
+/*
+ * Layout of the shared memory segment where GMAC publishes live counters.
+ * The segment is written by the run-time and read by external tools, so this
+ * file only uses plain C types and must not depend on the rest of GMAC
+ */
+
+#include <stdint.h>
+
+#define GMAC_MONITOR_MAGIC 0x474d4f4eu /* "GMON" */
+#define GMAC_MONITOR_VERSION 1
+#define GMAC_MONITOR_MODES 64
+#define GMAC_MONITOR_ACCELERATORS 16
+#define GMAC_MONITOR_PREFIX "/gmac-monitor-"
+
+/** Counters of an execution mode. Counters are cumulative unless stated */
+typedef struct {
+    /** Non-zero while the slot belongs to a mode */
+    volatile uint32_t inUse_;
+    /** Accelerator the mode runs on */
+    volatile uint32_t accelerator_;
+    /** Identifier of the mode */
+    volatile uint64_t id_;
+    /** Blocks in Dirty state (current value) */
+    volatile uint64_t dirtyBlocks_;
+    /** Bytes in transfers started but not completed (current value) */
+    volatile uint64_t bytesInFlight_;
+    volatile uint64_t bytesToAccelerator_;
+    volatile uint64_t bytesToHost_;
+    volatile uint64_t faultsRead_;
+    volatile uint64_t faultsWrite_;
+    volatile uint64_t releases_;
+    /** Time (in microseconds) spent releasing objects */
+    volatile uint64_t releaseTime_;
+    volatile uint64_t acquires_;
+    /** Time (in microseconds) spent acquiring objects */
+    volatile uint64_t acquireTime_;
+    /** I/O buffers allocated by the mode (current value) */
+    volatile uint64_t ioBuffers_;
+    /** Bytes in I/O buffers allocated by the mode (current value) */
+    volatile uint64_t ioBufferBytes_;
+} GmacMonitorMode;
+
+/** Counters of an accelerator */
+typedef struct {
+    /** Non-zero if the accelerator exists */
+    volatile uint32_t present_;
+    /** Modes running on the accelerator (current value) */
+    volatile uint32_t modes_;
+    /** Memory (in bytes) of the accelerator */
+    volatile uint64_t memoryTotal_;
+    /** Memory (in bytes) allocated on the accelerator (current value) */
+    volatile uint64_t memoryUsed_;
+} GmacMonitorAccelerator;
+
+/** Shared memory segment, named GMAC_MONITOR_PREFIX followed by the process id */
+typedef struct {
+    /** GMAC_MONITOR_MAGIC, written once the segment is initialized */
+    volatile uint32_t magic_;
+    uint32_t version_;
+    uint64_t pid_;
+    GmacMonitorAccelerator accelerators_[GMAC_MONITOR_ACCELERATORS];
+    GmacMonitorMode modes_[GMAC_MONITOR_MODES];
+} GmacMonitorSegment;
+
+#endif
@@ -0,0 +1,244 @@
+#if defined(POSIX)
+#include <pthread.h>
+#endif
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_NON_TEMPORAL_KERNELS
+#endif
+
+#include "StagingCopy.h"
+
+#include "util/Logger.h"
+#include "util/Parameter.h"
+
+namespace __impl { namespace util {
+
+StagingCopy *StagingCopy::Engine_ = NULL;
+StagingCopy::Kernel StagingCopy::NonTemporal_ = NULL;
+const char *StagingCopy::NonTemporalName_ = NULL;
+
+/** Chunks taken by helper threads are multiple of this size (in bytes) */
+static const size_t ChunkAlignment_ = 4096;
+
+static void
+copyTemporal(void *dst, const void *src, size_t size)
+{
+    ::memcpy(dst, src, size);
+}
+
+#if defined(HAVE_NON_TEMPORAL_KERNELS)
+__attribute__((target("sse2")))
+static void
+copySSE2(void *dst, const void *src, size_t size)
+{
+    uint8_t *d = static_cast<uint8_t *>(dst);
+    const uint8_t *s = static_cast<const uint8_t *>(src);
+    // Streaming stores require aligned destination addresses
+    size_t head = (16 - (uintptr_t(d) & 15)) & 15;
+    if(head > size) head = size;
+    ::memcpy(d, s, head);
+    d += head; s += head; size -= head;
+    for(; size >= 64; size -= 64, d += 64, s += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + 32));
+        __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i *>(d), a);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(d + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(d + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(d + 48), e);
+    }
+    // Streaming stores are weakly ordered
+    _mm_sfence();
+    ::memcpy(d, s, size);
+}
+
+__attribute__((target("avx")))
+static void
+copyAVX(void *dst, const void *src, size_t size)
+{
+    uint8_t *d = static_cast<uint8_t *>(dst);
+    const uint8_t *s = static_cast<const uint8_t *>(src);
+    size_t head = (32 - (uintptr_t(d) & 31)) & 31;
+    if(head > size) head = size;
+    ::memcpy(d, s, head);
+    d += head; s += head; size -= head;
+    for(; size >= 128; size -= 128, d += 128, s += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + 64));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(d), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(d + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(d + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(d + 96), e);
+    }
+    _mm_sfence();
+    ::memcpy(d, s, size);
+}
+#endif
+
+StagingCopy::StagingCopy(unsigned threads) :
+    gmac::util::Lock("StagingCopy"),
+    threads_(threads),
+    started_(false),
+    exit_(false),
+    busy_(0),
+    start_(0),
+    done_(0),
+    dst_(NULL),
+    src_(NULL),
+    size_(0),
+    chunk_(0),
+    kernel_(NULL),
+    next_(0)
+{
+}
+
+StagingCopy::~StagingCopy()
+{
+    if(started_ == false) return;
+    lock();
+    exit_ = true;
+    for(unsigned i = 0; i < threads_; i++) start_.post();
+    for(unsigned i = 0; i < threads_; i++) done_.wait();
+    unlock();
+}
+
+void StagingCopy::detect()
+{
+#if defined(HAVE_NON_TEMPORAL_KERNELS)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx")) {
+        NonTemporal_ = copyAVX;
+        NonTemporalName_ = "AVX";
+    }
+    else if(__builtin_cpu_supports("sse2")) {
+        NonTemporal_ = copySSE2;
+        NonTemporalName_ = "SSE2";
+    }
+#endif
+    if(NonTemporal_ != NULL)
+        TRACE(GLOBAL, "Using %s non-temporal stores for staging copies", NonTemporalName_);
+}
+
+void StagingCopy::init()
+{
+    // The engine is created during the memory initialization, which runs
+    // before any thread can stage transfers
+    if(Engine_ != NULL) return;
+    detect();
+#if defined(POSIX)
+    if(util::params::ParamStagingThreads > 0) {
+        TRACE(GLOBAL, "Using %u threads for staging copies", util::params::ParamStagingThreads);
+        Engine_ = new StagingCopy(util::params::ParamStagingThreads);
+    }
+#endif
+}
+
+void StagingCopy::destroy()
+{
+    if(Engine_ == NULL) return;
+    delete Engine_;
+    Engine_ = NULL;
+}
+
+void StagingCopy::start()
+{
+#if defined(POSIX)
+    for(unsigned i = 0; i < threads_; i++) {
+        pthread_t tid;
+        if(pthread_create(&tid, NULL, worker, this) != 0) {
+            // Keep the threads we managed to create
+            WARNING("Unable to create staging thread #%u", i);
+            threads_ = i;
+            break;
+        }
+        pthread_detach(tid);
+    }
+#else
+    threads_ = 0;
+#endif
+    started_ = true;
+}
+
+void *StagingCopy::worker(void *arg)
+{
+    StagingCopy &engine = *static_cast<StagingCopy *>(arg);
+    while(true) {
+        engine.start_.wait();
+        if(engine.exit_ == true) break;
+        engine.process();
+        engine.done_.post();
+    }
+    engine.done_.post();
+    return NULL;
+}
+
+void StagingCopy::process()
+{
+    while(true) {
+        size_t offset = (size_t(AtomicInc(next_)) - 1) * chunk_;
+        if(offset >= size_) return;
+        size_t size = (size_ - offset < chunk_)? size_ - offset: chunk_;
+        kernel_(dst_ + offset, src_ + offset, size);
+    }
+}
+
+bool StagingCopy::run(void *dst, const void *src, size_t size, Kernel kernel)
+{
+    // Threads copying at the same time do not wait for the helper threads
+    if(AtomicTestAndSet(busy_, 0, 1) != 0) return false;
+    lock();
+    if(started_ == false) start();
+    if(threads_ == 0) {
+        unlock();
+        busy_ = 0;
+        return false;
+    }
+
+    dst_ = static_cast<uint8_t *>(dst);
+    src_ = static_cast<const uint8_t *>(src);
+    size_ = size;
+    chunk_ = size / (threads_ + 1);
+    chunk_ = (chunk_ + ChunkAlignment_ - 1) & ~(ChunkAlignment_ - 1);
+    kernel_ = kernel;
+    next_ = 0;
+
+    for(unsigned i = 0; i < threads_; i++) start_.post();
+    // The calling thread also takes chunks from the copy
+    process();
+    // Barrier: wait for all helper threads to finish their last chunk
+    for(unsigned i = 0; i < threads_; i++) done_.wait();
+
+    unlock();
+    busy_ = 0;
+    return true;
+}
+
+void StagingCopy::toStaging(void *dst, const void *src, size_t size)
+{
+    Kernel kernel = copyTemporal;
+    if(NonTemporal_ != NULL && util::params::ParamStagingNonTemporal > 0 &&
+       size >= util::params::ParamStagingNonTemporal) kernel = NonTemporal_;
+    if(Engine_ != NULL && size >= util::params::ParamStagingParallel &&
+       Engine_->run(dst, src, size, kernel) == true) return;
+    kernel(dst, src, size);
+}
+
+void StagingCopy::fromStaging(void *dst, const void *src, size_t size)
+{
+    if(Engine_ != NULL && size >= util::params::ParamStagingParallel &&
+       Engine_->run(dst, src, size, copyTemporal) == true) return;
+    ::memcpy(dst, src, size);
+}
+
+const char *StagingCopy::nonTemporalName()
+{
+    return NonTemporalName_;
+}
+
+}}
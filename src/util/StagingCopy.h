@@ -0,0 +1,171 @@
+/* Copyright (c) 2009, 2010, 2011 University of Illinois
+                   Universitat Politecnica de Catalunya
+                   All rights reserved.
+
+Developed by: IMPACT Research Group / Grup de Sistemes Operatius
+              University of Illinois / Universitat Politecnica de Catalunya
+              http://impact.crhc.illinois.edu/
+              http://gso.ac.upc.edu/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal with the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimers.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimers in the
+     documentation and/or other materials provided with the distribution.
+  3. Neither the names of IMPACT Research Group, Grup de Sistemes Operatius,
+     University of Illinois, Universitat Politecnica de Catalunya, nor the
+     names of its contributors may be used to endorse or promote products
+     derived from this Software without specific prior written permission.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+WITH THE SOFTWARE.  */
+
+#ifndef GMAC_UTIL_STAGINGCOPY_H_
+#define GMAC_UTIL_STAGINGCOPY_H_
+
+#include <cstddef>
+
+#include "config/common.h"
+#include "util/Atomics.h"
+#include "util/Lock.h"
+#include "util/Semaphore.h"
+
+namespace __impl { namespace util {
+
+/**
+ * Copies data between user memory and the pinned buffers used to stage
+ * transfers. Large copies into staging buffers use non-temporal stores, so
+ * data that is only going to be transferred does not pollute the caches, and
+ * very large copies are split across a pool of helper threads
+ */
+class GMAC_LOCAL StagingCopy : protected gmac::util::Lock {
+    // Lock is taken to serialize batches coming from different threads
+public:
+    /** Copy routine used by the engine */
+    typedef void (*Kernel)(void *dst, const void *src, size_t size);
+
+protected:
+    /** Engine shared by all the threads in the process */
+    static StagingCopy *Engine_;
+
+    /** Copy routine using non-temporal stores, or NULL if not available */
+    static Kernel NonTemporal_;
+    /** Name of the non-temporal copy routine */
+    static const char *NonTemporalName_;
+
+    /** Number of helper threads (the calling thread is not included) */
+    unsigned threads_;
+    /** Whether the helper threads have been already spawned */
+    bool started_;
+    /** Tells helper threads to exit */
+    bool exit_;
+    /** Set while a copy is using the helper threads */
+    Atomic busy_;
+
+    /** Posted once per helper thread when a new copy is ready */
+    Semaphore start_;
+    /** Posted by each helper thread when it has finished the current copy */
+    Semaphore done_;
+
+    /** Destination of the current copy */
+    uint8_t *dst_;
+    /** Source of the current copy */
+    const uint8_t *src_;
+    /** Size (in bytes) of the current copy */
+    size_t size_;
+    /** Size (in bytes) of the chunks taken by each thread */
+    size_t chunk_;
+    /** Routine used to copy each chunk */
+    Kernel kernel_;
+    /** Next chunk to be taken from the current copy */
+    Atomic next_;
+
+    /**
+     * Selects the copy routines supported by the CPU
+     */
+    static void detect();
+
+    /**
+     * Spawns the helper threads
+     */
+    void start();
+
+    /**
+     * Copies chunks of the current copy until all of them are taken
+     */
+    void process();
+
+    /**
+     * Entry point for helper threads
+     * \param arg Engine the thread belongs to
+     */
+    static void *worker(void *arg);
+
+    /**
+     * Splits a copy in chunks and copies them using the helper threads
+     * and the calling thread
+     * \param dst Destination memory address
+     * \param src Source memory address
+     * \param size Size (in bytes) of the copy
+     * \param kernel Routine used to copy each chunk
+     * \return Whether the helper threads were available to perform the copy
+     */
+    bool run(void *dst, const void *src, size_t size, Kernel kernel);
+
+    /**
+     * Creates an engine with the given number of helper threads. Threads
+     * are spawned the first time they are needed
+     * \param threads Number of helper threads
+     */
+    StagingCopy(unsigned threads);
+
+    /** Default destructor */
+    ~StagingCopy();
+
+public:
+    /**
+     * Creates the process-wide engine
+     */
+    static void init();
+
+    /** Stops the helper threads and destroys the process-wide engine */
+    static void destroy();
+
+    /**
+     * Copies data from user memory to a staging buffer
+     * \param dst Staging buffer address
+     * \param src User memory address
+     * \param size Size (in bytes) of the copy
+     */
+    static void toStaging(void *dst, const void *src, size_t size);
+
+    /**
+     * Copies data from a staging buffer to user memory. Regular stores are
+     * used because the application is likely to read the data soon
+     * \param dst User memory address
+     * \param src Staging buffer address
+     * \param size Size (in bytes) of the copy
+     */
+    static void fromStaging(void *dst, const void *src, size_t size);
+
+    /**
+     * Gets the name of the non-temporal copy routine selected for the CPU
+     * \return Name of the copy routine, or NULL if there is none
+     */
+    static const char *nonTemporalName();
+};
+
+}}
+
+#endif
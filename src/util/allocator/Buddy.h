@@ -50,19 +50,19 @@ class GMAC_LOCAL Buddy : protected gmac::util::Lock  {
 
 protected:
     hostptr_t addr_;
-    uint32_t size_;
+    uint64_t size_;
     uint8_t index_;
 
-    uint8_t ones(register uint32_t x) const;
-    uint8_t index(register uint32_t x) const;
-    uint32_t round(register uint32_t x) const;
+    uint8_t ones(register uint64_t x) const;
+    uint8_t index(register uint64_t x) const;
+    uint64_t round(register uint64_t x) const;
 
-    typedef std::list<off_t> List;
+    typedef std::list<int64_t> List;
     typedef std::map<uint8_t, List> Tree;
 
     Tree _tree;
-    TESTABLE off_t getFromList(uint8_t i);
-    TESTABLE void putToList(off_t addr, uint8_t i);
+    TESTABLE int64_t getFromList(uint8_t i);
+    TESTABLE void putToList(int64_t addr, uint8_t i);
 public:
     Buddy(hostptr_t addr, size_t size);
     ~Buddy();
@@ -8,12 +8,12 @@ Buddy::Buddy(hostptr_t addr, size_t size) :
     __impl::util::allocator::Buddy(addr, size)
 {}
 
-off_t Buddy::getFromList(uint8_t i)
+int64_t Buddy::getFromList(uint8_t i)
 {
     return __impl::util::allocator::Buddy::getFromList(i);
 }
 
-void Buddy::putToList(off_t addr, uint8_t i)
+void Buddy::putToList(int64_t addr, uint8_t i)
 {
     REQUIRES(addr >= 0 && size_t(addr) < size_);
     return __impl::util::allocator::Buddy::putToList(addr, i);
@@ -46,8 +46,8 @@ class GMAC_LOCAL Buddy :
     public virtual Contract {
     DBC_TESTED(__impl::util::allocator::Buddy)
 protected:
-    off_t getFromList(uint8_t i);
-    void putToList(off_t addr, uint8_t i);
+    int64_t getFromList(uint8_t i);
+    void putToList(int64_t addr, uint8_t i);
 public:
     Buddy(hostptr_t addr, size_t size);
     hostptr_t get(size_t &size);
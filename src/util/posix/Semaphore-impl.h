@@ -16,10 +16,12 @@ inline void
 Semaphore::wait()
 {
     pthread_mutex_lock(&_mutex);
-    _val--;
-    while (_val < 0) {
+    // Each post lets exactly one waiter through, even if several threads
+    // are waiting at the same time
+    while (_val <= 0) {
         pthread_cond_wait(&_cond, &_mutex);
     }
+    _val--;
     pthread_mutex_unlock(&_mutex);
 }
 
@@ -0,0 +1,116 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <gmac/opencl.h>
+
+#include "utils.h"
+#include "debug.h"
+
+const char *vecSizeStr = "GMAC_VECSIZE";
+const unsigned vecSizeDefault = 4 * 1024 * 1024;
+unsigned vecSize = vecSizeDefault;
+
+const char *kernel = "\
+					 __kernel void vecAdd(__global float *c, __global const float *a, __global const float *b, unsigned size)\
+					 {\
+					 unsigned i = get_global_id(0);\
+					 if(i >= size) return;\
+					 \
+					 c[i] = a[i] + b[i];\
+					 }\
+					 ";
+
+static void setArgs(ecl_kernel kernel, float *c, float *a, float *b)
+{
+	ecl_error ret;
+	ret = eclSetKernelArgPtrComplex(kernel, 0, c, GMAC_PROT_WRITE);
+	assert(ret == eclSuccess);
+	ret = eclSetKernelArgPtrComplex(kernel, 1, a, GMAC_PROT_READ);
+	assert(ret == eclSuccess);
+	ret = eclSetKernelArgPtrComplex(kernel, 2, b, GMAC_PROT_READ);
+	assert(ret == eclSuccess);
+	ret = eclSetKernelArg(kernel, 3, sizeof(vecSize), &vecSize);
+	assert(ret == eclSuccess);
+}
+
+static float diff(const float *c, const float *a, const float *b, float scale)
+{
+	float err = 0.f;
+	for(unsigned i = 0; i < vecSize; i++) {
+		err += fabsf(c[i] - scale * (a[i] + b[i]));
+	}
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	float *a, *b, *c, *d, *e;
+	gmactime_t s, t;
+	ecl_error ret = eclSuccess;
+
+	setParam<unsigned>(&vecSize, vecSizeStr, vecSizeDefault);
+	fprintf(stdout, "Vector: %f\n", 1.0 * vecSize / 1024 / 1024);
+
+	ret = eclCompileSource(kernel);
+	assert(ret == eclSuccess);
+
+	assert(eclMalloc((void **)&a, vecSize * sizeof(float)) == eclSuccess);
+	assert(eclMalloc((void **)&b, vecSize * sizeof(float)) == eclSuccess);
+	assert(eclMalloc((void **)&c, vecSize * sizeof(float)) == eclSuccess);
+	assert(eclMalloc((void **)&d, vecSize * sizeof(float)) == eclSuccess);
+	assert(eclMalloc((void **)&e, vecSize * sizeof(float)) == eclSuccess);
+
+	randInitMax(a, 10.f, vecSize);
+	randInitMax(b, 10.f, vecSize);
+
+	ecl_kernel k1, k2, k3;
+	assert(eclGetKernel("vecAdd", &k1) == eclSuccess);
+	assert(eclGetKernel("vecAdd", &k2) == eclSuccess);
+	assert(eclGetKernel("vecAdd", &k3) == eclSuccess);
+	size_t globalSize = vecSize;
+
+	getTime(&s);
+	// c = a + b and d = b + a are independent
+	ecl_event ev[3];
+	setArgs(k1, c, a, b);
+	ret = eclCallNDRangeAsync(k1, 1, NULL, &globalSize, NULL, 0, NULL, &ev[0]);
+	assert(ret == eclSuccess);
+	setArgs(k2, d, b, a);
+	ret = eclCallNDRangeAsync(k2, 1, NULL, &globalSize, NULL, 0, NULL, &ev[1]);
+	assert(ret == eclSuccess);
+	// e = c + d needs both results
+	setArgs(k3, e, c, d);
+	ret = eclCallNDRangeAsync(k3, 1, NULL, &globalSize, NULL, 2, ev, &ev[2]);
+	assert(ret == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Launch: ", "\n");
+
+	// Consume the first result while the last kernel might still be running
+	getTime(&s);
+	assert(eclEventWait(ev[0]) == eclSuccess);
+	fprintf(stderr, "Error c: %f\n", diff(c, a, b, 1.f));
+	getTime(&t);
+	printTime(&s, &t, "First: ", "\n");
+
+	getTime(&s);
+	assert(eclEventWait(ev[2]) == eclSuccess);
+	assert(eclEventQuery(ev[2]) == eclSuccess);
+	float err = diff(e, a, b, 2.f);
+	fprintf(stderr, "Error e: %f\n", err);
+	getTime(&t);
+	printTime(&s, &t, "Last: ", "\n");
+
+	for(unsigned i = 0; i < 3; i++) assert(eclEventRelease(ev[i]) == eclSuccess);
+	assert(eclReleaseKernel(k1) == eclSuccess);
+	assert(eclReleaseKernel(k2) == eclSuccess);
+	assert(eclReleaseKernel(k3) == eclSuccess);
+
+	eclFree(a);
+	eclFree(b);
+	eclFree(c);
+	eclFree(d);
+	eclFree(e);
+
+	return err > 1e-3f * vecSize;
+}
@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <gmac/opencl.h>
+
+#include "utils.h"
+
+const char *vecSizeStr = "GMAC_VECSIZE";
+const unsigned vecSizeDefault = 64 * 1024 * 1024;
+unsigned vecSize = 0;
+
+const char *checkpointFile = "eclCheckpoint.ckpt";
+
+static int check(uint8_t *shared, uint8_t offset, const char *name)
+{
+	for(unsigned i = 0; i < vecSize; i++) {
+		if(shared[i] != uint8_t((i + offset) & 0xff)) {
+			fprintf(stderr, "%s: error at position %u\n", name, i);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	gmactime_t s, t;
+	setParam<unsigned>(&vecSize, vecSizeStr, vecSizeDefault);
+
+	uint8_t *shared = NULL;
+	assert(eclMalloc((void **)&shared, vecSize) == eclSuccess);
+	for(unsigned i = 0; i < vecSize; i++) shared[i] = uint8_t(i & 0xff);
+
+	void *objs[] = { shared };
+	getTime(&s);
+	assert(eclCheckpoint(checkpointFile, objs, 1) == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Snapshot: ", "\n");
+
+	// Writes after the snapshot must not reach the checkpoint file
+	for(unsigned i = 0; i < vecSize; i++) shared[i] = uint8_t((i + 1) & 0xff);
+
+	getTime(&s);
+	assert(eclCheckpointWait() == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Wait: ", "\n");
+	int ret = check(shared, 1, "Modified");
+
+	getTime(&s);
+	assert(eclRestore(checkpointFile, objs, 1) == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Restore: ", "\n");
+	if(ret == 0) ret = check(shared, 0, "Restored");
+
+	assert(eclFree(shared) == eclSuccess);
+	remove(checkpointFile);
+
+	return ret;
+}
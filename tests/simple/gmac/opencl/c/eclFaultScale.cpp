@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <gmac/opencl.h>
+
+#include "barrier.h"
+#include "utils.h"
+#include "debug.h"
+
+const char *nThreadsStr = "GMAC_THREADS";
+const unsigned nThreadsDefault = 16;
+unsigned nThreads = nThreadsDefault;
+
+const char *vecSizeStr = "GMAC_VECSIZE";
+const unsigned vecSizeDefault = 4 * 1024 * 1024;
+unsigned vecSize = vecSizeDefault;
+
+const char *roundsStr = "GMAC_ROUNDS";
+const unsigned roundsDefault = 8;
+unsigned rounds = roundsDefault;
+
+// Distance between writes, so every page produces a fault
+const unsigned stride = 4096 / sizeof(unsigned);
+
+const char *kernel = "\
+__kernel void inc(__global unsigned *a, unsigned size)\
+{\
+    unsigned i = get_global_id(0);\
+    if(i >= size) return;\
+\
+    a[i] += 1;\
+}\
+";
+
+unsigned **objects;
+barrier_t barrier;
+
+void *writer(void *p)
+{
+    unsigned id = *(unsigned *)p;
+    unsigned *a = objects[id];
+
+    for(unsigned r = 0; r < rounds; r++) {
+        barrier_wait(&barrier);
+        // Each thread faults on its own object
+        for(unsigned i = 0; i < vecSize; i += stride) a[i]++;
+        barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    gmactime_t s, t;
+    ecl_kernel kernel;
+
+    setParam<unsigned>(&nThreads, nThreadsStr, nThreadsDefault);
+    setParam<unsigned>(&vecSize, vecSizeStr, vecSizeDefault);
+    setParam<unsigned>(&rounds, roundsStr, roundsDefault);
+
+    assert(eclCompileSource(::kernel) == eclSuccess);
+    assert(eclGetKernel("inc", &kernel) == eclSuccess);
+
+    fprintf(stdout, "Threads: %u\n", nThreads);
+    fprintf(stdout, "Vector: %f\n", 1.0 * vecSize * sizeof(unsigned) / 1024 / 1024);
+
+    objects = (unsigned **)malloc(nThreads * sizeof(unsigned *));
+    for(unsigned n = 0; n < nThreads; n++) {
+        assert(eclMalloc((void **)&objects[n], vecSize * sizeof(unsigned)) == eclSuccess);
+        eclMemset(objects[n], 0, vecSize * sizeof(unsigned));
+    }
+
+    thread_t *threads = (thread_t *)malloc(nThreads * sizeof(thread_t));
+    unsigned *ids = (unsigned *)malloc(nThreads * sizeof(unsigned));
+    barrier_init(&barrier, nThreads + 1);
+    for(unsigned n = 0; n < nThreads; n++) {
+        ids[n] = n;
+        threads[n] = thread_create(writer, &ids[n]);
+    }
+
+    size_t globalSize = vecSize;
+    double faults = 0;
+    for(unsigned r = 0; r < rounds; r++) {
+        // Kernels invalidate the host copy, so the next round faults again
+        for(unsigned n = 0; n < nThreads; n++) {
+            assert(eclSetKernelArgPtr(kernel, 0, objects[n]) == eclSuccess);
+            assert(eclSetKernelArg(kernel, 1, sizeof(vecSize), &vecSize) == eclSuccess);
+            assert(eclCallNDRange(kernel, 1, NULL, &globalSize, NULL) == eclSuccess);
+        }
+        getTime(&s);
+        barrier_wait(&barrier);
+        barrier_wait(&barrier);
+        getTime(&t);
+        faults += getTimeStamp(t) - getTimeStamp(s);
+    }
+    fprintf(stdout, "Faults: %f us/round\n", faults / rounds);
+
+    for(unsigned n = 0; n < nThreads; n++) thread_wait(threads[n]);
+
+    // Every element was incremented once per round by the kernel, and once
+    // per round by the writer if it sits at the beginning of a page
+    for(unsigned n = 0; n < nThreads; n++) {
+        for(unsigned i = 0; i < vecSize; i++) {
+            unsigned expected = (i % stride == 0) ? 2 * rounds : rounds;
+            if(objects[n][i] != expected) {
+                fprintf(stderr, "Object %u, pos %u: %u vs %u\n", n, i, objects[n][i], expected);
+                abort();
+            }
+        }
+        eclFree(objects[n]);
+    }
+
+    eclReleaseKernel(kernel);
+    free(ids);
+    free(threads);
+    free(objects);
+
+    return 0;
+}
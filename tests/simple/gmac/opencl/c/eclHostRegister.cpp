@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <gmac/opencl.h>
+
+#include "utils.h"
+
+const char *vecSizeStr = "GMAC_VECSIZE";
+const unsigned vecSizeDefault = 64 * 1024 * 1024;
+unsigned vecSize = 0;
+
+static int copyTest(uint8_t *host, uint8_t *shared, size_t size, const char *name)
+{
+	gmactime_t s, t;
+
+	for(unsigned i = 0; i < size; i++) host[i] = uint8_t(i & 0xff);
+
+	getTime(&s);
+	eclMemcpy(shared, host, size);
+	getTime(&t);
+	printTime(&s, &t, name, " (to accelerator)\n");
+
+	memset(host, 0, size);
+
+	getTime(&s);
+	eclMemcpy(host, shared, size);
+	getTime(&t);
+	printTime(&s, &t, name, " (to host)\n");
+
+	for(unsigned i = 0; i < size; i++) {
+		if(host[i] != uint8_t(i & 0xff)) {
+			fprintf(stderr, "%s: error at position %u\n", name, i);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	setParam<unsigned>(&vecSize, vecSizeStr, vecSizeDefault);
+
+	uint8_t *host = (uint8_t *)malloc(vecSize);
+	assert(host != NULL);
+	uint8_t *shared = NULL;
+	assert(eclMalloc((void **)&shared, vecSize) == eclSuccess);
+
+	int ret = copyTest(host, shared, vecSize, "Staged: ");
+
+	if(ret == 0) {
+		ecl_error err = eclHostRegister(host, vecSize);
+		if(err != eclSuccess) {
+			fprintf(stderr, "Unable to register host memory: %d\n", err);
+			ret = 1;
+		} else {
+			ret = copyTest(host, shared, vecSize, "Registered: ");
+			// Copies that do not start at the beginning of the registered memory
+			const size_t offset = 4096 + 64;
+			if(ret == 0) ret = copyTest(host + offset, shared, vecSize - offset, "Registered (offset): ");
+			assert(eclHostUnregister(host) == eclSuccess);
+		}
+	}
+
+	assert(eclFree(shared) == eclSuccess);
+	free(host);
+
+	return ret;
+}
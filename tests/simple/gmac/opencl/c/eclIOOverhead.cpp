@@ -0,0 +1,67 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <gmac/opencl.h>
+
+#include "utils.h"
+#include "debug.h"
+
+// Measures the cost added by GMAC to I/O calls on buffers not allocated by GMAC
+
+const unsigned calls = 1024 * 1024;
+const size_t chunkSize = 64;
+const size_t gmacSize = 4 * 1024 * 1024;
+
+static void doTest(void *buffer, const char *name)
+{
+	gmactime_t s, t;
+	static char msg[1024];
+
+	FILE *file = tmpfile();
+	assert(file != NULL);
+	// Do not let stdio hide calls to the system
+	setvbuf(file, NULL, _IONBF, 0);
+
+	getTime(&s);
+	for(unsigned i = 0; i < calls; i++) {
+		size_t ret = fwrite(buffer, 1, chunkSize, file);
+		assert(ret == chunkSize);
+	}
+	getTime(&t);
+	snprintf(msg, 1024, "%s:fwrite: ", name);
+	printAvgTime(&s, &t, msg, " s/call\n", calls);
+
+	rewind(file);
+	getTime(&s);
+	for(unsigned i = 0; i < calls; i++) {
+		size_t ret = fread(buffer, 1, chunkSize, file);
+		assert(ret == chunkSize);
+	}
+	getTime(&t);
+	snprintf(msg, 1024, "%s:fread: ", name);
+	printAvgTime(&s, &t, msg, " s/call\n", calls);
+
+	fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+	char *gmacBuffer = NULL;
+	char *heapBuffer = (char *)malloc(chunkSize);
+	assert(heapBuffer != NULL);
+	memset(heapBuffer, 0x5a, chunkSize);
+
+	// Allocate shared memory so GMAC tracks at least one object
+	assert(eclMalloc((void **)&gmacBuffer, gmacSize) == eclSuccess);
+	memset(gmacBuffer, 0x5a, gmacSize);
+
+	doTest(heapBuffer, "Heap");
+	doTest(gmacBuffer, "GMAC");
+
+	eclFree(gmacBuffer);
+	free(heapBuffer);
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gmac/opencl.h>
+
+#include "utils.h"
+
+const char *vecSizeStr = "GMAC_VECSIZE";
+const unsigned vecSizeDefault = 64 * 1024 * 1024;
+unsigned vecSize = 0;
+
+const unsigned blockSize = 256;
+
+const char *mapFile = "eclMapFile.dat";
+
+const char *kernel = "\
+__kernel void inc(__global unsigned char *a, unsigned size)\
+{\
+	unsigned i = get_global_id(0);\
+	if(i >= size) return;\
+	a[i] = a[i] + 1;\
+}\
+";
+
+static int check(const uint8_t *data, size_t size, uint8_t offset, const char *name)
+{
+	for(unsigned i = 0; i < size; i++) {
+		if(data[i] != uint8_t((i + offset) & 0xff)) {
+			fprintf(stderr, "%s: error at position %u\n", name, i);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	gmactime_t s, t;
+	setParam<unsigned>(&vecSize, vecSizeStr, vecSizeDefault);
+
+	assert(eclCompileSource(kernel) == eclSuccess);
+
+	uint8_t *data = (uint8_t *)malloc(vecSize);
+	assert(data != NULL);
+	for(unsigned i = 0; i < vecSize; i++) data[i] = uint8_t(i & 0xff);
+	FILE *f = fopen(mapFile, "wb");
+	assert(f != NULL);
+	assert(fwrite(data, 1, vecSize, f) == vecSize);
+	fclose(f);
+
+	int fd = open(mapFile, O_RDWR);
+	assert(fd >= 0);
+	uint8_t *shared = NULL;
+	getTime(&s);
+	assert(eclMapFile((void **)&shared, fd, 0, vecSize, GMAC_PROT_READWRITE) == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Map: ", "\n");
+	close(fd);
+
+	// Only the blocks touched by the host are read from the file
+	getTime(&s);
+	int ret = check(shared + vecSize / 2, vecSize / 4, uint8_t((vecSize / 2) & 0xff), "Host");
+	getTime(&t);
+	printTime(&s, &t, "Host: ", "\n");
+
+	// The rest of the file is read before the kernel runs
+	getTime(&s);
+	size_t localSize = blockSize;
+	size_t globalSize = vecSize / blockSize;
+	if(vecSize % blockSize) globalSize++;
+	globalSize *= localSize;
+	ecl_kernel k;
+	assert(eclGetKernel("inc", &k) == eclSuccess);
+	assert(eclSetKernelArgPtr(k, 0, shared) == eclSuccess);
+	assert(eclSetKernelArg(k, 1, sizeof(vecSize), &vecSize) == eclSuccess);
+	assert(eclCallNDRange(k, 1, NULL, &globalSize, &localSize) == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Run: ", "\n");
+	if(ret == 0) ret = check(shared, vecSize, 1, "Accelerator");
+
+	getTime(&s);
+	assert(eclUnmapFile(shared) == eclSuccess);
+	getTime(&t);
+	printTime(&s, &t, "Unmap: ", "\n");
+
+	f = fopen(mapFile, "rb");
+	assert(f != NULL);
+	assert(fread(data, 1, vecSize, f) == vecSize);
+	fclose(f);
+	if(ret == 0) ret = check(data, vecSize, 1, "File");
+
+	free(data);
+	remove(mapFile);
+
+	return ret;
+}
@@ -0,0 +1,97 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <gmac/opencl.h>
+
+#include "utils.h"
+#include "debug.h"
+
+// Run with GMAC_OVERSUBSCRIBE=1 and GMAC_ACC_MEMORY_CAP set below the total
+// size of the vectors to force evictions
+
+const char *vecSizeStr = "GMAC_VECSIZE";
+const unsigned vecSizeDefault = 4 * 1024 * 1024;
+unsigned vecSize = vecSizeDefault;
+
+const char *nVectorsStr = "GMAC_VECTORS";
+const unsigned nVectorsDefault = 8;
+unsigned nVectors = nVectorsDefault;
+
+const unsigned nPasses = 2;
+
+const char *kernel = "\
+					 __kernel void vecInc(__global float *v, unsigned size)\
+					 {\
+					 unsigned i = get_global_id(0);\
+					 if(i >= size) return;\
+					 \
+					 v[i] += 1.0f;\
+					 }\
+					 ";
+
+
+int main(int argc, char *argv[])
+{
+	gmactime_t s, t;
+	ecl_error ret = eclSuccess;
+
+	setParam<unsigned>(&vecSize, vecSizeStr, vecSizeDefault);
+	setParam<unsigned>(&nVectors, nVectorsStr, nVectorsDefault);
+	fprintf(stdout, "Vectors: %u x %f MB\n", nVectors, 1.0 * vecSize * sizeof(float) / 1024 / 1024);
+
+	ret = eclCompileSource(kernel);
+	assert(ret == eclSuccess);
+
+	getTime(&s);
+	float **v = (float **)malloc(nVectors * sizeof(float *));
+	for(unsigned n = 0; n < nVectors; n++) {
+		ret = eclMalloc((void **)&v[n], vecSize * sizeof(float));
+		assert(ret == eclSuccess);
+		for(unsigned i = 0; i < vecSize; i++) v[n][i] = float(n);
+	}
+	getTime(&t);
+	printTime(&s, &t, "Alloc: ", "\n");
+
+	getTime(&s);
+	ecl_kernel kernel;
+	size_t globalSize = vecSize;
+	ret = eclGetKernel("vecInc", &kernel);
+	assert(ret == eclSuccess);
+	ret = eclSetKernelArg(kernel, 1, sizeof(vecSize), &vecSize);
+	assert(ret == eclSuccess);
+	// Vectors are used round-robin, so the least recently used one is
+	// always the next to be evicted
+	for(unsigned p = 0; p < nPasses; p++) {
+		for(unsigned n = 0; n < nVectors; n++) {
+			ret = eclSetKernelArgPtr(kernel, 0, v[n]);
+			assert(ret == eclSuccess);
+			ret = eclCallNDRange(kernel, 1, NULL, &globalSize, NULL);
+			assert(ret == eclSuccess);
+		}
+	}
+	getTime(&t);
+	printTime(&s, &t, "Run: ", "\n");
+
+	getTime(&s);
+	unsigned errors = 0;
+	for(unsigned n = 0; n < nVectors; n++) {
+		for(unsigned i = 0; i < vecSize; i++) {
+			if(v[n][i] != float(n + nPasses)) errors++;
+		}
+	}
+	getTime(&t);
+	printTime(&s, &t, "Check: ", "\n");
+	fprintf(stderr, "Errors: %u\n", errors);
+
+	ret = eclReleaseKernel(kernel);
+	assert(ret == eclSuccess);
+
+	for(unsigned n = 0; n < nVectors; n++) {
+		ret = eclFree(v[n]);
+		assert(ret == eclSuccess);
+	}
+	free(v);
+
+	return errors != 0;
+}
@@ -93,3 +93,31 @@ TEST_F(BuddyTest, RandomAllocations) {
     }
 
 }
+
+TEST_F(BuddyTest, LargePool) {
+    // The pool is never touched, so it does not need to be backed by memory
+    if(sizeof(size_t) < 8) return;
+    const size_t Size = size_t(8) * 1024 * 1024 * 1024;
+    Buddy buddy(hostptr_t(BasePtr_), Size);
+
+    size_t size = Size / 2;
+    hostptr_t low = buddy.get(size);
+    ASSERT_TRUE(low != NULL);
+    ASSERT_EQ(Size / 2, size);
+
+    // Chunks past the first 4GB of the pool
+    size = Size / 4;
+    hostptr_t high = buddy.get(size);
+    ASSERT_TRUE(high != NULL);
+    ASSERT_EQ(Size / 4, size);
+    ASSERT_EQ(Size / 2, size_t(high - low));
+
+    size = size_t(3) * 1024 * 1024 * 1024;
+    ASSERT_TRUE(buddy.get(size) == NULL);
+
+    buddy.put(low, Size / 2);
+    buddy.put(high, Size / 4);
+    size = Size;
+    ASSERT_TRUE(buddy.get(size) == BasePtr_);
+    ASSERT_EQ(Size, size);
+}
@@ -199,3 +199,27 @@ TEST_F(ModeTest, Mode) {
     ASSERT_TRUE(mode != NULL);
 	if(&(mode->getAccelerator()) != &acc) ASSERT_EQ(gmacSuccess, mode->moveTo(acc));
 }
+
+TEST_F(ModeTest, Pending) {
+    Accelerator &acc = Mode_->getAccelerator();
+    unsigned pending = acc.pending();
+    unsigned waits = Mode_->waits();
+    Mode_->launched();
+    Mode_->launched();
+    ASSERT_EQ(2U, Mode_->pending());
+    Mode_->completed(waits);
+    EXPECT_EQ(1U, Mode_->pending());
+    EXPECT_EQ(pending + 1, acc.pending());
+
+    ASSERT_EQ(gmacSuccess, Mode_->wait());
+    EXPECT_EQ(0U, Mode_->pending());
+    EXPECT_EQ(pending, acc.pending());
+
+    // Kernels launched before the wait are not accounted twice
+    Mode_->launched();
+    Mode_->completed(waits);
+    EXPECT_EQ(1U, Mode_->pending());
+    Mode_->completed(Mode_->waits());
+    EXPECT_EQ(0U, Mode_->pending());
+    EXPECT_EQ(pending, acc.pending());
+}
@@ -4,6 +4,7 @@
 #include "core/hpe/Process.h"
 #include "core/hpe/Thread.h"
 #include "memory/ObjectMap.h"
+#include "util/Parameter.h"
 
 
 using __impl::core::hpe::Accelerator;
@@ -16,6 +17,9 @@ using gmac::core::hpe::Thread;
 using __impl::memory::Object;
 using __impl::memory::Protocol;
 
+using __impl::util::params::ParamRebalance;
+using __impl::util::params::ParamRebalanceThreshold;
+
 extern void CUDA(Process &);
 extern void OpenCL(Process &);
 
@@ -80,4 +84,138 @@ TEST_F(ProcessTest, Mode) {
 	ASSERT_FALSE(proc->allIntegrated());
 	
 	proc->destroy();
-}
\ No newline at end of file
+}
+
+TEST_F(ProcessTest, Placement) {
+    Process *proc = createProcess();
+    ASSERT_TRUE(proc != NULL);
+
+    Mode *mode = proc->createMode();
+    ASSERT_TRUE(mode != NULL);
+    Accelerator &acc = mode->getAccelerator();
+    ASSERT_EQ(0U, mode->pending());
+
+    unsigned pending = acc.pending();
+    mode->launched();
+    ASSERT_EQ(1U, mode->pending());
+    ASSERT_EQ(pending + 1, acc.pending());
+    ASSERT_EQ(gmacSuccess, mode->wait());
+    ASSERT_EQ(0U, mode->pending());
+    ASSERT_EQ(pending, acc.pending());
+
+    // Rebalancing is disabled by default
+    ASSERT_EQ(gmacSuccess, proc->rebalance());
+
+    proc->removeMode(*mode);
+    proc->destroy();
+}
+
+TEST_F(ProcessTest, PlacementCost) {
+    Process *proc = createProcess();
+    ASSERT_TRUE(proc != NULL);
+
+    Accelerator &acc = proc->getAccelerator(0);
+    size_t free, total;
+    acc.getMemInfo(free, total);
+    ASSERT_GT(free, 2U);
+
+    // Larger footprints leave less accelerator memory
+    bool fits;
+    float empty = proc->placementCost(acc, 0, NULL, fits);
+    ASSERT_TRUE(fits);
+    float half = proc->placementCost(acc, free / 2, NULL, fits);
+    ASSERT_TRUE(fits);
+    ASSERT_LT(empty, half);
+    float full = proc->placementCost(acc, free + 1, NULL, fits);
+    ASSERT_FALSE(fits);
+    ASSERT_LE(half, full);
+
+    // Attached modes and their outstanding kernels are added to the cost
+    Mode *mode = proc->createMode(0);
+    ASSERT_TRUE(mode != NULL);
+    float loaded = proc->placementCost(acc, 0, NULL, fits);
+    ASSERT_LT(empty, loaded);
+    mode->launched();
+    float busy = proc->placementCost(acc, 0, NULL, fits);
+    ASSERT_LT(loaded, busy);
+
+    // A mode does not account for its own load
+    float own = proc->placementCost(acc, 0, mode, fits);
+    ASSERT_TRUE(fits);
+    ASSERT_LT(own, busy);
+    ASSERT_EQ(gmacSuccess, mode->wait());
+
+    proc->removeMode(*mode);
+    proc->destroy();
+}
+
+TEST_F(ProcessTest, SelectAccelerator) {
+    Process *proc = createProcess();
+    ASSERT_TRUE(proc != NULL);
+
+    // The cheapest accelerator is selected
+    float cost;
+    bool fits;
+    unsigned acc = proc->selectAccelerator(0, NULL, cost);
+    ASSERT_LT(acc, proc->nAccelerators());
+    for(unsigned i = 0; i < proc->nAccelerators(); i++) {
+        float c = proc->placementCost(proc->getAccelerator(i), 0, NULL, fits);
+        ASSERT_TRUE(fits);
+        ASSERT_LE(cost, c);
+    }
+
+    // Objects that do not fit anywhere still get an accelerator
+    size_t free, total;
+    proc->getAccelerator(acc).getMemInfo(free, total);
+    acc = proc->selectAccelerator(total + 1, NULL, cost);
+    ASSERT_LT(acc, proc->nAccelerators());
+    proc->placementCost(proc->getAccelerator(acc), total + 1, NULL, fits);
+    ASSERT_FALSE(fits);
+
+    if(proc->nAccelerators() >= 2) {
+        // Loaded accelerators are avoided
+        Mode *first = proc->createMode(0);
+        ASSERT_TRUE(first != NULL);
+        Mode *second = proc->createMode(0);
+        ASSERT_TRUE(second != NULL);
+        ASSERT_NE(0U, proc->selectAccelerator(0, NULL, cost));
+        proc->removeMode(*second);
+        proc->removeMode(*first);
+    }
+
+    proc->destroy();
+}
+
+TEST_F(ProcessTest, Rebalance) {
+    Process *proc = createProcess();
+    ASSERT_TRUE(proc != NULL);
+    ASSERT_EQ(gmacSuccess, proc->migrate(0));
+    ASSERT_EQ(0U, Thread::getCurrentMode().getAccelerator().id());
+
+    bool rebalance = ParamRebalance;
+    float threshold = ParamRebalanceThreshold;
+    ParamRebalance = true;
+    ParamRebalanceThreshold = 0.5f;
+
+    // Modes stay where they are if there is no other accelerator
+    ASSERT_EQ(gmacSuccess, proc->rebalance());
+    if(proc->nAccelerators() < 2) {
+        ASSERT_EQ(0U, Thread::getCurrentMode().getAccelerator().id());
+    }
+    else {
+        // Idle modes leave loaded accelerators
+        ASSERT_EQ(gmacSuccess, proc->migrate(0));
+        Mode *first = proc->createMode(0);
+        ASSERT_TRUE(first != NULL);
+        Mode *second = proc->createMode(0);
+        ASSERT_TRUE(second != NULL);
+        ASSERT_EQ(gmacSuccess, proc->rebalance());
+        ASSERT_NE(0U, Thread::getCurrentMode().getAccelerator().id());
+        proc->removeMode(*second);
+        proc->removeMode(*first);
+    }
+
+    ParamRebalance = rebalance;
+    ParamRebalanceThreshold = threshold;
+    proc->destroy();
+}
@@ -1,3 +1,11 @@
+#if defined(POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#include <cstdio>
+
 #include "gtest/gtest.h"
 
 #include "core/IOBuffer.h"
@@ -7,11 +15,14 @@
 #include "memory/Manager.h"
 #include "memory/ObjectMap.h"
 #include "memory/Object.h"
+#include "util/Parameter.h"
 
 using namespace gmac::core::hpe;
 using namespace gmac::memory;
 
 using __impl::memory::ObjectMap;
+using __impl::util::params::ParamProtocol;
+using __impl::util::params::ParamWriteBehind;
  
 class ManagerTest : public testing::Test {
 public:
@@ -79,6 +90,28 @@ TEST_F(ManagerTest, Alloc) {
     manager->destroy();
 }
 
+TEST_F(ManagerTest, TranslateCached) {
+    ASSERT_TRUE(Process_ != NULL);
+    Manager *manager = new Manager(*Process_);
+    ASSERT_TRUE(manager != NULL);
+    __impl::core::hpe::Mode &mode = Thread::getCurrentMode();
+
+    hostptr_t ptr = NULL;
+    ASSERT_EQ(gmacSuccess, manager->alloc(mode, &ptr, Size_));
+    ASSERT_TRUE(ptr != NULL);
+    accptr_t base = manager->translate(mode, ptr);
+    ASSERT_TRUE(base.get() != NULL);
+    // Second translation comes from the cache
+    ASSERT_TRUE(manager->translate(mode, ptr) == base);
+    ASSERT_TRUE(manager->translate(mode, ptr + Size_ / 2) == base + Size_ / 2);
+    ASSERT_EQ(gmacSuccess, manager->free(mode, ptr));
+
+    // Freed objects are not found in the cache
+    ASSERT_TRUE(manager->translate(mode, ptr) == 0);
+
+    manager->destroy();
+}
+
 TEST_F(ManagerTest, GlobalAllocReplicated) {
 	ASSERT_TRUE(Process_ != NULL);
     Manager *manager = new Manager(*Process_);
@@ -95,6 +128,44 @@ TEST_F(ManagerTest, GlobalAllocReplicated) {
     manager->destroy();
 }
 
+TEST_F(ManagerTest, GlobalAllocReplicatedCoherence) {
+	ASSERT_TRUE(Process_ != NULL);
+    Manager *manager = new Manager(*Process_);
+    ASSERT_TRUE(manager != NULL);
+
+    hostptr_t ptr = NULL;
+    ASSERT_EQ(gmacSuccess, manager->globalAlloc(Thread::getCurrentMode(), &ptr, Size_,
+                                                GMAC_GLOBAL_MALLOC_REPLICATED));
+    ASSERT_TRUE(ptr != NULL);
+
+    // Use a second accelerator when available, a second context otherwise
+    __impl::core::hpe::Mode *mode = Process_->createMode(Process_->nAccelerators() > 1 ? 1 : 0);
+    ASSERT_TRUE(mode != NULL);
+    ASSERT_TRUE(manager->translate(*mode, ptr).get() != NULL);
+
+    for(size_t s = 0; s < Size_; s++) {
+        ptr[s] = (s & 0xff);
+    }
+    ASSERT_EQ(gmacSuccess, manager->releaseObjects(Thread::getCurrentMode()));
+
+    // All copies must hold the data written by the host
+    uint8_t *buffer = new uint8_t[Size_];
+    __impl::core::hpe::Mode *modes[] = { &Thread::getCurrentMode(), mode };
+    for(int m = 0; m < 2; m++) {
+        memset(buffer, 0, Size_);
+        ASSERT_EQ(gmacSuccess, modes[m]->copyToHost(buffer, manager->translate(*modes[m], ptr), Size_));
+        for(size_t s = 0; s < Size_; s++) {
+            EXPECT_EQ(buffer[s], (s & 0xff));
+        }
+    }
+    delete[] buffer;
+
+    ASSERT_EQ(gmacSuccess, manager->acquireObjects(Thread::getCurrentMode()));
+    ASSERT_EQ(gmacSuccess, manager->free(Thread::getCurrentMode(), ptr));
+    Process_->removeMode(*mode);
+    manager->destroy();
+}
+
 #if !defined(USE_OPENCL)
 TEST_F(ManagerTest, GlobalAllocCentralized) {
 	ASSERT_TRUE(Process_ != NULL);
@@ -155,6 +226,92 @@ TEST_F(ManagerTest, Coherence) {
     manager->destroy();
 }
 
+TEST_F(ManagerTest, SparseCoherence) {
+	ASSERT_TRUE(Process_ != NULL);
+    Manager *manager = new Manager(*Process_);
+    ASSERT_TRUE(manager != NULL);
+
+    // Objects of modes created now use the Gather protocol with eager
+    // updates, which sends whole blocks without subblock tracking
+    const char *protocol = ParamProtocol;
+    ParamProtocol = "RollingGather";
+    __impl::core::hpe::Mode *mode = Process_->createMode(0);
+    ParamProtocol = protocol;
+    ASSERT_TRUE(mode != NULL);
+
+    hostptr_t ptr = NULL;
+    ASSERT_EQ(gmacSuccess, manager->alloc(*mode, &ptr, Size_));
+    ASSERT_TRUE(ptr != NULL);
+    ASSERT_EQ(gmacSuccess, manager->memset(*mode, ptr, 0, Size_));
+
+    // Touch a few scattered words so only some subblocks become dirty
+    const size_t stride = 37 * 1024 + 12;
+    for(int n = 1; n < 4; n++) {
+        for(size_t s = 0; s < Size_; s += stride) {
+            ptr[s] = uint8_t(n);
+        }
+
+        ASSERT_EQ(gmacSuccess, manager->releaseObjects(*mode));
+        ASSERT_EQ(gmacSuccess, manager->acquireObjects(*mode));
+
+        for(size_t s = 0; s < Size_; s++) {
+            if(s % stride == 0) EXPECT_EQ(n, ptr[s]);
+            else EXPECT_EQ(0, ptr[s]);
+        }
+    }
+
+    ASSERT_EQ(gmacSuccess, manager->free(*mode, ptr));
+    Process_->removeMode(*mode);
+    manager->destroy();
+}
+
+TEST_F(ManagerTest, WriteBehindFree) {
+	ASSERT_TRUE(Process_ != NULL);
+    Manager *manager = new Manager(*Process_);
+    ASSERT_TRUE(manager != NULL);
+
+    // Blocks left behind by the sequential writer are queued for the
+    // write-back thread, which might not have reached them when they are freed
+    bool writeBehind = ParamWriteBehind;
+    ParamWriteBehind = true;
+    for(int n = 0; n < 16; n++) {
+        hostptr_t ptr = NULL;
+        ASSERT_EQ(gmacSuccess, manager->alloc(Thread::getCurrentMode(), &ptr, Size_));
+        ASSERT_TRUE(ptr != NULL);
+        for(size_t s = 0; s < Size_; s++) ptr[s] = uint8_t(s & 0xff);
+        ASSERT_EQ(gmacSuccess, manager->free(Thread::getCurrentMode(), ptr));
+    }
+    ParamWriteBehind = writeBehind;
+    manager->destroy();
+}
+
+TEST_F(ManagerTest, PrefetchFree) {
+	ASSERT_TRUE(Process_ != NULL);
+    Manager *manager = new Manager(*Process_);
+    ASSERT_TRUE(manager != NULL);
+
+    // Prefetched blocks are moved by the write-back thread, which might not
+    // have reached them when they are freed
+    for(int n = 0; n < 16; n++) {
+        hostptr_t ptr = NULL;
+        ASSERT_EQ(gmacSuccess, manager->alloc(Thread::getCurrentMode(), &ptr, Size_));
+        ASSERT_TRUE(ptr != NULL);
+        for(size_t s = 0; s < Size_; s++) ptr[s] = uint8_t(s & 0xff);
+        ASSERT_EQ(gmacSuccess, manager->prefetch(Thread::getCurrentMode(), ptr, Size_,
+                                                 GMAC_PREFETCH_ACCELERATOR));
+        ASSERT_EQ(gmacSuccess, manager->free(Thread::getCurrentMode(), ptr));
+
+        ASSERT_EQ(gmacSuccess, manager->alloc(Thread::getCurrentMode(), &ptr, Size_));
+        ASSERT_TRUE(ptr != NULL);
+        ASSERT_EQ(gmacSuccess, manager->releaseObjects(Thread::getCurrentMode()));
+        ASSERT_EQ(gmacSuccess, manager->acquireObjects(Thread::getCurrentMode()));
+        ASSERT_EQ(gmacSuccess, manager->prefetch(Thread::getCurrentMode(), ptr, Size_,
+                                                 GMAC_PREFETCH_HOST));
+        ASSERT_EQ(gmacSuccess, manager->free(Thread::getCurrentMode(), ptr));
+    }
+    manager->destroy();
+}
+
 TEST_F(ManagerTest, IOBufferWrite) {
     ASSERT_TRUE(Process_ != NULL);
     Manager *manager = new Manager(*Process_);
@@ -243,3 +400,45 @@ TEST_F(ManagerTest, Memcpy) {
 	ASSERT_EQ(gmacSuccess, manager->flushDirty(Thread::getCurrentMode()));
 	manager->destroy();
 }
+
+#if defined(POSIX)
+TEST_F(ManagerTest, MapFileShort) {
+    ASSERT_TRUE(Process_ != NULL);
+    Manager *manager = new Manager(*Process_);
+    ASSERT_TRUE(manager != NULL);
+
+    // The file is shorter than the page the object takes
+    const size_t fileSize = 1000;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/gmac-mapfile-%d", int(getpid()));
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    ASSERT_GE(fd, 0);
+    uint8_t data[fileSize];
+    for(size_t s = 0; s < fileSize; s++) data[s] = uint8_t(s & 0xff);
+    ASSERT_EQ(ssize_t(fileSize), pwrite(fd, data, fileSize, 0));
+
+    hostptr_t ptr = NULL;
+    ASSERT_EQ(gmacSuccess, manager->mapFile(Thread::getCurrentMode(), &ptr, fileSize, fd, 0,
+                                            GMAC_PROT_READWRITE));
+    ASSERT_TRUE(ptr != NULL);
+    for(size_t s = 0; s < fileSize; s++) {
+        EXPECT_EQ(uint8_t(s & 0xff), ptr[s]);
+        ptr[s] = uint8_t((s + 1) & 0xff);
+    }
+    // Memory past the mapping is not written back
+    EXPECT_EQ(0, ptr[fileSize]);
+    ptr[fileSize] = 1;
+    ASSERT_EQ(gmacSuccess, manager->unmapFile(Thread::getCurrentMode(), ptr));
+
+    struct stat info;
+    ASSERT_EQ(0, fstat(fd, &info));
+    EXPECT_EQ(off_t(fileSize), info.st_size);
+    ASSERT_EQ(ssize_t(fileSize), pread(fd, data, fileSize, 0));
+    for(size_t s = 0; s < fileSize; s++) {
+        EXPECT_EQ(uint8_t((s + 1) & 0xff), data[s]);
+    }
+    close(fd);
+    unlink(path);
+    manager->destroy();
+}
+#endif
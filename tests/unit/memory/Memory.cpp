@@ -33,3 +33,25 @@ TEST(MemoryTest, MemoryShadowing) {
     Memory::unmap(hostptr_t(addr_), Size_ * sizeof(int));
 }
 
+
+TEST(MemoryTest, LargeShadowing) {
+    if(sizeof(size_t) < 8) return;
+    // Only the last megabyte of the mapping is ever touched
+    const size_t Offset = size_t(4) * 1024 * 1024 * 1024;
+    const size_t Size = Offset + Size_;
+
+    hostptr_t addr = Memory::map(NULL, Size, GMAC_PROT_READWRITE);
+    ASSERT_TRUE(addr != NULL);
+
+    int *shadow = (int *)Memory::shadow(addr + Offset, Size_);
+    ASSERT_TRUE(shadow != NULL);
+
+    int *ptr = (int *)(addr + Offset);
+    for(int n = 0; n < Size_ / int(sizeof(int)); n++) {
+        ptr[n] = n;
+        ASSERT_EQ(n, shadow[n]);
+    }
+
+    Memory::unshadow(hostptr_t(shadow), Size_);
+    Memory::unmap(addr, Size);
+}
@@ -92,6 +92,29 @@ TEST_F(ObjectTest, Blocks)
     object->decRef();
 }
 
+#ifndef USE_VM
+TEST_F(ObjectTest, BlockSize)
+{
+    ASSERT_TRUE(Process_ != NULL);
+    Mode &mode = Thread::getCurrentMode();
+    __impl::memory::ObjectMap &map = mode.getAddressSpace();
+    const size_t blockSize = 256 * 1024;
+    Object *object = map.getProtocol().createObject(mode, Size_, NULL, GMAC_PROT_READ, 0, blockSize);
+    ASSERT_TRUE(object != NULL);
+    object->addOwner(mode);
+    EXPECT_EQ(blockSize, object->blockSize());
+
+    for(size_t offset = 0; offset < object->size(); offset += blockSize) {
+        EXPECT_EQ(0, object->blockBase(offset));
+        EXPECT_EQ(blockSize, object->blockEnd(offset));
+        EXPECT_EQ(-1 * ssize_t(blockSize / 2), object->blockBase(offset + blockSize / 2));
+    }
+
+    map.removeObject(*object);
+    object->decRef();
+}
+#endif
+
 TEST_F(ObjectTest, Coherence)
 {
     ASSERT_TRUE(Process_ != NULL);
@@ -125,6 +148,36 @@ TEST_F(ObjectTest, Coherence)
     object->decRef();
 }
 
+TEST_F(ObjectTest, AcquireRead)
+{
+    ASSERT_TRUE(Process_ != NULL);
+    Mode &mode = Thread::getCurrentMode();
+    __impl::memory::ObjectMap &map = mode.getAddressSpace();
+    Object *object = map.getProtocol().createObject(mode, Size_, NULL, GMAC_PROT_READ, 0);
+    ASSERT_TRUE(object != NULL);
+    object->addOwner(mode);
+    map.addObject(*object);
+
+    hostptr_t ptr = object->addr();
+    for(size_t s = 0; s < object->size(); s++) {
+       ptr[s] = (s & 0xff);
+    }
+    ASSERT_EQ(gmacSuccess, object->release());
+    ASSERT_EQ(gmacSuccess, object->toAccelerator());
+
+    // Objects only read by the accelerator keep their host copy
+    GmacProtection prot = GMAC_PROT_READ;
+    ASSERT_EQ(gmacSuccess, object->acquire(prot));
+    mode.memset(object->acceleratorAddr(mode, object->addr()), 0, Size_);
+
+    for(size_t s = 0; s < object->size(); s++) {
+        EXPECT_EQ(ptr[s], (s & 0xff));
+    }
+
+    map.removeObject(*object);
+    object->decRef();
+}
+
 TEST_F(ObjectTest, IOBuffer)
 {
     ASSERT_TRUE(Process_ != NULL);
@@ -163,3 +216,48 @@ TEST_F(ObjectTest, IOBuffer)
     map.removeObject(*object);
     object->decRef();
 }
+
+TEST_F(ObjectTest, LargeObject)
+{
+    if(sizeof(size_t) < 8) return;
+    ASSERT_TRUE(Process_ != NULL);
+    // Only the blocks past the first 4GB of the object are transferred
+    const size_t Offset = size_t(4) * 1024 * 1024 * 1024;
+    const size_t Size = Offset + Size_;
+    Mode &mode = Thread::getCurrentMode();
+    __impl::memory::ObjectMap &map = mode.getAddressSpace();
+    Object *object = map.getProtocol().createObject(mode, Size, NULL, GMAC_PROT_READ, 0);
+    ASSERT_TRUE(object != NULL);
+    object->addOwner(mode);
+    map.addObject(*object);
+    ASSERT_EQ(Size, object->size());
+    ASSERT_EQ(Size, size_t(object->end() - object->addr()));
+
+    size_t blockSize = object->blockSize();
+    EXPECT_EQ(0, object->blockBase(Offset + Size_ - blockSize));
+    EXPECT_EQ(-1 * ssize_t(blockSize / 2), object->blockBase(Offset + blockSize / 2));
+
+    __impl::core::IOBuffer &buffer = mode.createIOBuffer(Size_, GMAC_PROT_READWRITE);
+    hostptr_t ptr = buffer.addr();
+    for(size_t s = 0; s < buffer.size(); s++) ptr[s] = (s & 0xff);
+    ASSERT_EQ(gmacSuccess, object->copyFromBuffer(buffer, Size_, 0, Offset));
+
+    // The data must be at the end of the object, not 4GB earlier
+    ptr = object->addr();
+    for(size_t s = 0; s < Size_; s++) {
+        EXPECT_EQ(ptr[Offset + s], (s & 0xff));
+        EXPECT_EQ(ptr[s], 0);
+    }
+
+    ::memset(buffer.addr(), 0, Size_);
+    ASSERT_EQ(gmacSuccess, object->copyToBuffer(buffer, Size_, 0, Offset));
+    ASSERT_EQ(gmacSuccess, buffer.wait());
+    ptr = buffer.addr();
+    int error = 0;
+    for(size_t s = 0; s < buffer.size(); s++) error += (ptr[s] - (s & 0xff));
+    EXPECT_EQ(error, 0);
+
+    mode.destroyIOBuffer(buffer);
+    map.removeObject(*object);
+    object->decRef();
+}
@@ -131,3 +131,31 @@ TEST_F(ObjectMapTest, Coherence) {
 
 	map.cleanUp();
 }
+
+TEST_F(ObjectMapTest, AddressFilter) {
+	Mode *mode = Process_->createMode(0);
+	ASSERT_TRUE(mode != NULL);
+
+    ObjectMap &map = mode->getAddressSpace();
+	Protocol &proto = map.getProtocol();
+
+    Object *obj = proto.createObject(*mode, Size_, NULL, GMAC_PROT_READWRITE, 0);
+    obj->addOwner(*mode);
+	ASSERT_TRUE(map.addObject(*obj));
+
+    // Memory used by objects always passes the filter
+	ASSERT_TRUE(ObjectMap::mayContain(obj->addr()));
+	ASSERT_TRUE(ObjectMap::mayContain(obj->addr() + Size_ - 1));
+	ASSERT_TRUE(ObjectMap::mayContain(obj->addr() - 1, 2));
+
+    // Memory outside the range of all objects is discarded
+    int local = 0;
+	ASSERT_FALSE(ObjectMap::mayContain(hostptr_t(&local), sizeof(local)));
+	ASSERT_FALSE(ObjectMap::mayContain(NULL, 0));
+
+	ASSERT_TRUE(map.removeObject(*obj));
+    obj->removeOwner(*mode);
+    obj->decRef();
+
+	map.cleanUp();
+}
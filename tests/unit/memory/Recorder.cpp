@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#if defined(POSIX)
+#include <unistd.h>
+#endif
+
+#include "gtest/gtest.h"
+#include "memory/Recorder.h"
+#include "util/Parameter.h"
+
+using __impl::memory::Recorder;
+using __impl::util::params::ParamRecord;
+
+#if defined(POSIX)
+TEST(RecorderTest, Events)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/gmac-record-%d", int(getpid()));
+    const char *old = ParamRecord;
+    ParamRecord = path;
+    Recorder::init();
+    ParamRecord = old;
+
+    hostptr_t addr = hostptr_t(0x10000000);
+    const size_t size = 1024 * 1024;
+    const unsigned Events = 10000;
+    const size_t blockSize = 64 * 1024;
+    Recorder::record(GMAC_RECORD_ALLOC, 1, addr, size, GMAC_PROT_READ);
+    Recorder::record(GMAC_RECORD_BLOCKSIZE, 1, addr, blockSize);
+    // Enough events to fill the buffer several times
+    for(unsigned i = 0; i < Events; i++)
+        Recorder::record(GMAC_RECORD_WRITE, 1, addr + (i * 4096) % size);
+    Recorder::record(GMAC_RECORD_RELEASE, 1, NULL);
+    Recorder::record(GMAC_RECORD_ACQUIRE, 1, NULL, 0, GMAC_PROT_READWRITE);
+    Recorder::record(GMAC_RECORD_FREE, 1, addr);
+    Recorder::sync();
+
+    FILE *file = fopen(path, "rb");
+    ASSERT_TRUE(file != NULL);
+    GmacRecordHeader header;
+    ASSERT_EQ(1U, fread(&header, sizeof(header), 1, file));
+    EXPECT_EQ(GMAC_RECORD_MAGIC, header.magic_);
+    EXPECT_EQ(unsigned(GMAC_RECORD_VERSION), header.version_);
+    EXPECT_EQ(uint64_t(getpid()), header.pid_);
+
+    GmacRecordEvent event;
+    ASSERT_EQ(1U, fread(&event, sizeof(event), 1, file));
+    EXPECT_EQ(GMAC_RECORD_ALLOC, event.type_);
+    EXPECT_EQ(uint64_t(addr), event.addr_);
+    EXPECT_EQ(size, event.size_);
+    EXPECT_EQ(GMAC_PROT_READ, event.prot_);
+    ASSERT_EQ(1U, fread(&event, sizeof(event), 1, file));
+    EXPECT_EQ(GMAC_RECORD_BLOCKSIZE, event.type_);
+    EXPECT_EQ(uint64_t(addr), event.addr_);
+    EXPECT_EQ(blockSize, event.size_);
+    uint64_t time = event.time_;
+    for(unsigned i = 0; i < Events; i++) {
+        ASSERT_EQ(1U, fread(&event, sizeof(event), 1, file));
+        EXPECT_EQ(GMAC_RECORD_WRITE, event.type_);
+        EXPECT_EQ(uint64_t(addr + (i * 4096) % size), event.addr_);
+        EXPECT_GE(event.time_, time);
+        time = event.time_;
+    }
+    ASSERT_EQ(1U, fread(&event, sizeof(event), 1, file));
+    EXPECT_EQ(GMAC_RECORD_RELEASE, event.type_);
+    ASSERT_EQ(1U, fread(&event, sizeof(event), 1, file));
+    EXPECT_EQ(GMAC_RECORD_ACQUIRE, event.type_);
+    EXPECT_EQ(GMAC_PROT_READWRITE, event.prot_);
+    ASSERT_EQ(1U, fread(&event, sizeof(event), 1, file));
+    EXPECT_EQ(GMAC_RECORD_FREE, event.type_);
+    EXPECT_EQ(0U, fread(&event, sizeof(event), 1, file));
+    fclose(file);
+    unlink(path);
+}
+#endif
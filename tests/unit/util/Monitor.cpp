@@ -0,0 +1,96 @@
+#if defined(POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "util/Monitor.h"
+#include "util/Parameter.h"
+
+using __impl::util::Monitor;
+using __impl::util::MonitorMode;
+using __impl::util::params::ParamMonitor;
+
+#if defined(POSIX)
+class MonitorTest : public testing::Test {
+protected:
+    static const GmacMonitorSegment *segment_;
+
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+};
+
+const GmacMonitorSegment *MonitorTest::segment_ = NULL;
+
+void MonitorTest::SetUpTestCase()
+{
+    ParamMonitor = true;
+    Monitor::init();
+
+    // Attach to the segment as gmac-top does
+    char name[64];
+    snprintf(name, sizeof(name), "%s%d", GMAC_MONITOR_PREFIX, int(getpid()));
+    int fd = shm_open(name, O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    void *addr = mmap(NULL, sizeof(GmacMonitorSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_TRUE(addr != MAP_FAILED);
+    segment_ = static_cast<const GmacMonitorSegment *>(addr);
+}
+
+void MonitorTest::TearDownTestCase()
+{
+    if(segment_ != NULL) munmap((void *)segment_, sizeof(GmacMonitorSegment));
+    segment_ = NULL;
+    // The segment name is removed when the test program exits
+    ParamMonitor = false;
+}
+
+TEST_F(MonitorTest, Segment)
+{
+    ASSERT_TRUE(segment_ != NULL);
+    EXPECT_EQ(GMAC_MONITOR_MAGIC, segment_->magic_);
+    EXPECT_EQ(unsigned(GMAC_MONITOR_VERSION), segment_->version_);
+    EXPECT_EQ(uint64_t(getpid()), segment_->pid_);
+    EXPECT_TRUE(Monitor::getAccelerator(0) != NULL);
+    EXPECT_TRUE(Monitor::getAccelerator(GMAC_MONITOR_ACCELERATORS) == NULL);
+}
+
+TEST_F(MonitorTest, Counters)
+{
+    ASSERT_TRUE(segment_ != NULL);
+    MonitorMode *slot = Monitor::acquireMode(42);
+    ASSERT_TRUE(slot != NULL);
+    // Find the slot through the read-only mapping
+    const GmacMonitorMode *found = NULL;
+    for(unsigned i = 0; i < GMAC_MONITOR_MODES; i++) {
+        if(segment_->modes_[i].inUse_ != 0 && segment_->modes_[i].id_ == 42) found = &segment_->modes_[i];
+    }
+    ASSERT_TRUE(found != NULL);
+    const GmacMonitorMode &mode = *found;
+
+    Monitor::add(slot->bytesInFlight_, 4096);
+    Monitor::add(slot->bytesInFlight_, -1024);
+    EXPECT_EQ(3072U, mode.bytesInFlight_);
+    Monitor::set(slot->dirtyBlocks_, 7);
+    EXPECT_EQ(7U, mode.dirtyBlocks_);
+
+    Monitor::releaseMode(slot);
+    EXPECT_EQ(0U, mode.inUse_);
+}
+
+TEST_F(MonitorTest, Full)
+{
+    MonitorMode *slots[GMAC_MONITOR_MODES];
+    for(unsigned i = 0; i < GMAC_MONITOR_MODES; i++) {
+        slots[i] = Monitor::acquireMode(i);
+        ASSERT_TRUE(slots[i] != NULL);
+    }
+    // Modes keep running without a slot when the segment is full
+    EXPECT_TRUE(Monitor::acquireMode(GMAC_MONITOR_MODES) == NULL);
+    for(unsigned i = 0; i < GMAC_MONITOR_MODES; i++) Monitor::releaseMode(slots[i]);
+}
+#endif
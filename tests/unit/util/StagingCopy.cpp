@@ -0,0 +1,128 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(POSIX)
+#include <sys/time.h>
+#endif
+
+#include "gtest/gtest.h"
+#include "util/Parameter.h"
+#include "util/StagingCopy.h"
+
+using __impl::util::StagingCopy;
+using __impl::util::params::ParamStagingThreads;
+
+static const size_t Size_ = 64 * 1024 * 1024;
+static const unsigned Threads_ = 3;
+
+class StagingCopyTest : public testing::Test {
+protected:
+    static uint8_t *src_;
+    static uint8_t *dst_;
+
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+};
+
+uint8_t *StagingCopyTest::src_ = NULL;
+uint8_t *StagingCopyTest::dst_ = NULL;
+
+void StagingCopyTest::SetUpTestCase()
+{
+    src_ = (uint8_t *)malloc(Size_ + 64);
+    dst_ = (uint8_t *)malloc(Size_ + 64);
+    ASSERT_TRUE(src_ != NULL);
+    ASSERT_TRUE(dst_ != NULL);
+    for(size_t n = 0; n < Size_ + 64; n++) src_[n] = uint8_t(n * 7);
+}
+
+void StagingCopyTest::TearDownTestCase()
+{
+    free(src_);
+    free(dst_);
+}
+
+static void
+checkCopies(uint8_t *dst, uint8_t *src)
+{
+    static const size_t sizes[] = { 1, 63, 4097, 1024 * 1024 + 13, Size_ - 3 };
+    static const size_t offsets[] = { 0, 1, 17 };
+    for(unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for(unsigned j = 0; j < sizeof(offsets) / sizeof(offsets[0]); j++) {
+            size_t size = sizes[i], off = offsets[j];
+            memset(dst, 0, size + 64);
+            StagingCopy::toStaging(dst + off, src + off, size);
+            ASSERT_EQ(0, memcmp(dst + off, src + off, size));
+            ASSERT_EQ(0, dst[off + size]);
+            memset(dst, 0, size + 64);
+            StagingCopy::fromStaging(dst + off, src + off, size);
+            ASSERT_EQ(0, memcmp(dst + off, src + off, size));
+            ASSERT_EQ(0, dst[off + size]);
+        }
+    }
+}
+
+TEST_F(StagingCopyTest, Copy)
+{
+    checkCopies(dst_, src_);
+}
+
+TEST_F(StagingCopyTest, ParallelCopy)
+{
+    unsigned threads = ParamStagingThreads;
+    StagingCopy::destroy();
+    ParamStagingThreads = Threads_;
+    StagingCopy::init();
+    checkCopies(dst_, src_);
+    StagingCopy::destroy();
+    ParamStagingThreads = threads;
+    StagingCopy::init();
+}
+
+#if defined(POSIX)
+static double
+bandwidth(void (*copy)(void *, const void *, size_t), uint8_t *dst, uint8_t *src)
+{
+    static const unsigned iterations = 8;
+    struct timeval s, t;
+    // Touch the destination before measuring
+    copy(dst, src, Size_);
+    gettimeofday(&s, NULL);
+    for(unsigned i = 0; i < iterations; i++) copy(dst, src, Size_);
+    gettimeofday(&t, NULL);
+    double secs = double(t.tv_sec - s.tv_sec) + double(t.tv_usec - s.tv_usec) / 1e6;
+    return double(Size_) * iterations / secs / (1024.0 * 1024.0);
+}
+
+static void
+plainCopy(void *dst, const void *src, size_t size)
+{
+    ::memcpy(dst, src, size);
+}
+
+TEST_F(StagingCopyTest, Bandwidth)
+{
+    unsigned threads = ParamStagingThreads;
+    const char *name = StagingCopy::nonTemporalName();
+
+    double plain = bandwidth(plainCopy, dst_, src_);
+    StagingCopy::destroy();
+    ParamStagingThreads = 0;
+    StagingCopy::init();
+    double single = bandwidth(StagingCopy::toStaging, dst_, src_);
+    StagingCopy::destroy();
+    ParamStagingThreads = Threads_;
+    StagingCopy::init();
+    double parallel = bandwidth(StagingCopy::toStaging, dst_, src_);
+    StagingCopy::destroy();
+    ParamStagingThreads = threads;
+    StagingCopy::init();
+
+    printf("memcpy: %.0f MB/s\n", plain);
+    printf("staging (%s): %.0f MB/s\n", name == NULL? "memcpy": name, single);
+    printf("staging (%s, %u threads): %.0f MB/s\n", name == NULL? "memcpy": name, Threads_ + 1, parallel);
+    EXPECT_GT(single, 0.0);
+    EXPECT_GT(parallel, 0.0);
+}
+#endif
@@ -0,0 +1,521 @@
+/*
+ * gmac-replay: replays the coherence events recorded with GMAC_RECORD under
+ * different coherence settings and predicts the faults, transfers and time
+ * spent keeping host and accelerator memory coherent
+ *
+ * Usage: gmac-replay [options] <record file>
+ *   -p <list>  Protocols: Lazy, Rolling, Gather (default: recorded protocol)
+ *   -b <list>  Block sizes, 0 for the recorded size of each object (default: 0)
+ *   -s <list>  Sub-block sizes used by Gather (default: recorded size)
+ *   -r <list>  Rolling thresholds (default: recorded threshold)
+ *   -g <ratio> Maximum fraction of dirty sub-blocks gathered (default: 0.2)
+ *   -f <cost>  Cost of a fault in microseconds (default: 10)
+ *
+ * Lists are comma-separated and sizes accept K, M and G suffixes. Transfer
+ * costs use the GMAC_MODEL_* variables, as the run-time does.
+ *
+ * Faults are recorded at the block granularity of each object in the recorded
+ * run, so settings with smaller blocks than the recorded ones underestimate
+ * faults. Record with a small GMAC_BLOCK_SIZE (and without
+ * GMAC_ADAPTIVE_BLOCK_SIZE) to evaluate a wide range of sizes.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "memory/RecorderFormat.h"
+
+/* GmacProtection values stored in the events */
+enum {
+    PROT_NONE = 0,
+    PROT_READ = 1,
+    PROT_WRITE = 2,
+    PROT_READWRITE = 3
+};
+
+enum Protocol { Lazy, Rolling, Gather };
+static const char *ProtocolName_[] = { "Lazy", "Rolling", "Gather" };
+
+struct Config {
+    Protocol protocol_;
+    /** Block size, or 0 to use the recorded block size of each object */
+    size_t blockSize_;
+    size_t subBlockSize_;
+    unsigned rollThreshold_;
+};
+
+/** Linear transfer cost model, the same one used by the run-time */
+struct Model {
+    double toDeviceConfig_, toHostConfig_;
+    double toDevice_[3], toHost_[3];
+    double l1_, l2_;
+    double fault_;
+    double gatherRatio_;
+
+    static double env(const char *name, double value)
+    {
+        const char *str = getenv(name);
+        return (str == NULL)? value: atof(str);
+    }
+
+    Model(double fault, double gatherRatio) :
+        fault_(fault), gatherRatio_(gatherRatio)
+    {
+        toHostConfig_ = env("GMAC_MODEL_TOHOSTCONFIG", 40.0);
+        toHost_[0] = env("GMAC_MODEL_TOHOSTTRANSFER_L1", 0.0007);
+        toHost_[1] = env("GMAC_MODEL_TOHOSTTRANSFER_L2", 0.0008);
+        toHost_[2] = env("GMAC_MODEL_TOHOSTTRANSFER_MEM", 0.0010);
+        toDeviceConfig_ = env("GMAC_MODEL_TODEVICECONFIG", 40.0);
+        toDevice_[0] = env("GMAC_MODEL_TODEVICETRANSFER_L1", 0.0007);
+        toDevice_[1] = env("GMAC_MODEL_TODEVICETRANSFER_L2", 0.0008);
+        toDevice_[2] = env("GMAC_MODEL_TODEVICETRANSFER_MEM", 0.0010);
+        l1_ = env("GMAC_MODEL_L1", 32 * 1024);
+        l2_ = env("GMAC_MODEL_L2", 256 * 1024);
+    }
+
+    double cost(const double *perByte, double config, size_t size) const
+    {
+        unsigned level = 2;
+        if(size <= l1_ / 2) level = 0;
+        else if(size <= l2_ / 2) level = 1;
+        return config + perByte[level] * size;
+    }
+
+    double toDevice(size_t size) const { return cost(toDevice_, toDeviceConfig_, size); }
+    double toHost(size_t size) const { return cost(toHost_, toHostConfig_, size); }
+};
+
+struct Result {
+    uint64_t faultsRead_;
+    uint64_t faultsWrite_;
+    uint64_t bytesToAccelerator_;
+    uint64_t bytesToHost_;
+    uint64_t transfers_;
+    double time_;
+    /** Some object used larger blocks than the simulated ones */
+    bool underestimated_;
+};
+
+enum State { Invalid, ReadOnly, Dirty };
+
+struct Block {
+    State state_;
+    size_t size_;
+    /** Dirty sub-blocks, only tracked by Gather */
+    std::vector<bool> subBlocks_;
+    size_t dirty_;
+};
+
+struct Object {
+    uint64_t addr_;
+    uint64_t size_;
+    uint32_t mode_;
+    /** Block size used by the object in the recorded run */
+    size_t blockSize_;
+    std::vector<Block> blocks_;
+};
+
+/** Replays the events on the state machine of the lazy protocols */
+class Simulator {
+protected:
+    typedef std::pair<uint64_t, size_t> BlockId;
+    typedef std::list<BlockId> DirtyList;
+
+    const Config &config_;
+    const Model &model_;
+    /** Block size of the recorded objects until their first GMAC_RECORD_BLOCKSIZE */
+    size_t recordedBlockSize_;
+    Result result_;
+
+    std::map<uint64_t, Object> objects_;
+    /** Dirty blocks of each mode, oldest first */
+    std::map<uint32_t, DirtyList> dirty_;
+
+    Object *find(uint64_t addr)
+    {
+        std::map<uint64_t, Object>::iterator i = objects_.upper_bound(addr);
+        if(i == objects_.begin()) return NULL;
+        --i;
+        if(addr >= i->second.addr_ + i->second.size_) return NULL;
+        return &i->second;
+    }
+
+    size_t blockSize(const Object &object) const
+    {
+        return (config_.blockSize_ != 0)? config_.blockSize_: object.blockSize_;
+    }
+
+    size_t subBlocks(const Block &block) const
+    {
+        return (block.size_ + config_.subBlockSize_ - 1) / config_.subBlockSize_;
+    }
+
+    void toHost(Block &block)
+    {
+        result_.bytesToHost_ += block.size_;
+        result_.transfers_++;
+        result_.time_ += model_.toHost(block.size_);
+    }
+
+    void toAccelerator(Block &block)
+    {
+        size_t size = block.size_;
+        if(config_.protocol_ == Gather &&
+           block.dirty_ <= model_.gatherRatio_ * subBlocks(block)) {
+            // Dirty sub-blocks are packed in a single transfer
+            size = block.dirty_ * config_.subBlockSize_;
+            if(size > block.size_) size = block.size_;
+        }
+        result_.bytesToAccelerator_ += size;
+        result_.transfers_++;
+        result_.time_ += model_.toDevice(size);
+    }
+
+    void release(Block &block)
+    {
+        if(block.state_ != Dirty) return;
+        toAccelerator(block);
+        block.state_ = ReadOnly;
+        block.dirty_ = 0;
+        if(config_.protocol_ == Gather) block.subBlocks_.assign(block.subBlocks_.size(), false);
+    }
+
+    void release(Object &object)
+    {
+        for(size_t n = 0; n < object.blocks_.size(); n++) release(object.blocks_[n]);
+        purge(object);
+    }
+
+    void acquire(Object &object, uint8_t prot)
+    {
+        if(prot != PROT_WRITE && prot != PROT_READWRITE) return;
+        for(size_t n = 0; n < object.blocks_.size(); n++) {
+            // Dirty blocks were modified before the kernel call and are kept
+            if(object.blocks_[n].state_ != Dirty) object.blocks_[n].state_ = Invalid;
+        }
+    }
+
+    /** Removes the blocks of an object from the dirty list of its mode */
+    void purge(const Object &object)
+    {
+        DirtyList &list = dirty_[object.mode_];
+        for(DirtyList::iterator i = list.begin(); i != list.end();) {
+            if(i->first == object.addr_) i = list.erase(i);
+            else ++i;
+        }
+    }
+
+    void read(uint64_t addr)
+    {
+        Object *object = find(addr);
+        if(object == NULL) return;
+        Block &block = object->blocks_[(addr - object->addr_) / blockSize(*object)];
+        if(block.state_ != Invalid) return;
+        result_.faultsRead_++;
+        result_.time_ += model_.fault_;
+        toHost(block);
+        block.state_ = ReadOnly;
+    }
+
+    void write(uint64_t addr)
+    {
+        Object *object = find(addr);
+        if(object == NULL) return;
+        size_t n = size_t((addr - object->addr_) / blockSize(*object));
+        Block &block = object->blocks_[n];
+        if(block.state_ == Dirty) {
+            if(config_.protocol_ != Gather) return;
+            // Sub-blocks are protected independently
+            size_t s = size_t((addr - object->addr_ - n * blockSize(*object)) / config_.subBlockSize_);
+            if(block.subBlocks_[s] == true) return;
+            block.subBlocks_[s] = true;
+            block.dirty_++;
+            result_.faultsWrite_++;
+            result_.time_ += model_.fault_;
+            return;
+        }
+        result_.faultsWrite_++;
+        result_.time_ += model_.fault_;
+        if(block.state_ == Invalid) toHost(block);
+        block.state_ = Dirty;
+        if(config_.protocol_ == Gather) {
+            size_t s = size_t((addr - object->addr_ - n * blockSize(*object)) / config_.subBlockSize_);
+            block.subBlocks_[s] = true;
+            block.dirty_ = 1;
+        }
+
+        DirtyList &list = dirty_[object->mode_];
+        list.push_back(BlockId(object->addr_, n));
+        if(config_.protocol_ != Rolling) return;
+        // Rolling sends the oldest dirty blocks to the accelerator eagerly
+        while(list.size() > config_.rollThreshold_) {
+            BlockId id = list.front();
+            list.pop_front();
+            release(objects_[id.first].blocks_[id.second]);
+        }
+    }
+
+    /** Splits an object in blocks, all of them in the same state */
+    void populate(Object &object, State state)
+    {
+        size_t size = blockSize(object);
+        object.blocks_.clear();
+        for(uint64_t offset = 0; offset < object.size_; offset += size) {
+            Block block;
+            block.state_ = state;
+            block.size_ = size_t((object.size_ - offset < size)? object.size_ - offset: size);
+            block.dirty_ = 0;
+            if(config_.protocol_ == Gather) block.subBlocks_.assign(subBlocks(block), false);
+            object.blocks_.push_back(block);
+        }
+    }
+
+    void alloc(const GmacRecordEvent &event)
+    {
+        Object &object = objects_[event.addr_];
+        object.addr_ = event.addr_;
+        object.size_ = event.size_;
+        object.mode_ = event.mode_;
+        object.blockSize_ = recordedBlockSize_;
+        populate(object, (event.prot_ == PROT_NONE)? Invalid: ReadOnly);
+    }
+
+    void setBlockSize(const GmacRecordEvent &event)
+    {
+        Object *object = find(event.addr_);
+        if(object == NULL || event.size_ == 0) return;
+        object->blockSize_ = size_t(event.size_);
+        if(config_.blockSize_ != 0) {
+            if(config_.blockSize_ < object->blockSize_) result_.underestimated_ = true;
+            return;
+        }
+        // The run-time only resizes blocks that are all in the same state
+        // and hold no host changes
+        State state = object->blocks_.empty()? Invalid: object->blocks_.front().state_;
+        purge(*object);
+        populate(*object, (state == Dirty)? ReadOnly: state);
+    }
+
+public:
+    Simulator(const Config &config, const Model &model, size_t recordedBlockSize) :
+        config_(config), model_(model), recordedBlockSize_(recordedBlockSize)
+    {
+        memset(&result_, 0, sizeof(result_));
+    }
+
+    void event(const GmacRecordEvent &event)
+    {
+        switch(event.type_) {
+        case GMAC_RECORD_ALLOC:
+            alloc(event);
+            break;
+        case GMAC_RECORD_BLOCKSIZE:
+            setBlockSize(event);
+            break;
+        case GMAC_RECORD_FREE: {
+            Object *object = find(event.addr_);
+            if(object == NULL) break;
+            purge(*object);
+            objects_.erase(object->addr_);
+            break;
+        }
+        case GMAC_RECORD_READ:
+            read(event.addr_);
+            break;
+        case GMAC_RECORD_WRITE:
+            write(event.addr_);
+            break;
+        case GMAC_RECORD_RELEASE:
+            if(event.addr_ == 0) {
+                std::map<uint64_t, Object>::iterator i;
+                for(i = objects_.begin(); i != objects_.end(); ++i) {
+                    if(i->second.mode_ != event.mode_) continue;
+                    for(size_t n = 0; n < i->second.blocks_.size(); n++) release(i->second.blocks_[n]);
+                }
+                dirty_[event.mode_].clear();
+            }
+            else {
+                Object *object = find(event.addr_);
+                if(object != NULL) release(*object);
+            }
+            break;
+        case GMAC_RECORD_ACQUIRE:
+            if(event.addr_ == 0) {
+                std::map<uint64_t, Object>::iterator i;
+                for(i = objects_.begin(); i != objects_.end(); ++i) {
+                    if(i->second.mode_ == event.mode_) acquire(i->second, event.prot_);
+                }
+            }
+            else {
+                Object *object = find(event.addr_);
+                if(object != NULL) acquire(*object, event.prot_);
+            }
+            break;
+        }
+    }
+
+    const Result &result() const { return result_; }
+};
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-p protocols] [-b block sizes] [-s sub-block sizes] "
+                    "[-r roll thresholds] [-g gather ratio] [-f fault cost] <record file>\n", name);
+    exit(EXIT_FAILURE);
+}
+
+static uint64_t parseSize(const std::string &str)
+{
+    char *end = NULL;
+    uint64_t value = strtoull(str.c_str(), &end, 0);
+    const char *suffix = strchr("kmg", tolower(*end));
+    if(*end != '\0' && suffix != NULL) {
+        for(const char *s = "kmg"; s <= suffix; s++) value *= 1024;
+    }
+    return value;
+}
+
+static std::vector<std::string> split(const char *str)
+{
+    std::vector<std::string> ret;
+    std::string s(str);
+    size_t start = 0;
+    while(start <= s.size()) {
+        size_t end = s.find(',', start);
+        if(end == std::string::npos) end = s.size();
+        if(end > start) ret.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return ret;
+}
+
+static bool parseProtocol(const std::string &str, Protocol &protocol)
+{
+    for(unsigned i = 0; i < sizeof(ProtocolName_) / sizeof(ProtocolName_[0]); i++) {
+        if(strcasecmp(str.c_str(), ProtocolName_[i]) != 0) continue;
+        protocol = Protocol(i);
+        return true;
+    }
+    return false;
+}
+
+static bool load(const char *path, GmacRecordHeader &header, std::vector<GmacRecordEvent> &events)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return false;
+    }
+    if(fread(&header, sizeof(header), 1, file) != 1 ||
+       header.magic_ != GMAC_RECORD_MAGIC || header.version_ != GMAC_RECORD_VERSION) {
+        fprintf(stderr, "%s is not a GMAC record file (version %d)\n", path, GMAC_RECORD_VERSION);
+        fclose(file);
+        return false;
+    }
+    GmacRecordEvent event;
+    while(fread(&event, sizeof(event), 1, file) == 1) events.push_back(event);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *protocols = NULL, *blockSizes = NULL, *subBlockSizes = NULL, *thresholds = NULL;
+    double fault = 10.0, gatherRatio = 0.2;
+    int opt;
+    while((opt = getopt(argc, argv, "p:b:s:r:g:f:")) != -1) {
+        switch(opt) {
+        case 'p': protocols = optarg; break;
+        case 'b': blockSizes = optarg; break;
+        case 's': subBlockSizes = optarg; break;
+        case 'r': thresholds = optarg; break;
+        case 'g': gatherRatio = atof(optarg); break;
+        case 'f': fault = atof(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if(optind != argc - 1) usage(argv[0]);
+
+    GmacRecordHeader header;
+    std::vector<GmacRecordEvent> events;
+    if(load(argv[optind], header, events) == false) return EXIT_FAILURE;
+
+    // Settings not given in the command line are taken from the recorded run
+    char recorded[32];
+    std::vector<Protocol> protocolList;
+    std::vector<std::string> list = split((protocols != NULL)? protocols: header.protocol_);
+    for(size_t i = 0; i < list.size(); i++) {
+        Protocol protocol;
+        if(parseProtocol(list[i], protocol) == false) {
+            fprintf(stderr, "Unknown protocol %s\n", list[i].c_str());
+            return EXIT_FAILURE;
+        }
+        protocolList.push_back(protocol);
+    }
+    std::vector<uint64_t> blockList, subBlockList, thresholdList;
+    list = split((blockSizes != NULL)? blockSizes: "0");
+    for(size_t i = 0; i < list.size(); i++) blockList.push_back(parseSize(list[i]));
+    snprintf(recorded, sizeof(recorded), "%llu", (unsigned long long)header.subBlockSize_);
+    list = split((subBlockSizes != NULL)? subBlockSizes: recorded);
+    for(size_t i = 0; i < list.size(); i++) subBlockList.push_back(parseSize(list[i]));
+    snprintf(recorded, sizeof(recorded), "%u", header.rollThreshold_);
+    list = split((thresholds != NULL)? thresholds: recorded);
+    for(size_t i = 0; i < list.size(); i++) thresholdList.push_back(parseSize(list[i]));
+
+    uint64_t duration = events.empty()? 0: events.back().time_;
+    printf("%zu events in %.3f s recorded with %s, %llu-byte default blocks\n\n", events.size(),
+        duration / 1e6, header.protocol_, (unsigned long long)header.blockSize_);
+    printf("%-8s %10s %10s %6s %10s %10s %12s %12s %10s %12s\n",
+        "PROTOCOL", "BLOCK", "SUBBLOCK", "ROLL", "RFAULTS", "WFAULTS",
+        "TO ACC (MB)", "TO HOST (MB)", "TRANSFERS", "TIME (ms)");
+
+    Model model(fault, gatherRatio);
+    bool underestimated = false;
+    for(size_t p = 0; p < protocolList.size(); p++) {
+        // Only sweep the settings each protocol uses
+        size_t subBlocks = (protocolList[p] == Gather)? subBlockList.size(): 1;
+        size_t rolls = (protocolList[p] == Rolling)? thresholdList.size(): 1;
+        for(size_t b = 0; b < blockList.size(); b++) {
+            for(size_t s = 0; s < subBlocks; s++) {
+                for(size_t r = 0; r < rolls; r++) {
+                    Config config;
+                    config.protocol_ = protocolList[p];
+                    config.blockSize_ = size_t(blockList[b]);
+                    config.subBlockSize_ = size_t(subBlockList[s]);
+                    config.rollThreshold_ = unsigned(thresholdList[r]);
+                    if(config.subBlockSize_ == 0)
+                        config.subBlockSize_ = (config.blockSize_ != 0)? config.blockSize_: size_t(header.blockSize_);
+                    else if(config.blockSize_ != 0 && config.subBlockSize_ > config.blockSize_)
+                        config.subBlockSize_ = config.blockSize_;
+
+                    char block[32] = "recorded", subBlock[32] = "-", roll[32] = "-";
+                    if(config.blockSize_ != 0) snprintf(block, sizeof(block), "%zu", config.blockSize_);
+                    if(config.protocol_ == Gather) snprintf(subBlock, sizeof(subBlock), "%zu", config.subBlockSize_);
+                    if(config.protocol_ == Rolling) snprintf(roll, sizeof(roll), "%u", config.rollThreshold_);
+
+                    Simulator simulator(config, model, size_t(header.blockSize_));
+                    for(size_t e = 0; e < events.size(); e++) simulator.event(events[e]);
+                    const Result &result = simulator.result();
+                    if(result.underestimated_) underestimated = true;
+                    printf("%-8s %10s %10s %6s %10llu %10llu %12.1f %12.1f %10llu %12.3f%s\n",
+                        ProtocolName_[config.protocol_], block, subBlock, roll,
+                        (unsigned long long)result.faultsRead_, (unsigned long long)result.faultsWrite_,
+                        result.bytesToAccelerator_ / (1024.0 * 1024.0), result.bytesToHost_ / (1024.0 * 1024.0),
+                        (unsigned long long)result.transfers_, result.time_ / 1000.0,
+                        result.underestimated_? " *": "");
+                }
+            }
+        }
+    }
+    if(underestimated) printf("\n* Blocks smaller than the recorded ones: faults are underestimated\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*
+ * gmac-top: shows the live counters published by a GMAC process started
+ * with GMAC_MONITOR=1
+ *
+ * Usage: gmac-top <pid> [interval in seconds]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "util/MonitorSegment.h"
+
+static const double MB = 1024.0 * 1024.0;
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s <pid> [interval in seconds]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+static const GmacMonitorSegment *attach(int pid)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s%d", GMAC_MONITOR_PREFIX, pid);
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd < 0) {
+        fprintf(stderr, "Unable to open %s: %s\n", name, strerror(errno));
+        fprintf(stderr, "Was the process started with GMAC_MONITOR=1?\n");
+        return NULL;
+    }
+    void *addr = mmap(NULL, sizeof(GmacMonitorSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) {
+        fprintf(stderr, "Unable to map %s: %s\n", name, strerror(errno));
+        return NULL;
+    }
+    const GmacMonitorSegment *segment = (const GmacMonitorSegment *)addr;
+    if(segment->magic_ != GMAC_MONITOR_MAGIC || segment->version_ != GMAC_MONITOR_VERSION) {
+        fprintf(stderr, "%s is not a GMAC monitor segment (version %d)\n", name, GMAC_MONITOR_VERSION);
+        munmap(addr, sizeof(GmacMonitorSegment));
+        return NULL;
+    }
+    return segment;
+}
+
+static double average(uint64_t time, uint64_t count)
+{
+    return (count == 0)? 0.0: double(time) / double(count);
+}
+
+static void show(const GmacMonitorSegment &segment, const GmacMonitorMode *last, double elapsed)
+{
+    printf("\033[H\033[2J");
+    printf("GMAC process %llu\n\n", (unsigned long long)segment.pid_);
+
+    printf("%4s %6s %12s %12s\n", "ACC", "MODES", "USED (MB)", "TOTAL (MB)");
+    for(unsigned i = 0; i < GMAC_MONITOR_ACCELERATORS; i++) {
+        const GmacMonitorAccelerator &acc = segment.accelerators_[i];
+        if(acc.present_ == 0) continue;
+        printf("%4u %6u %12.1f %12.1f\n", i, acc.modes_,
+            acc.memoryUsed_ / MB, acc.memoryTotal_ / MB);
+    }
+
+    printf("\n%16s %4s %8s %12s %10s %10s %10s %10s %6s %10s\n",
+        "MODE", "ACC", "DIRTY", "FLIGHT (KB)", "RFAULT/s", "WFAULT/s",
+        "REL (us)", "ACQ (us)", "IOBUF", "IOBUF (MB)");
+    for(unsigned i = 0; i < GMAC_MONITOR_MODES; i++) {
+        const GmacMonitorMode &mode = segment.modes_[i];
+        if(mode.inUse_ == 0) continue;
+        // Slots taken by a new mode since the last refresh have no rate yet
+        double readRate = 0.0, writeRate = 0.0;
+        if(elapsed > 0.0 && last[i].inUse_ != 0 && last[i].id_ == mode.id_) {
+            readRate = (mode.faultsRead_ - last[i].faultsRead_) / elapsed;
+            writeRate = (mode.faultsWrite_ - last[i].faultsWrite_) / elapsed;
+        }
+        printf("%16llx %4u %8llu %12.1f %10.1f %10.1f %10.1f %10.1f %6llu %10.1f\n",
+            (unsigned long long)mode.id_, mode.accelerator_,
+            (unsigned long long)mode.dirtyBlocks_, mode.bytesInFlight_ / 1024.0,
+            readRate, writeRate,
+            average(mode.releaseTime_, mode.releases_),
+            average(mode.acquireTime_, mode.acquires_),
+            (unsigned long long)mode.ioBuffers_, mode.ioBufferBytes_ / MB);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 3) usage(argv[0]);
+    int pid = atoi(argv[1]);
+    double interval = (argc == 3)? atof(argv[2]): 1.0;
+    if(pid <= 0 || interval <= 0.0) usage(argv[0]);
+
+    const GmacMonitorSegment *segment = attach(pid);
+    if(segment == NULL) return EXIT_FAILURE;
+
+    GmacMonitorMode *last = (GmacMonitorMode *)calloc(GMAC_MONITOR_MODES, sizeof(GmacMonitorMode));
+    double elapsed = 0.0;
+    while(true) {
+        // Processes killed by a signal do not remove their segment
+        if(kill(pid, 0) < 0 && errno == ESRCH) {
+            fprintf(stderr, "Process %d has finished\n", pid);
+            break;
+        }
+        show(*segment, last, elapsed);
+        memcpy(last, (const void *)segment->modes_, sizeof(segment->modes_));
+        usleep(useconds_t(interval * 1000000));
+        elapsed = interval;
+    }
+
+    free(last);
+    munmap((void *)segment, sizeof(GmacMonitorSegment));
+    return EXIT_SUCCESS;
+}